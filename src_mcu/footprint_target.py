@@ -0,0 +1,45 @@
+"""footprint_target.py
+
+PlatformIO extra script adding the custom target `footprint`:
+
+  pio run -t footprint
+
+Links the firmware, and once more for twice the number of LEDs in the
+`footprint_scaled` environment, and reports the RAM and flash footprint per
+subsystem and per effect with `src_python/footprint.py`. Fails when the usage
+exceeds `custom_ram_budget` or `custom_flash_budget` of `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+"""
+
+import os
+
+Import("env")  # noqa: F821
+
+project_dir = env.subst("$PROJECT_DIR")  # noqa: F821
+build_dir = env.subst("$PROJECT_BUILD_DIR")  # noqa: F821
+scaled_elf = os.path.join(build_dir, "footprint_scaled", "firmware.elf")
+nm = os.path.join(
+    env.subst("$PROJECT_PACKAGES_DIR"),  # noqa: F821
+    "toolchain-gccarmnoneeabi", "bin", "arm-none-eabi-nm",
+)
+script = os.path.join(project_dir, "..", "src_python", "footprint.py")
+
+env.AddCustomTarget(  # noqa: F821
+    name="footprint",
+    dependencies="$BUILD_DIR/${PROGNAME}.elf",
+    actions=[
+        '"$PYTHONEXE" -m platformio run -d "%s" -e footprint_scaled'
+        % project_dir,
+        '"$PYTHONEXE" "%s" "$BUILD_DIR/${PROGNAME}.elf" --scale "%s" '
+        '--nm "%s" --ram-budget %s --flash-budget %s --top 10'
+        % (
+            script, scaled_elf, nm,
+            env.GetProjectOption("custom_ram_budget"),  # noqa: F821
+            env.GetProjectOption("custom_flash_budget"),  # noqa: F821
+        ),
+    ],
+    title="Footprint",
+    description="RAM and flash footprint per subsystem and effect",
+)
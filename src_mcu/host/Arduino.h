@@ -0,0 +1,192 @@
+/* Arduino.h
+
+Minimal Arduino core for the programs on the host PC, like the offline
+renderer of `render.cpp`. Only what the effects and their dependencies use.
+
+`millis()` and `micros()` are left for each program to define. The renderer
+returns virtual time, advanced frame by frame, which makes every render
+deterministic. `Serial` prints to stderr,
+keeping stdout free. The analog inputs read as 0, the digital inputs as set
+by `host_pins()`, 0 by default.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ARDUINO
+#define ARDUINO 100
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 2
+
+// Pins of the ItsyBitsy M4 variant
+#define PIN_SPI_MISO (23u)
+#define PIN_SPI_MOSI (25u)
+#define PIN_SPI_SCK (24u)
+#define PIN_A1 (15u)
+#define PIN_A2 (16u)
+#define PIN_A4 (18u)
+#define PIN_WIRE_SDA (21u)
+#define PIN_WIRE_SCL (22u)
+static const uint8_t A1 = PIN_A1;
+static const uint8_t A4 = PIN_A4;
+static const uint8_t SDA = PIN_WIRE_SDA;
+static const uint8_t SCL = PIN_WIRE_SCL;
+
+template <class T, class L>
+auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+template <class T, class L>
+auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+#define constrain(amt, low, high)                                              \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+/*------------------------------------------------------------------------------
+  Time, defined by each program
+------------------------------------------------------------------------------*/
+
+unsigned long millis();
+unsigned long micros();
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int) {}
+inline void yield() {}
+
+/*------------------------------------------------------------------------------
+  I/O
+------------------------------------------------------------------------------*/
+
+inline int analogRead(int) {
+  return 0;
+}
+inline void analogReadResolution(int) {}
+inline uint8_t *host_pins() {
+  // Levels of the digital inputs, to be set by the host program
+  static uint8_t levels[64] = {0};
+  return levels;
+}
+inline int digitalRead(int pin) {
+  return host_pins()[pin & 63];
+}
+inline void digitalWrite(int, int) {}
+inline void pinMode(int, int) {}
+inline int digitalPinToInterrupt(int pin) {
+  return pin;
+}
+inline void attachInterrupt(int, void (*)(), int) {}
+
+/*------------------------------------------------------------------------------
+  Print, Stream and Serial
+------------------------------------------------------------------------------*/
+
+class Print {
+  /* Like the Arduino core, all printing goes through `write()`
+   */
+public:
+  virtual size_t write(uint8_t c) {
+    return fputc(c, stderr) == EOF ? 0 : 1;
+  }
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+  virtual int availableForWrite() {
+    return 64;
+  }
+  virtual void flush() {
+    fflush(stderr);
+  }
+
+  size_t print(const char *s) {
+    return write((const uint8_t *)s, strlen(s));
+  }
+  size_t print(char c) {
+    return write((uint8_t)c);
+  }
+  size_t print(int v, int = 10) {
+    return printf_("%d", v);
+  }
+  size_t print(unsigned int v, int = 10) {
+    return printf_("%u", v);
+  }
+  size_t print(long v, int = 10) {
+    return printf_("%ld", v);
+  }
+  size_t print(unsigned long v, int = 10) {
+    return printf_("%lu", v);
+  }
+  size_t print(double v, int digits = 2) {
+    return printf_("%.*f", digits, v);
+  }
+  template <class T> size_t println(T v) {
+    return print(v) + println();
+  }
+  size_t println(double v, int digits) {
+    return print(v, digits) + println();
+  }
+  size_t println() {
+    return print("\r\n");
+  }
+
+private:
+  template <class... Args> size_t printf_(const char *fmt, Args... args) {
+    char buf[64];
+    int n = snprintf(buf, sizeof(buf), fmt, args...);
+    return write((const uint8_t *)buf, min(n, (int)sizeof(buf) - 1));
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() {
+    return 0;
+  }
+  virtual int read() {
+    return -1;
+  }
+  virtual int peek() {
+    return -1;
+  }
+  size_t readBytes(uint8_t *, size_t) {
+    return 0;
+  }
+  void setTimeout(unsigned long) {}
+};
+
+class Serial_ : public Stream {
+public:
+  void begin(unsigned long) {}
+  operator bool() {
+    return true;
+  }
+};
+
+extern Serial_ Serial;
+
+#endif
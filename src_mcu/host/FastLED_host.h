@@ -0,0 +1,61 @@
+/* FastLED_host.h
+
+Lets FastLED 3.4.0 compile for the host PC, for the offline renderer of
+`render.cpp` and all other host programs of `host/`. The `[host]` section of
+`platformio.ini`, extended by every host environment, force-includes this file
+ahead of every source file, FastLED's own included.
+
+FastLED does not know the host as a platform. Instead of patching the library,
+this file defines the include guards of its `led_sysdefs.h` and `platforms.h`
+and provides the few definitions those would have made. No LED controller gets
+instantiated on the host: Only the color math, palettes and noise get used.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef FASTLED_HOST_H
+#define FASTLED_HOST_H
+
+#ifdef __cplusplus
+
+#include <stdint.h>
+
+// Building for the host PC, lets the firmware pick the stand-ins of `host/`
+#define DVG_HOST 1
+
+// Take the place of FastLED's platform selection
+#define __INC_LED_SYSDEFS_H
+#define __INC_PLATFORMS_H
+
+#define FASTLED_NAMESPACE_BEGIN
+#define FASTLED_NAMESPACE_END
+#define FASTLED_USING_NAMESPACE
+
+#define FASTLED_ALLOW_INTERRUPTS 1
+#define INTERRUPT_THRESHOLD 0
+#define FASTLED_USE_PROGMEM 0
+#define FL_PROGMEM
+#define FASTLED_NO_PINMAP
+#define FASTLED_SPI_BYTE_ONLY
+
+// No controller pins get used, hence no pin mappings are missed. Also silences
+// the version message FastLED prints when included from user code.
+#define HAS_HARDWARE_PIN_SUPPORT
+#define FASTLED_INTERNAL
+
+// Same core clock as the SAMD51, to keep cycle estimates comparable
+#ifndef F_CPU
+#define F_CPU 120000000L
+#endif
+#define CLKS_PER_US (F_CPU / 1000000)
+
+#define cli()
+#define sei()
+
+typedef volatile uint32_t RoReg;
+typedef volatile uint32_t RwReg;
+
+#include <Arduino.h>
+
+#endif
+#endif
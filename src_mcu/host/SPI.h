@@ -0,0 +1,73 @@
+/* SPI.h
+
+Stand-in for the SERCOM SPI ports of the SAMD51 Arduino core on the host PC,
+letting the parallel output of `DvG_APA102_MultiSPI.h` build off-target, see
+`multispi_check.cpp`.
+
+Each `SPIClass` keeps the byte stream of its last DMA transfer, instead of
+shifting it out, along with the number of transfers and bytes sent.
+`waitForTransfer()` returns right away, as the stand-in transfer completes
+immediately.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef SPI_H
+#define SPI_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+enum SercomSpiTXPad { SPI_PAD_0_SCK_1, SPI_PAD_2_SCK_3, SPI_PAD_3_SCK_1 };
+enum SercomRXPad { SERCOM_RX_PAD_0, SERCOM_RX_PAD_1, SERCOM_RX_PAD_2,
+                   SERCOM_RX_PAD_3 };
+
+class SERCOM {};
+
+static SERCOM sercom0, sercom1, sercom2, sercom3;
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock, uint8_t, uint8_t) : clock(clock) {}
+  uint32_t clock;
+};
+
+class SPIClass {
+public:
+  SERCOM *sercom;
+  uint8_t pin_miso, pin_sck, pin_mosi;
+  bool began = false;
+  uint32_t clock = 0;
+  std::vector<uint8_t> last; // Byte stream of the last transfer
+  uint32_t n_transfers = 0;
+  uint32_t n_bytes = 0;
+
+  SPIClass(SERCOM *sercom, uint8_t miso, uint8_t sck, uint8_t mosi,
+           SercomSpiTXPad, SercomRXPad)
+      : sercom(sercom), pin_miso(miso), pin_sck(sck), pin_mosi(mosi) {}
+
+  void begin() {
+    began = true;
+  }
+  void beginTransaction(SPISettings settings) {
+    clock = settings.clock;
+  }
+  void transfer(const void *tx, void *rx, size_t count, bool) {
+    last.assign((const uint8_t *)tx, (const uint8_t *)tx + count);
+    if (rx) {
+      memset(rx, 0, count);
+    }
+    n_transfers++;
+    n_bytes += count;
+  }
+  void waitForTransfer() {}
+};
+
+// The default SPI port of the ItsyBitsy M4, on MOSI and SCK
+static SPIClass SPI(&sercom1, PIN_SPI_MISO, PIN_SPI_SCK, PIN_SPI_MOSI, SPI_PAD_0_SCK_1,
+                    SERCOM_RX_PAD_3);
+
+#endif
@@ -0,0 +1,324 @@
+/* Animation check
+
+Checks the animation recording of `DvG_FastLED_Animation.h` on the host PC,
+with the QSPI flash backed by an image file. Fails when any check does not
+hold.
+
+Usage:
+  anim_check [IMAGE]
+
+Checks:
+  codec     Frames of random, gradient, solid and sparsely changing LEDs
+            decode back into the original, within `ANIM_MAX_FRAME_SIZE`,
+            and corrupt data gets rejected
+  record    `AnimRecorder` records a moving pattern, `AnimPlayer` plays it
+            back frame by frame, also after reopening the image file
+  full      The recording stops with a valid header once the flash region
+            is full
+  upload    `AnimUpload` accepts a recording arriving in bits and pieces, and
+            rejects a bad CRC and a bad header, keeping the header erased
+
+`IMAGE` is the flash image file, default `anim_check.qspi`, removed
+afterwards. Build and run with `pio run -e anim_check -t exec`, see
+`platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Animation.h"
+
+Serial_ Serial;
+
+static uint32_t now_ms = 0;
+
+unsigned long millis() {
+  return now_ms;
+}
+unsigned long micros() {
+  return now_ms * 1000;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static void pattern(CRGB *frame, uint32_t i) {
+  /* Moving pattern with runs of unchanged, repeated and distinct LEDs
+   */
+  fill_solid(frame, FLC::N, CRGB::Black);
+  for (uint16_t j = 0; j < FLC::N / 4; j++) {
+    frame[(i + j) % FLC::N] = CHSV(i * 3 + j * 10, 255, 255);
+  }
+  fill_solid(&frame[(i / 5) % (FLC::N - 8)], 8, CRGB(i, 0, 255 - i));
+}
+
+/*------------------------------------------------------------------------------
+  codec
+------------------------------------------------------------------------------*/
+
+static bool check_codec() {
+  static uint8_t enc[ANIM_MAX_FRAME_SIZE(FLC::N)];
+  std::mt19937 rng(1);
+  CRGB prev[FLC::N], cur[FLC::N], dec[FLC::N];
+  uint32_t max_len = 0;
+  bool ok = true;
+
+  fill_solid(cur, FLC::N, CRGB::Black);
+  for (uint32_t i = 0; i < 4000; i++) {
+    memcpy(prev, cur, sizeof(cur));
+    switch (i % 4) {
+      case 0: // Random, the worst case
+        for (CRGB &c : cur) {
+          c = CRGB(rng(), rng(), rng());
+        }
+        break;
+      case 1: // Gradient
+        fill_rainbow(cur, FLC::N, i, 5);
+        break;
+      case 2: // Solid
+        fill_solid(cur, FLC::N, CRGB(rng(), rng(), rng()));
+        break;
+      case 3: // A few LEDs changing
+        for (uint8_t j = 0; j < 3; j++) {
+          cur[rng() % FLC::N] = CRGB(rng(), rng(), rng());
+        }
+        break;
+    }
+    uint16_t len = anim_encode_frame(cur, prev, FLC::N, enc);
+    memcpy(dec, prev, sizeof(prev));
+    ok &= anim_decode_frame(enc, len, dec, FLC::N);
+    ok &= !memcmp(dec, cur, sizeof(cur));
+    max_len = max(max_len, (uint32_t)len);
+  }
+  ok &= (max_len <= ANIM_MAX_FRAME_SIZE(FLC::N));
+
+  char what[64];
+  snprintf(what, sizeof(what), "codec: round trip, max %u of %u bytes", max_len,
+           ANIM_MAX_FRAME_SIZE(FLC::N));
+  ok = check(ok, what);
+
+  // Corrupt: too many LEDs, truncated literal, reserved opcode, too few LEDs
+  const uint8_t too_many[] = {ANIM_OP_SKIP | 63, ANIM_OP_SKIP | 63};
+  const uint8_t truncated[] = {ANIM_OP_LITERAL | 1, 1, 2, 3};
+  const uint8_t reserved[] = {0xC0 | 0};
+  const uint8_t too_few[] = {ANIM_OP_SKIP | 0};
+  bool rejected = !anim_decode_frame(too_many, 2, dec, FLC::N) &&
+                  !anim_decode_frame(truncated, 4, dec, FLC::N) &&
+                  !anim_decode_frame(reserved, 1, dec, FLC::N) &&
+                  !anim_decode_frame(too_few, 1, dec, FLC::N);
+  return check(rejected, "codec: rejects corrupt frames") && ok;
+}
+
+/*------------------------------------------------------------------------------
+  record
+------------------------------------------------------------------------------*/
+
+static bool play_back(uint32_t n_frames) {
+  /* Play back the recording, checking each frame against `pattern()`
+   */
+  CRGB expect[FLC::N];
+  AnimPlayer player;
+  bool ok = player.begin();
+
+  for (uint32_t i = 0; ok && (i < n_frames); i++) {
+    now_ms += FLC::ANIM_PERIOD;
+    const CRGB *frame = player.update();
+    pattern(expect, i);
+    ok &= frame && !memcmp(frame, expect, sizeof(expect));
+  }
+  return ok;
+}
+
+static bool check_record(const char *image) {
+  CRGB frame[FLC::N];
+  AnimRecorder recorder;
+  const uint32_t n_frames = 500;
+
+  now_ms = 0;
+  recorder.start();
+  for (uint32_t i = 0; i < n_frames; i++) {
+    now_ms += FLC::ANIM_PERIOD;
+    pattern(frame, i);
+    recorder.add(frame);
+  }
+  recorder.stop();
+  bool ok = check(play_back(n_frames), "record: plays back frame by frame");
+
+  QSPIFlash::begin(image);
+  return check(play_back(n_frames), "record: persists in the image file") &&
+         ok;
+}
+
+/*------------------------------------------------------------------------------
+  full
+------------------------------------------------------------------------------*/
+
+static bool check_full() {
+  /* Random frames of the worst-case size, until the region is full
+   */
+  CRGB frame[FLC::N];
+  AnimRecorder recorder;
+  AnimHeader header;
+  std::mt19937 rng(2);
+  uint32_t n_added = 0;
+
+  now_ms = 0;
+  recorder.start();
+  while (recorder.is_recording()) {
+    now_ms += FLC::ANIM_PERIOD;
+    for (CRGB &c : frame) {
+      c = CRGB(rng(), rng(), rng());
+    }
+    recorder.add(frame);
+    n_added++;
+  }
+  QSPIFlash::read(FLC::ANIM_ADDR, (uint8_t *)&header, sizeof(header));
+  AnimPlayer player;
+  bool ok = (header.magic == ANIM_MAGIC) &&
+            (header.n_frames == n_added - 1) &&
+            (sizeof(header) + header.n_bytes <= FLC::ANIM_SIZE) &&
+            (sizeof(header) + header.n_bytes + 2 +
+                 ANIM_MAX_FRAME_SIZE(FLC::N) >
+             FLC::ANIM_SIZE) &&
+            player.begin();
+
+  char what[64];
+  snprintf(what, sizeof(what), "full: stops after %u frames, %u bytes",
+           header.n_frames, (unsigned)(sizeof(header) + header.n_bytes));
+  return check(ok, what);
+}
+
+/*------------------------------------------------------------------------------
+  upload
+------------------------------------------------------------------------------*/
+
+class FeedStream : public Stream {
+  /* Hands out its bytes a chunk per `loop()` iteration
+   */
+public:
+  std::vector<uint8_t> bytes;
+  size_t pos = 0;
+  size_t chunk = 61;
+  size_t avail = 0;
+
+  void next_loop() {
+    avail = min(chunk, bytes.size() - pos);
+  }
+  int available() override {
+    return avail;
+  }
+  int read() override {
+    if (!avail) {
+      return -1;
+    }
+    avail--;
+    return bytes[pos++];
+  }
+};
+
+static AnimUploadStatus upload(const std::vector<uint8_t> &file,
+                               uint16_t crc, uint32_t *n_loops) {
+  /* Serial command 'd' followed by `loop()` iterations of 1 ms each, until
+  the upload has finished
+  */
+  AnimUploadStatus status = ANIM_UPLOAD_BUSY;
+  FeedStream feed;
+  feed.bytes = file;
+  feed.bytes.push_back(crc);
+  feed.bytes.push_back(crc >> 8);
+
+  anim_upload.start();
+  for (*n_loops = 0; anim_upload.is_active() && (*n_loops < 100000);
+       (*n_loops)++) {
+    now_ms++;
+    feed.next_loop();
+    status = anim_upload.poll(&feed);
+  }
+  return status;
+}
+
+static uint16_t crc16(const std::vector<uint8_t> &bytes) {
+  uint16_t crc = 0xFFFF;
+  for (uint8_t b : bytes) {
+    crc = crc16_ccitt(crc, b);
+  }
+  return crc;
+}
+
+static bool check_upload() {
+  CRGB frame[FLC::N];
+  AnimRecorder recorder;
+  AnimHeader header;
+  const uint32_t n_frames = 300;
+  uint32_t n_loops;
+  char what[64];
+  bool ok;
+
+  // Record into the flash and read it back as a `.fxan` file
+  now_ms = 0;
+  recorder.start();
+  for (uint32_t i = 0; i < n_frames; i++) {
+    now_ms += FLC::ANIM_PERIOD;
+    pattern(frame, i);
+    recorder.add(frame);
+  }
+  recorder.stop();
+  QSPIFlash::read(FLC::ANIM_ADDR, (uint8_t *)&header, sizeof(header));
+  std::vector<uint8_t> file(sizeof(header) + header.n_bytes);
+  QSPIFlash::read(FLC::ANIM_ADDR, file.data(), file.size());
+
+  ok = (upload(file, crc16(file), &n_loops) == ANIM_UPLOAD_OK) &&
+       play_back(n_frames);
+  snprintf(what, sizeof(what), "upload: %zu bytes over %u loop iterations",
+           file.size(), n_loops);
+  ok = check(ok, what);
+
+  AnimPlayer player;
+  ok &= check((upload(file, crc16(file) ^ 1, &n_loops) ==
+               ANIM_UPLOAD_REJECTED) &&
+                  !player.begin(),
+              "upload: rejects a bad CRC, leaving no valid recording");
+
+  std::vector<uint8_t> bad = file;
+  bad[4] ^= 1; // `numel`
+  uint32_t t0 = now_ms;
+  ok &= (upload(bad, crc16(bad), &n_loops) == ANIM_UPLOAD_REJECTED) &&
+        !player.begin();
+  snprintf(what, sizeof(what), "upload: rejects a bad header after %u ms",
+           now_ms - t0);
+  return check(ok, what) && ok;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  const char *image = argc > 1 ? argv[1] : "anim_check.qspi";
+  bool ok = true;
+
+  printf("Animation, %u LEDs, %u kB region, image %s\n", FLC::N,
+         FLC::ANIM_SIZE / 1024, image);
+  remove(image);
+  QSPIFlash::begin(image);
+  ok &= check_codec();
+  ok &= check_record(image);
+  ok &= check_full();
+  ok &= check_upload();
+  remove(image);
+  return ok ? 0 : 1;
+}
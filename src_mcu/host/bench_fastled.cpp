@@ -0,0 +1,66 @@
+/* FastLED benchmark
+
+Runs the micro-benchmarks of `DvG_FastLED_Benchmark.h` natively on the host
+PC, as serial command 'k' does on the mirror, timed by `std::chrono`. Handy to
+compare the cost of the FastLED primitives across compiler flags or FastLED
+versions without the mirror at hand. Only the ratios carry over to the
+microcontroller.
+
+Usage:
+  bench_fastled
+
+Prints the CSV to stdout, framed by `# begin` and `# end`, with the cycles
+expressed at `F_CPU`. `src_python/benchmark_fastled.py host new.csv` runs it
+and stores the CSV. Fails when the benchmark leaves the seed of FastLED's
+random generator changed.
+
+Build and run with `pio run -e bench_fastled -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <chrono>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Benchmark.h"
+
+Serial_ Serial;
+
+unsigned long micros() {
+  static auto t0 = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - t0)
+      .count();
+}
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+class StdoutStream : public Stream {
+public:
+  size_t write(uint8_t c) override {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+  }
+};
+
+int main() {
+  static CRGB strip[FLC::N];
+  StdoutStream out;
+
+  random16_set_seed(42);
+  benchmark_fastled(&out, strip, FLC::N);
+  fflush(stdout);
+  if (random16_get_seed() != 42) {
+    fprintf(stderr, "The seed of `random16()` got changed\n");
+    return 1;
+  }
+  return 0;
+}
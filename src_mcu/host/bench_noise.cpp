@@ -0,0 +1,161 @@
+/* Noise benchmark
+
+Times `inoise16_path()` of `DvG_FastLED_Noise.h` against per-LED `inoise16()`
+calls on the host PC, over mirrors of 52 up to 10k LEDs, and checks that both
+agree bit for bit. Fails on any mismatch.
+
+Usage:
+  bench_noise
+
+Per geometry and scale, the noise gets sampled along the perimeter like
+`fx__Noise` does, each panel at its own z, for `N_CHECK` frames stepping
+through z, x and y. Every sample of every frame gets compared. Then both get
+timed over the same total number of LEDs. Scale 40 is the one of `fx__Noise`,
+a lattice cell spanning about 6 LEDs. At scale 4096 each LED falls inside a
+new cell, the worst case for the batch. Timings are of the host PC, only
+their ratios carry over to the microcontroller.
+
+Build and run with `pio run -e bench_noise -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Noise.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+const uint32_t LEDS_PER_RUN = 20000000; // Total number of LEDs to time over
+const uint32_t N_CHECK = 2000;          // Frames to compare per geometry
+const uint16_t SCALES[] = {40, 4096};
+
+// clang-format off
+const Geometry geometries[] = {
+  Geometry(13, 13),                                                // 52
+  Geometry(60, 40),                                                // 200
+  Geometry(125, 125),                                              // 500
+  Geometry(250, 250),                                              // 1000
+  Geometry(250, 250, StartCorner::BOTTOM_LEFT, Winding::CCW, 10),  // 10000
+};
+// clang-format on
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+static void frame_coords(uint32_t frame, uint32_t *x0, uint32_t *y0,
+                         uint32_t *z) {
+  /* Drift through the noise field, crossing a lattice cell in z every ~66
+  frames
+  */
+  *x0 = frame * 131;
+  *y0 = frame * 77;
+  *z = frame * 997;
+}
+
+static void per_led(const Geometry &g, const XY16 *path, uint32_t frame,
+                    uint16_t scale, uint16_t *out) {
+  const uint16_t P = g.perimeter();
+  uint32_t x0, y0, z;
+
+  frame_coords(frame, &x0, &y0, &z);
+  for (uint8_t panel = 0; panel < g.n_panels; panel++) {
+    uint32_t zp = z + (uint32_t)panel * 0x100000;
+    for (uint16_t idx = 0; idx < P; idx++) {
+      out[panel * P + idx] = inoise16(x0 + (uint32_t)path[idx].x * scale,
+                                      y0 + (uint32_t)path[idx].y * scale, zp);
+    }
+  }
+}
+
+static void batched(const Geometry &g, const XY16 *path, uint32_t frame,
+                    uint16_t scale, uint16_t *out) {
+  const uint16_t P = g.perimeter();
+  uint32_t x0, y0, z;
+
+  frame_coords(frame, &x0, &y0, &z);
+  for (uint8_t panel = 0; panel < g.n_panels; panel++) {
+    inoise16_path(path, P, x0, y0, z + (uint32_t)panel * 0x100000, scale,
+                  &out[panel * P]);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main() {
+  bool ok = true;
+
+  printf("Noise along the perimeter [ns per LED], %u frames compared\n",
+         N_CHECK);
+  printf("%6s %10s %6s %10s %10s %8s %10s\n", "N", "WxHxP", "scale",
+         "inoise16", "path", "faster", "mismatch");
+
+  for (const Geometry &g : geometries) {
+    const uint32_t N = g.numel();
+    const uint32_t n_frames = LEDS_PER_RUN / N;
+    std::vector<XY16> path(g.perimeter());
+    std::vector<uint16_t> out_1(N);
+    std::vector<uint16_t> out_2(N);
+    char dims[16];
+
+    g.perimeter_xy(path.data());
+    snprintf(dims, sizeof(dims), "%ux%ux%u", g.width, g.height, g.n_panels);
+
+    for (uint16_t scale : SCALES) {
+      uint32_t n_diff = 0;
+      uint32_t checksum = 0;
+
+      for (uint32_t frame = 0; frame < N_CHECK; frame++) {
+        per_led(g, path.data(), frame, scale, out_1.data());
+        batched(g, path.data(), frame, scale, out_2.data());
+        for (uint32_t i = 0; i < N; i++) {
+          n_diff += (out_1[i] != out_2[i]);
+        }
+      }
+
+      auto t0 = std::chrono::steady_clock::now();
+      for (uint32_t frame = 0; frame < n_frames; frame++) {
+        per_led(g, path.data(), frame, scale, out_1.data());
+        checksum += out_1[frame % N]; // Keep the compiler from skipping
+      }
+      double t_1 = seconds_since(t0) * 1e9 / n_frames / N;
+
+      t0 = std::chrono::steady_clock::now();
+      for (uint32_t frame = 0; frame < n_frames; frame++) {
+        batched(g, path.data(), frame, scale, out_2.data());
+        checksum += out_2[frame % N];
+      }
+      double t_2 = seconds_since(t0) * 1e9 / n_frames / N;
+
+      printf("%6u %10s %6u %10.2f %10.2f %7.2fx %10u\n", N, dims, scale, t_1,
+             t_2, t_1 / t_2, n_diff);
+      if (checksum == 0xFFFFFFFF) {
+        printf("\n");
+      }
+      ok &= (n_diff == 0);
+    }
+  }
+  printf("Bit-identical: %s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
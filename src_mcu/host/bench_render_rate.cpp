@@ -0,0 +1,219 @@
+/* Render rate benchmark
+
+Measures the gain and the price of calculating a preset at a render rate below
+the output frame rate, with the frames in between interpolated, see
+`FastLED_EffectManager::update()`. Backs the render rates of the playlists in
+`DvG_FastLED_Playlists.h`.
+
+Usage:
+  bench_render_rate [LIST] [FPS] [MAX_MS]
+
+Each preset of LIST, `day` by default, or `night`, gets rendered for `MAX_MS`,
+default 12000, at an output frame rate of `FPS`, default 250. First every
+frame, then at each render rate of 25, 50 and 100 Hz below `FPS`. The
+quality degradations are off and the preset runs for the full `MAX_MS`.
+Printed per render rate are:
+
+  cost   host time per output frame spent in `update()`, and how many times
+         cheaper that is than calculating every frame
+  error  mean and max absolute difference per colour channel against the
+         every-frame render, delayed by one render period, which is the
+         latency of the interpolation
+
+The render rate of the preset in LIST is marked by '*'. Time is virtual as in
+`host/render.cpp`, hence the errors are exact and the same on every run. Each
+render runs in a child process of its own, as the effects keep their state in
+globals. Timings are of the host PC, only their ratios carry over to the
+microcontroller.
+
+Build and run with `pio run -e bench_render_rate -t exec`, see
+`platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <array>
+#include <chrono>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "FastLED.h"
+#include "FiniteStateMachine.h"
+
+FASTLED_USING_NAMESPACE
+
+#include "DvG_FastLED_EffectManager.h"
+#include "DvG_FastLED_Playlists.h"
+#include "DvG_FastLED_config.h"
+#include "DvG_FastLED_effects.h"
+
+Serial_ Serial;
+
+// No audience measured
+uint8_t IR_dist_cm = 0;
+uint8_t IR_dist_fract = 0;
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+static uint32_t virtual_us = 0;
+
+unsigned long micros() {
+  return virtual_us;
+}
+unsigned long millis() {
+  return virtual_us / 1000;
+}
+
+const uint16_t RATES[] = {25, 50, 100}; // [Hz] Render rates to compare
+
+/*------------------------------------------------------------------------------
+  Rendering
+------------------------------------------------------------------------------*/
+
+struct Run {
+  std::vector<CRGB> frames; // `FLC::N` LEDs per output frame
+  double us = 0;            // [us] Host time per output frame in `update()`
+};
+
+static bool transfer(int fd, void *data, size_t size, bool out) {
+  uint8_t *p = (uint8_t *)data;
+  while (size) {
+    ssize_t n = out ? write(fd, p, size) : read(fd, p, size);
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+static Run render(const FX_preset &preset, uint16_t rate, uint32_t period_us,
+                  uint32_t n_frames) {
+  /* Render `preset` at render rate `rate` [Hz], 0 for every frame, in a
+  child process that hands the frames over by a pipe
+  */
+  Run run;
+  int fd[2];
+
+  run.frames.resize(n_frames * FLC::N);
+  if (pipe(fd)) {
+    perror("pipe");
+    exit(1);
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    static std::array<FX_preset, 1> list;
+    double seconds = 0;
+
+    close(fd[0]);
+    list[0] = preset;
+    list[0].render_rate = rate;
+    list[0].qos = 0;
+    list[0].duration = 0;
+    FastLED_EffectManager mgr(list);
+    mgr.set_fx(0);
+    for (uint32_t i = 0; i < n_frames; i++) {
+      auto t0 = std::chrono::steady_clock::now();
+      mgr.update();
+      seconds += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - t0)
+                     .count();
+      transfer(fd[1], leds, FLC::N * sizeof(CRGB), true);
+      virtual_us += period_us;
+    }
+    run.us = seconds / n_frames * 1e6;
+    transfer(fd[1], &run.us, sizeof(run.us), true);
+    _exit(0);
+  }
+
+  close(fd[1]);
+  bool ok = transfer(fd[0], run.frames.data(),
+                     run.frames.size() * sizeof(CRGB), false) &&
+            transfer(fd[0], &run.us, sizeof(run.us), false);
+  close(fd[0]);
+  waitpid(pid, nullptr, 0);
+  if (!ok) {
+    fprintf(stderr, "Render of %s at %u Hz failed\n", preset.fx->getName(),
+            rate);
+    exit(1);
+  }
+  return run;
+}
+
+static void compare(const Run &ref, const Run &run, uint32_t delay,
+                    double *mean, uint8_t *max_err) {
+  /* Error of `run` against `ref` delayed by `delay` frames
+   */
+  uint64_t sum = 0;
+  uint64_t n = 0;
+
+  *max_err = 0;
+  for (size_t i = delay * FLC::N; i < run.frames.size(); i++) {
+    const CRGB &a = run.frames[i];
+    const CRGB &b = ref.frames[i - delay * FLC::N];
+    for (uint8_t c = 0; c < 3; c++) {
+      uint8_t err = abs(a.raw[c] - b.raw[c]);
+      sum += err;
+      *max_err = max(*max_err, err);
+      n++;
+    }
+  }
+  *mean = n ? (double)sum / n : 0;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  const char *name = argc > 1 ? argv[1] : "day";
+  uint16_t fps = argc > 2 ? atoi(argv[2]) : 250;
+  uint32_t max_ms = argc > 3 ? atol(argv[3]) : 12000;
+
+  if ((strcmp(name, "day") && strcmp(name, "night")) || (fps == 0)) {
+    fprintf(stderr, "Usage: bench_render_rate [day|night] [FPS] [MAX_MS]\n");
+    return 2;
+  }
+  FX_playlist list =
+      strcmp(name, "day") ? FX_playlist(fx_list_night) : fx_list_day;
+  const uint32_t period_us = 1000000UL / fps;
+  const uint32_t n_frames = max_ms * 1000 / period_us;
+
+  // As `setup()` of the firmware
+  generate_HeartBeat();
+  FLC::GEOMETRY.perimeter_xy(perimeter_xy);
+  fill_solid(leds, FLC::N, CRGB::Black);
+
+  printf("Playlist %s, %u FPS, %u ms, %u LEDs\n", name, fps, max_ms, FLC::N);
+  printf("  %-20s %8s %12s %8s %8s %5s\n", "preset", "rate", "cost [us]",
+         "cheaper", "mean err", "max");
+  for (uint16_t idx = 0; idx < list.size(); idx++) {
+    const FX_preset &preset = list[idx];
+    Run ref = render(preset, 0, period_us, n_frames);
+
+    printf("  %-20s %c%7s %12.2f\n", preset.fx->getName(),
+           preset.render_rate ? ' ' : '*', "every", ref.us);
+    for (uint16_t rate : RATES) {
+      if (rate >= fps) {
+        continue;
+      }
+      Run run = render(preset, rate, period_us, n_frames);
+      uint32_t delay = (1000000UL / rate + period_us / 2) / period_us;
+      double mean;
+      uint8_t max_err;
+      compare(ref, run, delay, &mean, &max_err);
+      printf("  %-20s %c%4u Hz %12.2f %7.1fx %8.2f %5u\n", "",
+             preset.render_rate == rate ? '*' : ' ', rate, run.us,
+             ref.us / run.us, mean, max_err);
+    }
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+/* RunningStats benchmark
+
+Times `RunningStats` against `RunningAverage` on the host PC, mimicking the
+use inside `DvG_IR_Distance.h`, like `lib/DvG_RunningStats/examples/
+rs_performance` does on the microcontroller. Then checks the statistics over
+a long run against a brute-force recalculation over the window, and fails
+when the variance drifts away.
+
+Usage:
+  bench_runningstats [N_SAMPLES]
+
+Three signals get checked, `N_SAMPLES` each, default 10 million:
+  walk    Distances of 16 to 150 cm at `IR_FP_SCALE` = 64, like the IR sensor
+  quiet   A large offset with a small noise on top, the worst case for
+          round-off in floating point
+  signed  Levels of -20000 to 20000 as `int16_t`, summed in a signed type
+
+Build and run with `pio run -e bench_runningstats -t exec`, see
+`platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <limits>
+
+#include "DvG_RunningStats.h"
+#include "RunningAverage.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+#define N_WINDOW 20
+#define N_REPEAT 1000000
+
+static uint32_t lcg = 1;
+
+static int32_t rand_range(int32_t lo, int32_t hi) {
+  /* Uniform in [lo, hi), reproducible across platforms
+   */
+  lcg = lcg * 1664525UL + 1013904223UL;
+  return lo + (int32_t)((lcg >> 16) % (uint32_t)(hi - lo));
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+volatile float x;
+
+static void bench() {
+  RunningAverage RA(N_WINDOW);
+  RunningStats<N_WINDOW, uint16_t> RS;
+  auto t0 = std::chrono::steady_clock::now();
+
+  printf("Performance RunningStats vs RunningAverage\n");
+  printf("Window: %d, repeats: %d\n", N_WINDOW, N_REPEAT);
+  printf("All timings in [ns] per call\n\n");
+
+  t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < N_REPEAT; i++) {
+    RA.addValue(rand_range(16, 150));
+    x = RA.getAverage();
+    x = RA.getAverage();
+  }
+  printf("RunningAverage: add + 2x getAverage : %7.1f\n",
+         seconds_since(t0) * 1e9 / N_REPEAT);
+
+  t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < N_REPEAT; i++) {
+    RS.add(rand_range(16, 150) * 64);
+    x = RS.getAverage();
+    x = RS.getAverage();
+  }
+  printf("RunningStats  : add + 2x getAverage : %7.1f\n",
+         seconds_since(t0) * 1e9 / N_REPEAT);
+
+  t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < N_REPEAT; i++) {
+    x = RA.getMinInBuffer();
+    x = RA.getMaxInBuffer();
+    x = RA.getStandardDeviation();
+  }
+  printf("RunningAverage: min, max, std dev   : %7.1f\n",
+         seconds_since(t0) * 1e9 / N_REPEAT);
+
+  t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < N_REPEAT; i++) {
+    x = RS.getMin();
+    x = RS.getMax();
+    x = RS.getStandardDeviation();
+  }
+  printf("RunningStats  : min, max, std dev   : %7.1f\n\n",
+         seconds_since(t0) * 1e9 / N_REPEAT);
+}
+
+template <typename T>
+static bool check(const char *name, uint32_t n_samples, int32_t lo,
+                  int32_t hi, uint16_t noise) {
+  /* Feed `n_samples` samples of type `T` and compare all statistics against a
+  brute-force recalculation over the window, every 1000 samples. Returns
+  false on a relative error in the variance above 1e-5 or any other mismatch.
+  */
+  RunningStats<N_WINDOW, T> RS;
+  T win[N_WINDOW];
+  int32_t level = lo;
+  double max_rel = 0;
+  bool ok = true;
+
+  for (uint32_t i = 0; i < n_samples; i++) {
+    if (i % 200 == 0) {
+      level = rand_range(lo, hi);
+    }
+    T v = level + rand_range(0, noise + 1);
+    RS.add(v);
+    win[i % N_WINDOW] = v;
+
+    if ((i < N_WINDOW) || (i % 1000 != 999)) {
+      continue;
+    }
+    double sum = 0, m2 = 0;
+    T vmin = std::numeric_limits<T>::max();
+    T vmax = std::numeric_limits<T>::min();
+    for (uint16_t j = 0; j < N_WINDOW; j++) {
+      sum += win[j];
+      vmin = min(vmin, win[j]);
+      vmax = max(vmax, win[j]);
+    }
+    double mean = sum / N_WINDOW;
+    for (uint16_t j = 0; j < N_WINDOW; j++) {
+      m2 += (win[j] - mean) * (win[j] - mean);
+    }
+    double var = m2 / N_WINDOW;
+    double rel = fabs(RS.getVariance() - var) / max(var, 1.);
+    max_rel = max(max_rel, rel);
+    ok &= (RS.getSum() == sum) && (RS.getMin() == vmin) &&
+          (RS.getMax() == vmax) && (RS.getAverage() == (float)sum / N_WINDOW);
+  }
+  ok &= (max_rel < 1e-5);
+  printf("%-6s %9u samples, max rel. error variance %.2e : %s\n", name,
+         n_samples, max_rel, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  uint32_t n_samples = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000UL;
+  bool ok = true;
+
+  bench();
+  ok &= check<uint16_t>("walk", n_samples, 16 * 64, 150 * 64, 64);
+  ok &= check<uint16_t>("quiet", n_samples, 60000, 60001, 4);
+  ok &= check<int16_t>("signed", n_samples, -20000, 20000, 64);
+  return ok ? 0 : 1;
+}
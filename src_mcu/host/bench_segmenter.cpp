@@ -0,0 +1,115 @@
+/* Segmenter benchmark
+
+Times `FastLED_StripSegmenter` of `DvG_FastLED_StripSegmenter.h` on the host
+PC over mirrors of 52 up to 10k LEDs, to show that the cost of a frame scales
+linearly with the number of LEDs, whatever the style.
+
+Usage:
+  bench_segmenter
+
+Per geometry and style, `process()` gets timed over the same total number of
+LEDs, as well as `set_style()`, which rebuilds the index mapping. Timings are
+of the host PC, only their scaling carries over to the microcontroller.
+
+The LED data arrays are sized by `FLC::N`, hence the `bench_segmenter`
+environment of `platformio.ini` chains 193 panels of 13 x 13 LEDs by
+`FLC_N_PANELS`, 10036 LEDs. Build and run with
+`pio run -e bench_segmenter -t exec`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <chrono>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_StripSegmenter.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+const uint32_t LEDS_PER_RUN = 50000000; // Total number of LEDs to time over
+
+// clang-format off
+const Geometry geometries[] = {
+  Geometry(13, 13),                                                // 52
+  Geometry(25, 25),                                                // 100
+  Geometry(60, 40),                                                // 200
+  Geometry(125, 125),                                              // 500
+  Geometry(250, 250),                                              // 1000
+  Geometry(250, 250, StartCorner::BOTTOM_LEFT, Winding::CCW, 2),   // 2000
+  Geometry(250, 250, StartCorner::BOTTOM_LEFT, Winding::CCW, 5),   // 5000
+  Geometry(250, 250, StartCorner::BOTTOM_LEFT, Winding::CCW, 10),  // 10000
+};
+// clang-format on
+
+CRGB in[FLC::N];
+CRGB out[FLC::N];
+FastLED_StripSegmenter segmntr;
+
+static double seconds_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main() {
+  static_assert(FLC::N >= 10000, "Build with FLC_N_PANELS >= 193");
+
+  for (uint32_t i = 0; i < FLC::N; i++) {
+    in[i] = CRGB(i, i >> 8, i * 7);
+  }
+
+  printf("Segmenter cost [ns per LED], `process()` and `set_style()`\n");
+  printf("%6s %10s", "N", "WxHxP");
+  for (uint8_t style = 0; style < StyleEnum::EOL; style++) {
+    printf("  %5s%u", "style", style);
+  }
+  printf("  %9s\n", "set_style");
+
+  for (const Geometry &g : geometries) {
+    const uint32_t N = g.numel();
+    const uint32_t n_frames = LEDS_PER_RUN / N;
+    char dims[16];
+    uint32_t checksum = 0;
+    double t_map = 0;
+
+    if (!segmntr.set_geometry(g)) {
+      fprintf(stderr, "Geometry of %u LEDs rejected\n", N);
+      return 1;
+    }
+    snprintf(dims, sizeof(dims), "%ux%ux%u", g.width, g.height, g.n_panels);
+    printf("%6u %10s", N, dims);
+
+    for (uint8_t style = 0; style < StyleEnum::EOL; style++) {
+      auto t0 = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < n_frames / 100 + 1; i++) {
+        segmntr.set_style((StyleEnum)style);
+      }
+      t_map += seconds_since(t0) / (n_frames / 100 + 1);
+
+      t0 = std::chrono::steady_clock::now();
+      for (uint32_t frame = 0; frame < n_frames; frame++) {
+        segmntr.process(out, in);
+        checksum += out[frame % N].r; // Keep the compiler from skipping
+      }
+      printf("  %6.2f", seconds_since(t0) * 1e9 / n_frames / N);
+    }
+    printf("  %9.2f\n", t_map * 1e9 / StyleEnum::EOL / N);
+    if (checksum == 0xFFFFFFFF) {
+      printf("\n");
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,183 @@
+/* Button edge replay
+
+Replays traces of button edges through `ButtonCapture` of
+`DvG_ButtonCapture.h` on the host PC and checks the detected events against
+the expectations in the trace. Fails when any of them differ.
+
+Usage:
+  button_replay [TRACE...]
+
+Each trace gets replayed several times, with `loop()` polling the button
+every 1 ms, every frame of 20 ms, with a random jitter of up to 50 ms and,
+like a blocking menu animation, once every 1200 ms. As the state machine runs
+on the timestamps of the edges, every schedule must detect the very same
+events.
+
+A trace is a text file, see `host/traces/button_*.txt`, with one edge per
+line: `millis()` at the moment of the edge and the pin level right after it.
+The idle level is HIGH, as the button pulls the pin LOW. Further lines:
+  params D L C G      Debounce, long-press, double-click and deglitch period
+                      [ms], default those of the firmware: 50 500 50 10
+  expect EVENT COUNT  Expected number of `pushed`, `released`, `singleClick`,
+                      `longPress` or `doubleClick` events
+Lines starting with '#' get skipped.
+
+Without arguments, the traces `host/traces/button_*.txt` get replayed, run
+from the project directory. Build and run with
+`pio run -e button_replay -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <map>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "DvG_ButtonCapture.h"
+
+Serial_ Serial;
+
+static uint32_t now_ms = 0;
+
+unsigned long millis() {
+  return now_ms;
+}
+unsigned long micros() {
+  return now_ms * 1000;
+}
+
+const uint8_t PIN = 9; // Same as `PIN_BUTTON` of the firmware
+const uint32_t T_TAIL = 20000; // [ms] Keep polling after the last edge
+
+static const char *default_traces[] = {
+    "host/traces/button_click.txt",     "host/traces/button_long_press.txt",
+    "host/traces/button_two_clicks.txt", "host/traces/button_double_click.txt",
+    "host/traces/button_glitches.txt",  "host/traces/button_blocked.txt"};
+
+static const char *event_names[] = {"pushed", "released", "singleClick",
+                                    "longPress", "doubleClick"};
+
+struct Trace {
+  unsigned long periods[4] = {50, 500, 50, 10};
+  std::vector<ButtonEdge> edges;
+  std::map<std::string, int> expect;
+};
+
+static bool read_trace(const char *fn, Trace *trace) {
+  FILE *f = fopen(fn, "r");
+  if (f == NULL) {
+    perror(fn);
+    return false;
+  }
+  char line[128], name[32];
+  while (fgets(line, sizeof(line), f)) {
+    unsigned long a, b, c, d;
+    int count;
+    if (line[0] == '#') {
+      continue;
+    }
+    if (sscanf(line, "params %lu %lu %lu %lu", &a, &b, &c, &d) == 4) {
+      trace->periods[0] = a;
+      trace->periods[1] = b;
+      trace->periods[2] = c;
+      trace->periods[3] = d;
+    } else if (sscanf(line, "expect %31s %d", name, &count) == 2) {
+      trace->expect[name] = count;
+    } else if (sscanf(line, "%lu %lu", &a, &b) == 2) {
+      trace->edges.push_back({(uint32_t)a, b != 0});
+    }
+  }
+  fclose(f);
+  return !trace->edges.empty();
+}
+
+static std::map<std::string, int> replay(const Trace &trace,
+                                         uint32_t poll_period,
+                                         uint32_t jitter) {
+  /* Replay the edges, polling every `poll_period` plus up to `jitter` ms, and
+  count the events
+  */
+  std::map<std::string, int> counts;
+  now_ms = 0;
+  host_pins()[PIN] = HIGH;
+
+  // `Switch` leaves some of its members uninitialized, relying on static
+  // storage, like the global `button` of `main.cpp`. Do likewise.
+  static std::aligned_storage<sizeof(ButtonCapture)>::type storage;
+  memset(&storage, 0, sizeof(storage));
+  ButtonCapture &button = *new (&storage)
+      ButtonCapture(PIN, INPUT_PULLUP, LOW, trace.periods[0], trace.periods[1],
+                    trace.periods[2], trace.periods[3]);
+
+  size_t i = 0;
+  uint32_t t_end = trace.edges.back().t + T_TAIL;
+  uint32_t t_poll = 0;
+  while (now_ms < t_end) {
+    // The interrupt fires at every edge, whatever `loop()` is busy with
+    while ((i < trace.edges.size()) && (trace.edges[i].t <= now_ms)) {
+      host_pins()[PIN] = trace.edges[i].level;
+      button.capture();
+      i++;
+    }
+    if (now_ms >= t_poll) {
+      button.poll();
+      counts["pushed"] += button.pushed();
+      counts["released"] += button.released();
+      counts["singleClick"] += button.singleClick();
+      counts["longPress"] += button.longPress();
+      counts["doubleClick"] += button.doubleClick();
+      t_poll = now_ms + poll_period + (jitter ? random() % (jitter + 1) : 0);
+    }
+    now_ms++;
+  }
+  return counts;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  // Poll period and jitter [ms]
+  const uint32_t schedules[][2] = {{1, 0}, {20, 0}, {0, 50}, {1200, 0}};
+  std::vector<const char *> files;
+  bool all_ok = true;
+
+  for (int i = 1; i < argc; i++) {
+    files.push_back(argv[i]);
+  }
+  if (files.empty()) {
+    for (const char *fn : default_traces) {
+      files.push_back(fn);
+    }
+  }
+  srandom(1);
+
+  for (const char *fn : files) {
+    Trace trace;
+    if (!read_trace(fn, &trace)) {
+      fprintf(stderr, "%s: No edges\n", fn);
+      return 1;
+    }
+    printf("%s: %zu edges\n", fn, trace.edges.size());
+
+    for (auto &sched : schedules) {
+      std::map<std::string, int> counts = replay(trace, sched[0], sched[1]);
+      bool ok = true;
+      printf("  poll %4u ms +%2u :", sched[0], sched[1]);
+      for (const char *name : event_names) {
+        printf(" %s %d", name, counts[name]);
+        if (trace.expect.count(name)) {
+          ok &= (counts[name] == trace.expect[name]);
+        }
+      }
+      printf(" : %s\n", ok ? "ok" : "FAIL");
+      all_ok &= ok;
+    }
+  }
+  return all_ok ? 0 : 1;
+}
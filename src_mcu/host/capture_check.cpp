@@ -0,0 +1,201 @@
+/* Capture check
+
+Checks the frame capture of `DvG_FastLED_Capture.h` on the host PC, against a
+`Serial` that takes only a limited number of bytes per loop iteration. Fails
+when any check does not hold.
+
+Usage:
+  capture_check
+
+Checks:
+  queue     `add()` never writes to `Serial` itself. With enough bandwidth,
+            every frame arrives and decodes back into the original.
+  slow      With too little bandwidth for random frames, frames get dropped
+            whole: the packets that do arrive have consecutive sequence
+            numbers, valid CRCs and decode back into the original frames.
+  boundary  `drain()` reports a packet boundary only when no packet is left
+            half sent
+
+Build and run with `pio run -e capture_check -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <random>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Capture.h"
+
+Serial_ Serial;
+
+static uint32_t now_ms = 0;
+
+unsigned long millis() {
+  return now_ms;
+}
+unsigned long micros() {
+  return now_ms * 1000;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+class SlowSerial : public Stream {
+  /* Takes at most `budget` bytes per `loop()` iteration
+   */
+public:
+  std::vector<uint8_t> bytes;
+  size_t budget = 64;
+  size_t left = 0;
+
+  void next_loop() {
+    left = budget;
+  }
+  int availableForWrite() override {
+    return left;
+  }
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    size = min(size, left);
+    bytes.insert(bytes.end(), buffer, buffer + size);
+    left -= size;
+    return size;
+  }
+};
+
+struct Decoded {
+  std::vector<std::vector<CRGB>> frames;
+  std::vector<uint8_t> seqs;
+  bool ok = true; // All packets valid and back to back
+};
+
+static Decoded decode(const std::vector<uint8_t> &bytes) {
+  /* Decode the packets sent out, like `src_python/capture_frames.py`
+   */
+  Decoded out;
+  std::vector<CRGB> frame(FLC::N);
+  size_t pos = 0;
+
+  while (pos + CAPTURE_HEADER_SIZE + 2 <= bytes.size()) {
+    const uint8_t *p = &bytes[pos];
+    uint16_t len = p[10] | p[11] << 8;
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 2; i < CAPTURE_HEADER_SIZE + len; i++) {
+      crc = crc16_ccitt(crc, p[i]);
+    }
+    out.ok &= (p[0] == STREAM_SYNC_0) && (p[1] == STREAM_SYNC_1) &&
+              (pos + CAPTURE_HEADER_SIZE + len + 2 <= bytes.size()) &&
+              (p[CAPTURE_HEADER_SIZE + len] == (uint8_t)crc) &&
+              (p[CAPTURE_HEADER_SIZE + len + 1] == (uint8_t)(crc >> 8));
+    if (!out.ok) {
+      break;
+    }
+    if (p[2] == CAPTURE_TYPE_KEYFRAME) {
+      fill_solid(frame.data(), FLC::N, CRGB::Black);
+    }
+    out.ok &= anim_decode_frame(p + CAPTURE_HEADER_SIZE, len, frame.data(),
+                                FLC::N);
+    out.frames.push_back(frame);
+    out.seqs.push_back(p[3]);
+    pos += CAPTURE_HEADER_SIZE + len + 2;
+  }
+  out.ok &= (pos == bytes.size());
+  return out;
+}
+
+static void pattern(CRGB *frame, uint32_t i, std::mt19937 *rng) {
+  /* Moving pattern, or random LEDs when `rng` is given
+   */
+  if (rng) {
+    for (uint16_t j = 0; j < FLC::N; j++) {
+      frame[j] = CRGB((*rng)(), (*rng)(), (*rng)());
+    }
+    return;
+  }
+  fill_solid(frame, FLC::N, CRGB::Black);
+  for (uint16_t j = 0; j < FLC::N / 4; j++) {
+    frame[(i + j) % FLC::N] = CHSV(i * 3 + j * 10, 255, 255);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Checks
+------------------------------------------------------------------------------*/
+
+static bool run(size_t budget, std::mt19937 *rng, const char *name) {
+  /* Capture 500 frames, one per loop iteration, each followed by a drain
+   */
+  static FrameCapture capture;
+  std::vector<std::vector<CRGB>> sent;
+  SlowSerial ser;
+  CRGB frame[FLC::N];
+  bool no_writes = true;
+  bool boundary = true;
+  char what[64];
+
+  ser.budget = budget;
+  capture.start();
+  for (uint32_t i = 0; i < 500; i++) {
+    now_ms += 10;
+    pattern(frame, i, rng);
+    ser.next_loop();
+    size_t n_before = ser.bytes.size();
+    capture.add(frame, i < 250 ? 3 : 20, 0);
+    no_writes &= (ser.bytes.size() == n_before);
+    sent.push_back(std::vector<CRGB>(frame, frame + FLC::N));
+    if (capture.drain(&ser)) {
+      boundary &= decode(ser.bytes).ok;
+    }
+  }
+  capture.stop();
+  ser.budget = 1 << 20;
+  ser.next_loop();
+  capture.flush(&ser);
+
+  // Match the decoded frames against the ones sent, in order
+  Decoded dec = decode(ser.bytes);
+  bool ok = dec.ok && no_writes &&
+            (rng ? dec.frames.size() < sent.size()
+                 : dec.frames.size() == sent.size());
+  size_t j = 0;
+  for (size_t i = 0; ok && (i < dec.frames.size()); i++, j++) {
+    while ((j < sent.size()) && (sent[j] != dec.frames[i])) {
+      j++;
+    }
+    ok &= (j < sent.size()) && (dec.seqs[i] == (uint8_t)(dec.seqs[0] + i));
+  }
+  snprintf(what, sizeof(what), "%s: %zu bytes/loop, %zu of %zu frames",
+           name, budget, dec.frames.size(), sent.size());
+  ok = check(ok, what);
+  return check(boundary, rng ? "boundary: slow, random frames"
+                             : "boundary: fast, moving pattern") &&
+         ok;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main() {
+  std::mt19937 rng(1);
+  bool ok = true;
+
+  printf("Capture, %u LEDs, %u bytes queue\n", FLC::N,
+         FLC::CAPTURE_QUEUE_SIZE);
+  ok &= run(256, nullptr, "queue");
+  ok &= run(64, &rng, "slow");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/* Decay check
+
+Checks that `FastLED_Decay` of `DvG_FastLED_Decay.h` is equivalent to the
+original fade it replaces,
+
+  EVERY_N_MILLIS(10) {
+    fadeToBlackBy(leds, numel, fade);
+  }
+
+at different frame rates. Fails when any check does not hold.
+
+Usage:
+  decay_check
+
+Per fade amount of 1, 5, 14 and 24, one LED starting at (255, 128, 16) gets
+decayed for 2 s at 25, 50, 100 and 250 FPS. At each frame it is compared
+against the original ticks due by then, as the worst channel error. Up to
+100 FPS each tick gets a pass of its own, which has to match the original
+exactly. Above 100 FPS the decay runs ahead of the ticks in between, and has
+to stay within `MAX_ERR_250` and `MEAN_ERR_250` of them.
+
+Build and run with `pio run -e decay_check -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Decay.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+const uint8_t FADES[] = {1, 5, 14, 24};
+const uint16_t FPS[] = {25, 50, 100, 250};
+const uint32_t DURATION = 2000; // [ms]
+const uint16_t TICK = 10;       // [ms]
+
+// Bounds at 250 FPS, where the decay does not wait for the original ticks
+const uint8_t MAX_ERR_250 = 20;
+const float MEAN_ERR_250 = 2.5f;
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool check_fade(uint8_t fade, uint16_t fps) {
+  const CRGB start(255, 128, 16);
+  const uint32_t period = 1000 / fps; // [ms]
+  FastLED_Decay decay(fade, TICK);
+  CRGB led = start;
+  CRGB ref = start;
+  uint32_t n_ticks = 0;
+  uint32_t n_frames = 0;
+  uint32_t sum_err = 0;
+  uint8_t max_err = 0;
+
+  for (uint32_t t = period; t <= DURATION; t += period) {
+    fx_dt = period;
+    decay.apply(&led, 1);
+    for (; n_ticks < t / TICK; n_ticks++) {
+      fadeToBlackBy(&ref, 1, fade);
+    }
+    uint8_t err = 0;
+    for (uint8_t c = 0; c < 3; c++) {
+      err = max(err, (uint8_t)abs(led.raw[c] - ref.raw[c]));
+    }
+    max_err = max(max_err, err);
+    sum_err += err;
+    n_frames++;
+  }
+
+  float mean_err = (float)sum_err / n_frames;
+  bool ok = (fps <= 1000 / TICK)
+                ? (max_err == 0)
+                : (max_err <= MAX_ERR_250) && (mean_err <= MEAN_ERR_250);
+  char what[64];
+  snprintf(what, sizeof(what), "fade %2u, %3u FPS: max error %2u, mean %.2f",
+           fade, fps, max_err, mean_err);
+  return check(ok, what);
+}
+
+int main() {
+  bool ok = true;
+
+  printf("FastLED_Decay against `fadeToBlackBy()` every %u ms\n", TICK);
+  for (uint8_t fade : FADES) {
+    for (uint16_t fps : FPS) {
+      ok &= check_fade(fade, fps);
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+/* IR distance replay
+
+Replays a recorded trace of the IR distance sensor through the filters of
+`DvG_IR_Distance.h` on the host PC, in a simulated render loop, and measures
+how far behind each filter lags and how noisy it is. Record traces on the
+mirror, or synthesize them, with `src_python/ir_trace.py`.
+
+Usage:
+  ir_replay [TRACE...] [--fps FPS] [--render MS]
+
+A trace is a text file, one sample per line: `micros()` / 1000 at the moment
+of sampling, the 10-bit reading and optionally the true distance [cm] when
+known, whitespace separated. Lines starting with '#' get skipped.
+
+Frames get calculated at `FPS`, default 100, each taking `MS` ms, default 4,
+from calling `publish()` up to `frame_sent()`. Samples get added as soon as
+they are due, just like the firmware samples the sensor in between frames.
+
+Per filter, against a reference distance:
+  lag    Time shift of the reference that matches the output best [ms]
+  err    RMS error of the output against the reference at that moment [cm]
+  @lag   RMS error left after shifting the reference by the lag [cm]
+  noise  RMS of the output about its own average over 500 ms, where the
+         reference stays within 1 cm over that time [cm]
+
+The reference is the true distance when the trace holds it. Otherwise, it is
+the median of 3 of the calibrated readings, averaged over 9 samples centered
+in time: Quiet, and not lagging behind, which only works after the fact.
+
+After each trace, its sample-to-frame latency histogram of the filter selected
+by `FLC::IR_PREDICT` gets printed, as on the mirror by serial command 'h'.
+
+Without traces given, the synthesized traces the filters got tuned on,
+`host/traces/ir_synth_*.txt` of `ir_trace.py synth --seed 1` to 3, get
+replayed, run from the project directory. Build and run with
+`pio run -e ir_replay -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_IR_Distance.h"
+
+Serial_ Serial;
+
+static const char *default_traces[] = {"host/traces/ir_synth_1.txt",
+                                       "host/traces/ir_synth_2.txt",
+                                       "host/traces/ir_synth_3.txt"};
+
+struct TracePoint {
+  uint32_t t_us;
+  uint16_t bitval;
+  float truth_cm; // < 0: Unknown
+};
+
+struct Series {
+  std::vector<uint32_t> t_us;
+  std::vector<float> cm;
+
+  float at(int64_t t) const {
+    /* Linearly interpolated value at time `t` [us], clamped at the ends
+     */
+    auto it = std::lower_bound(t_us.begin(), t_us.end(), t);
+    if (it == t_us.begin()) {
+      return cm.front();
+    }
+    if (it == t_us.end()) {
+      return cm.back();
+    }
+    size_t i = it - t_us.begin();
+    float w = (float)(t - t_us[i - 1]) / (t_us[i] - t_us[i - 1]);
+    return cm[i - 1] + w * (cm[i] - cm[i - 1]);
+  }
+};
+
+static bool read_trace(const char *fn, std::vector<TracePoint> *trace) {
+  FILE *f = fopen(fn, "r");
+  if (f == NULL) {
+    perror(fn);
+    return false;
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    double t_ms, truth;
+    unsigned bitval;
+    if (line[0] == '#') {
+      continue;
+    }
+    int n = sscanf(line, "%lf %u %lf", &t_ms, &bitval, &truth);
+    if (n >= 2) {
+      trace->push_back({(uint32_t)(t_ms * 1000), (uint16_t)bitval,
+                        n == 3 ? (float)truth : -1});
+    }
+  }
+  fclose(f);
+  return trace->size() > 1;
+}
+
+static Series reference(const std::vector<TracePoint> &trace) {
+  /* The true distance when known, otherwise the centered average over 9
+  samples of the median of 3 of the calibrated readings
+  */
+  Series ref;
+  bool truth = true;
+  for (const TracePoint &p : trace) {
+    truth &= (p.truth_cm >= 0);
+  }
+
+  std::vector<float> med(trace.size());
+  for (size_t i = 0; i < trace.size(); i++) {
+    size_t i_prev = i > 0 ? i - 1 : i;
+    size_t i_next = i + 1 < trace.size() ? i + 1 : i;
+    float a = IR_Distance::to_cm(trace[i_prev].bitval);
+    float b = IR_Distance::to_cm(trace[i].bitval);
+    float c = IR_Distance::to_cm(trace[i_next].bitval);
+    med[i] = std::max(std::min(a, b), std::min(std::max(a, b), c));
+  }
+
+  for (size_t i = 0; i < trace.size(); i++) {
+    ref.t_us.push_back(trace[i].t_us);
+    if (truth) {
+      ref.cm.push_back(trace[i].truth_cm);
+      continue;
+    }
+    size_t i0 = i >= 4 ? i - 4 : 0;
+    size_t i1 = std::min(i + 4, trace.size() - 1);
+    float sum = 0;
+    for (size_t j = i0; j <= i1; j++) {
+      sum += med[j];
+    }
+    ref.cm.push_back(sum / (i1 - i0 + 1));
+  }
+  return ref;
+}
+
+static Series replay(IR_Distance &ir, const std::vector<TracePoint> &trace,
+                     uint32_t period_us, uint32_t render_us) {
+  /* Run the render loop over the trace, returning the published distance
+  per frame
+  */
+  Series out;
+  size_t i = 0;
+  for (uint32_t t = trace.front().t_us; t <= trace.back().t_us;
+       t += period_us) {
+    while ((i < trace.size()) && (trace[i].t_us <= t)) {
+      ir.add(trace[i].bitval, trace[i].t_us);
+      i++;
+    }
+    out.t_us.push_back(t);
+    out.cm.push_back(ir.publish(t));
+    ir.frame_sent(t + render_us);
+  }
+  return out;
+}
+
+static float rms(const Series &out, const Series &ref, int32_t shift_us) {
+  /* RMS of the output minus the reference `shift_us` earlier
+   */
+  double sum = 0;
+  for (size_t i = 0; i < out.t_us.size(); i++) {
+    float e = out.cm[i] - ref.at((int64_t)out.t_us[i] - shift_us);
+    sum += e * e;
+  }
+  return sqrt(sum / out.t_us.size());
+}
+
+static float noise(const Series &out, const Series &ref) {
+  /* RMS of the output about its own centered average over 500 ms, over the
+  stretches where the reference stays within 1 cm over that time
+  */
+  const size_t n = out.t_us.size();
+  std::vector<double> cumsum(n + 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    cumsum[i + 1] = cumsum[i] + out.cm[i];
+  }
+
+  double sum = 0;
+  size_t n_sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    int64_t t = out.t_us[i];
+    if (fabs(ref.at(t + 250000) - ref.at(t - 250000)) >= 1) {
+      continue;
+    }
+    size_t i0 = std::lower_bound(out.t_us.begin(), out.t_us.end(),
+                                 t - 250000) - out.t_us.begin();
+    size_t i1 = std::upper_bound(out.t_us.begin(), out.t_us.end(),
+                                 t + 250000) - out.t_us.begin();
+    float e = out.cm[i] - (cumsum[i1] - cumsum[i0]) / (i1 - i0);
+    sum += e * e;
+    n_sum++;
+  }
+  return n_sum ? sqrt(sum / n_sum) : NAN;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  std::vector<const char *> files;
+  uint32_t fps = 100;
+  float render_ms = 4;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--fps") && (i + 1 < argc)) {
+      fps = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--render") && (i + 1 < argc)) {
+      render_ms = atof(argv[++i]);
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  if (fps == 0) {
+    fprintf(stderr, "Usage: ir_replay [TRACE...] [--fps FPS] [--render MS]\n");
+    return 2;
+  }
+  if (files.empty()) {
+    for (const char *fn : default_traces) {
+      files.push_back(fn);
+    }
+  }
+
+  const uint32_t period_us = 1000000UL / fps;
+  const uint32_t render_us = render_ms * 1000;
+
+  for (const char *fn : files) {
+    std::vector<TracePoint> trace;
+    if (!read_trace(fn, &trace)) {
+      fprintf(stderr, "%s: No samples\n", fn);
+      return 1;
+    }
+    Series ref = reference(trace);
+    bool truth = trace.front().truth_cm >= 0;
+
+    printf("%s: %zu samples, %.1f s, reference: %s\n", fn, trace.size(),
+           (trace.back().t_us - trace.front().t_us) / 1e6,
+           truth ? "true distance" : "centered average");
+    printf("  %-10s %8s %8s %8s %8s\n", "filter", "lag", "err", "@lag",
+           "noise");
+
+    for (uint8_t predict = 0; predict < 2; predict++) {
+      IR_Distance ir;
+      ir.set_predict(predict);
+      Series out = replay(ir, trace, period_us, render_us);
+
+      int32_t best_lag = 0;
+      float best = INFINITY;
+      for (int32_t lag = -100; lag <= 500; lag++) {
+        float e = rms(out, ref, lag * 1000);
+        if (e < best) {
+          best = e;
+          best_lag = lag;
+        }
+      }
+      printf("  %-10s %8d %8.2f %8.2f %8.2f\n", IR_filter_names[predict],
+             best_lag, rms(out, ref, 0), best, noise(out, ref));
+    }
+
+    // A fresh filter, as the clock of the next trace starts over
+    IR_Distance latency;
+    replay(latency, trace, period_us, render_us);
+    fflush(stdout);
+    latency.print_latency(&Serial);
+  }
+  return 0;
+}
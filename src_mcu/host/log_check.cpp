@@ -0,0 +1,173 @@
+/* Log check
+
+Checks the buffered logging of `DvG_Logger.h` on the host PC, against a
+`Serial` that takes only a limited number of bytes per loop iteration. Fails
+when any check does not hold.
+
+Usage:
+  log_check
+
+Checks:
+  whole     `drain()` writes each text line and each binary packet whole,
+            never more than `availableForWrite()`, and keeps the rest queued
+  dropped   Records dropped on a full buffer get reported in sequence: the
+            LOG_DROPPED line follows the records logged before the drop and
+            precedes the ones logged after it, with the right count
+
+Build and run with `pio run -e log_check -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_Logger.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+class SlowSerial : public Stream {
+  /* Takes at most `budget` bytes per `loop()` iteration, keeping each write
+  apart
+  */
+public:
+  std::vector<std::string> writes;
+  size_t budget = 64;
+  size_t left = 0;
+  bool overrun = false; // Got written more than `availableForWrite()`
+
+  void next_loop() {
+    left = budget;
+  }
+  int availableForWrite() override {
+    return left;
+  }
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    overrun |= (size > left) && (left < budget);
+    left -= min(size, left);
+    writes.push_back(std::string((const char *)buffer, size));
+    return size;
+  }
+};
+
+static bool valid_packet(const std::string &w) {
+  /* One whole binary packet with a valid CRC
+   */
+  uint16_t crc = 0xFFFF;
+  if ((w.size() < 7) || ((uint8_t)w[0] != STREAM_SYNC_0) ||
+      ((uint8_t)w[1] != STREAM_SYNC_1) || ((uint8_t)w[2] != LOG_TYPE)) {
+    return false;
+  }
+  for (size_t i = 2; i < w.size() - 2; i++) {
+    crc = crc16_ccitt(crc, w[i]);
+  }
+  return ((uint8_t)w[w.size() - 2] == (uint8_t)crc) &&
+         ((uint8_t)w[w.size() - 1] == (uint8_t)(crc >> 8));
+}
+
+/*------------------------------------------------------------------------------
+  Checks
+------------------------------------------------------------------------------*/
+
+static bool check_whole(bool binary) {
+  SlowSerial ser;
+  uint32_t n_loops = 0;
+  bool ok = true;
+  char what[64];
+
+  Log::binary = binary;
+  ser.budget = 24;
+  for (uint32_t i = 0; i < 6; i++) {
+    Log::log(LOG_IR_DIST, i, 1000 + i, 12.5f, i * 7);
+    Log::log(LOG_FX, i, "RainbowSurf");
+  }
+  while (Log::used() && (n_loops < 1000)) {
+    ser.next_loop();
+    Log::drain(&ser);
+    n_loops++;
+  }
+  for (const std::string &w : ser.writes) {
+    ok &= binary ? valid_packet(w)
+                 : (w.size() > 2) && (w.find("\r\n") == w.size() - 2);
+  }
+  ok &= (ser.writes.size() == 12) && !Log::n_dropped && !ser.overrun && !Log::used();
+  snprintf(what, sizeof(what), "whole: %s, 12 records over %u loops",
+           binary ? "binary" : "text", n_loops);
+  return check(ok, what);
+}
+
+static bool check_dropped() {
+  SlowSerial ser;
+  std::vector<std::string> expect;
+  uint32_t i = 0;
+  uint32_t n_dropped = 0;
+
+  Log::binary = false;
+  ser.budget = 1 << 20;
+
+  // Fill up the buffer, then log on to drop records
+  while (!Log::n_dropped) {
+    expect.push_back(std::to_string(i) + "\r\n");
+    Log::log(LOG_FPS, i++);
+  }
+  expect.pop_back();
+  for (; n_dropped < 5; n_dropped++) {
+    Log::log(LOG_FPS, i++);
+  }
+  n_dropped++;
+
+  // Make room for a few records, then log on
+  for (uint8_t j = 0; j < 4; j++) {
+    ser.next_loop();
+    Log::drain(&ser);
+  }
+  expect.push_back("Log: " + std::to_string(n_dropped) +
+                   " records dropped\r\n");
+  for (uint32_t j = 0; j < 3; j++) {
+    expect.push_back(std::to_string(i) + "\r\n");
+    Log::log(LOG_FPS, i++);
+  }
+  while (Log::used()) {
+    ser.next_loop();
+    Log::drain(&ser);
+  }
+
+  char what[64];
+  snprintf(what, sizeof(what), "dropped: %u records, reported in sequence",
+           n_dropped);
+  return check(ser.writes == expect, what);
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main() {
+  bool ok = true;
+
+  printf("Logger, %u bytes buffer, %u records per drain\n",
+         FLC::LOG_BUFFER_SIZE, FLC::LOG_DRAIN_MAX);
+  ok &= check_whole(false);
+  ok &= check_whole(true);
+  ok &= check_dropped();
+  return ok ? 0 : 1;
+}
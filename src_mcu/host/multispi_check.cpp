@@ -0,0 +1,140 @@
+/* MultiSPI check
+
+Builds the parallel APA102 output of `DvG_APA102_MultiSPI.h` on the host PC,
+against the SERCOM SPI stand-in of `host/SPI.h`, and checks it. Fails when
+any check does not hold.
+
+Usage:
+  multispi_check
+
+Checks:
+  slices   For every channel count of 1 to 4 and a range of geometries, the
+           channel slices are contiguous and cover the full strip
+  frames   After `FastLED.show()`, the SPI port of each of the
+           `FLC::N_CHANNELS` channels holds the APA102 frame of its own slice
+           of `leds`, with its pins muxed and clock set as per the pin table
+  ports    The SPI ports of the channels not in use are left alone
+
+The `multispi_check` environment of `platformio.ini` builds for 3 channels by
+`FLC_N_CHANNELS`, leaving one port unused. Build and run with
+`pio run -e multispi_check -t exec`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_APA102_MultiSPI.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+CRGB leds[FLC::N];
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static bool check_slices() {
+  // clang-format off
+  const Geometry geometries[] = {
+    Geometry(13, 13),
+    Geometry(20, 8),
+    Geometry(13, 13, StartCorner::BOTTOM_LEFT, Winding::CCW, 2),
+    Geometry(13, 13, StartCorner::BOTTOM_LEFT, Winding::CCW, 3),
+    Geometry(10, 5, StartCorner::BOTTOM_LEFT, Winding::CCW, 4),
+  };
+  // clang-format on
+  bool ok = true;
+
+  for (const Geometry &g : geometries) {
+    for (uint8_t n_ch = 1; n_ch <= 4; n_ch++) {
+      uint32_t next = 0;
+      for (uint8_t ch = 0; ch < n_ch; ch++) {
+        ok &= (channel_start(g, ch, n_ch) == next);
+        ok &= (channel_numel(g, ch, n_ch) > 0);
+        next += channel_numel(g, ch, n_ch);
+      }
+      ok &= (next == g.numel());
+      ok &= (max_channel_numel(g, n_ch) <= g.numel());
+    }
+  }
+  return check(ok, "slices: contiguous and covering, 1 - 4 channels");
+}
+
+static std::vector<uint8_t> apa102_frame(const CRGB *slice, uint32_t n) {
+  /* Expected APA102 byte stream of `n` LEDs at full brightness, BGR order
+   */
+  std::vector<uint8_t> frame(4, 0x00);
+  for (uint32_t i = 0; i < n; i++) {
+    frame.insert(frame.end(), {0xFF, slice[i].b, slice[i].g, slice[i].r});
+  }
+  for (uint32_t i = 0; i <= n / 32; i++) {
+    frame.insert(frame.end(), {0xFF, 0x00, 0x00, 0x00});
+  }
+  return frame;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main() {
+  bool ok = true;
+
+  printf("MultiSPI, %u LEDs over %u channels\n", FLC::N, FLC::N_CHANNELS);
+  ok &= check_slices();
+
+  for (uint32_t i = 0; i < FLC::N; i++) {
+    leds[i] = CRGB(i, 255 - i, i * 7);
+  }
+  MultiSPI::begin(leds);
+  FastLED.setBrightness(255);
+  FastLED.setDither(DISABLE_DITHER);
+  FastLED.show();
+
+  const uint8_t pin_data[] = {PIN_SPI_MOSI, A4, 1, SDA};
+  const uint8_t pin_clk[] = {PIN_SPI_SCK, A1, 0, SCL};
+  const EPioType pio[] = {PIO_SERCOM_ALT, PIO_SERCOM_ALT, PIO_SERCOM_ALT,
+                          PIO_SERCOM};
+  for (uint8_t ch = 0; ch < FLC::N_CHANNELS; ch++) {
+    SPIClass *spi = MultiSPI::port(ch);
+    const uint32_t start = channel_start(FLC::GEOMETRY, ch, FLC::N_CHANNELS);
+    const uint32_t n = channel_numel(FLC::GEOMETRY, ch, FLC::N_CHANNELS);
+    char what[64];
+
+    snprintf(what, sizeof(what), "frames: channel %u, LEDs %u - %u, %u bytes",
+             ch, start, start + n - 1, (unsigned)spi->last.size());
+    ok &= check((spi->n_transfers == 1) &&
+                    (spi->last == apa102_frame(leds + start, n)),
+                what);
+    snprintf(what, sizeof(what), "frames: channel %u, pins %u / %u, %u Hz", ch,
+             pin_data[ch], pin_clk[ch], spi->clock);
+    ok &= check(spi->began && (spi->clock == FLC::SPI_CLOCK) &&
+                    (host_pin_pio()[pin_data[ch]] == pio[ch]) &&
+                    (host_pin_pio()[pin_clk[ch]] == pio[ch]),
+                what);
+  }
+
+  // Constructs the ports not in use, but none of them should have begun
+  bool unused = true;
+  for (uint8_t ch = FLC::N_CHANNELS; ch < 4; ch++) {
+    unused &= !MultiSPI::port(ch)->began;
+  }
+  ok &= check(unused, "ports: the ones not in use are left alone");
+
+  fflush(stdout);
+  MultiSPI::print_timing(&Serial);
+  return ok ? 0 : 1;
+}
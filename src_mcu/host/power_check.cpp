@@ -0,0 +1,110 @@
+/* Power check
+
+Checks the power model and limiter of `DvG_FastLED_Power.h` against the
+measurements in `notes.txt`. Fails when any check does not hold.
+
+Usage:
+  power_check
+
+Checks, with the figures scaled by `FLC::N / FLC::POWER_CAL_N` when the strip
+is not the 52 LEDs measured:
+  idle      All LEDs off draw 58 mA
+  white     All LEDs full white draw 1.3 A, as on the 2.5 A supply
+  capped    Full white gets capped to within `FLC::POWER_BUDGET`, below the
+            1.13 A the underpowered 2.0 A supply managed, and as close to the
+            budget as one brightness step allows
+  restore   Back to all off, the cap returns to full brightness
+  flash     A single frame of full white in between black ones, like
+            `fx__Strobe`, gets capped on that very frame
+
+Build and run with `pio run -e power_check -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Power.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+// Measured on 52 LEDs, see `notes.txt`
+const float IDLE_mA = 58;
+const float FULL_WHITE_mA = 1300;
+const float SUPPLY_2A_mA = 1130; // What the 2.0 A supply managed
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static void run(PowerLimiter &limiter, const CRGB *leds, uint16_t n_frames) {
+  for (uint16_t i = 0; i < n_frames; i++) {
+    limiter.update(leds, 255);
+  }
+}
+
+int main() {
+  static PowerLimiter limiter;
+  static CRGB leds[FLC::N];
+  const float scale = (float)FLC::N / FLC::POWER_CAL_N;
+  const float budget = FLC::POWER_BUDGET;
+  char what[64];
+  bool ok = true;
+
+  printf("PowerLimiter, %u LEDs, calibrated on %u, budget %u mA\n", FLC::N,
+         FLC::POWER_CAL_N, FLC::POWER_BUDGET);
+
+  fill_solid(leds, FLC::N, CRGB::Black);
+  run(limiter, leds, 1);
+  float mA = limiter.estimate_mA(255);
+  snprintf(what, sizeof(what), "idle: %.1f mA, expected %.1f", mA,
+           IDLE_mA * scale);
+  ok &= check(fabsf(mA - IDLE_mA * scale) < 0.5f, what);
+
+  fill_solid(leds, FLC::N, CRGB::White);
+  run(limiter, leds, 1);
+  mA = limiter.estimate_mA(255);
+  snprintf(what, sizeof(what), "white: %.1f mA, expected %.1f", mA,
+           FULL_WHITE_mA * scale);
+  ok &= check(fabsf(mA - FULL_WHITE_mA * scale) < 1, what);
+
+  uint8_t cap = limiter.cap();
+  mA = limiter.estimate_mA(cap);
+  float step = (limiter.estimate_mA(255) - limiter.estimate_mA(0)) / 255;
+  snprintf(what, sizeof(what), "capped: brightness %u, %.1f mA", cap, mA);
+  ok &= check((mA <= budget) && (mA <= SUPPLY_2A_mA * scale) &&
+                  (mA > budget - step),
+              what);
+
+  fill_solid(leds, FLC::N, CRGB::Black);
+  run(limiter, leds, 255 * (FLC::POWER_HOLD + 1) + 1);
+  snprintf(what, sizeof(what), "restore: brightness cap %u", limiter.cap());
+  ok &= check(limiter.cap() == 255, what);
+
+  fill_solid(leds, FLC::N, CRGB::White);
+  uint8_t brightness = limiter.update(leds, 255);
+  mA = limiter.estimate_mA(brightness);
+  fill_solid(leds, FLC::N, CRGB::Black);
+  limiter.update(leds, 255);
+  snprintf(what, sizeof(what), "flash: brightness %u, %.1f mA", brightness,
+           mA);
+  ok &= check((brightness == cap) && (mA <= budget), what);
+
+  return ok ? 0 : 1;
+}
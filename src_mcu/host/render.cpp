@@ -0,0 +1,372 @@
+/* Offline renderer
+
+Renders FastLED effects of the infinity mirror on the host PC, in virtual
+time, into capture files. Each run renders a single job, so that
+`src_python/render_offline.py` can run many jobs in parallel, one process per
+core. The effects keep their state in globals, hence a process per job
+instead of a thread per job.
+
+Usage:
+  render jobs LIST                           List the jobs of LIST
+  render job LIST IDX OUT.fxcap [FPS] [MAX_MS] [WARMUP_MS]
+  render anim LIST IDX OUT.fxan [MAX_MS] [WARMUP_MS]
+  render qos LIST IDX THROTTLE[,THROTTLE...] [MAX_MS]
+  render bench                               Benchmark the layers
+
+LIST:
+  day, night  Each job is a preset of that playlist, see
+              `DvG_FastLED_Playlists.h`. The preceding preset runs for
+              `WARMUP_MS` first, unrecorded, so that effects fading from the
+              previous `leds` start from something alike on the mirror.
+  matrix      Each job is an effect of `matrix_fx` in one of the strip
+              segmentation styles, i.e. IDX = effect * StyleEnum::EOL + style.
+              Rendered from black.
+
+`jobs` prints one line per job: IDX, effect name, style index and style name,
+tab separated.
+
+`job` renders until the effect has finished, or for `MAX_MS` at most,
+default 20000. Frames come at a fixed period of 1000 / `FPS` ms, default 100,
+going through `FastLED_EffectManager::update()` just like on the mirror,
+including the interpolation of presets with a render rate. Time is virtual,
+hence each job renders as fast as the host allows, and exactly the same on
+every run.
+
+The output is a capture file as written by `src_python/capture_frames.py`:
+  "FXCP", uint16 number of LEDs, then per frame:
+  uint32 [ms] timestamp, uint8 effect, uint8 style, 3 bytes RGB per LED
+with the effect being the preset index, or the index into `matrix_fx`.
+
+`anim` renders like `job` at 100 FPS, but records the frames with
+`AnimRecorder` of `DvG_FastLED_Animation.h` every `FLC::ANIM_PERIOD` ms, as
+serial command 'a' does on the mirror. Being virtual time, effects too
+expensive to record on the mirror in real time keep their exact timing. The
+recording stops early when it fills `FLC::ANIM_SIZE`. The output is the
+recording exactly as it sits in the QSPI flash, to be uploaded by
+`src_python/upload_anim.py` and played by serial command 'y'.
+
+`qos` validates the quality-of-service governor of `FastLED_EffectManager`
+against a throttled clock: time advances by the host time spent in `update()`
+multiplied by `THROTTLE`, emulating a microcontroller that many times slower,
+plus `FLC::QOS_SHOW_US` for the rest of the loop. The preset runs without end
+for `MAX_MS` per throttle, default 10000, one throttle after the other without
+resetting the governor. Printed once per second are the frame rate, the
+quality level and the effect cost as governed. Timings are of the host, hence
+the levels differ somewhat from run to run.
+
+`bench` runs `benchmark_layers()` on `layers_demo` against the real clock of
+the host, see `DvG_FastLED_Layers.h`.
+
+Build with `pio run -e render`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "FastLED.h"
+#include "FiniteStateMachine.h"
+
+FASTLED_USING_NAMESPACE
+
+#include "DvG_FastLED_EffectManager.h"
+#include "DvG_FastLED_Playlists.h"
+#include "DvG_FastLED_config.h"
+#include "DvG_FastLED_effects.h"
+
+Serial_ Serial;
+
+// No audience measured
+uint8_t IR_dist_cm = 0;
+uint8_t IR_dist_fract = 0;
+
+// Referenced by FastLED's `blur2d()`, which goes unused. On the mirror the
+// linker drops it.
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+/*------------------------------------------------------------------------------
+  Virtual time
+------------------------------------------------------------------------------*/
+
+static uint32_t virtual_us = 0;
+static bool real_clock = false; // Use the clock of the host instead, to time
+static double throttle = 0; // When > 0, run the host clock this many times
+                            // slower from `t_throttle` onwards, see `qos`
+static std::chrono::steady_clock::time_point t_throttle;
+
+static double host_us_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::micro>(
+             std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+unsigned long micros() {
+  if (real_clock) {
+    static auto t0 = std::chrono::steady_clock::now();
+    return host_us_since(t0);
+  }
+  if (throttle > 0) {
+    return virtual_us + (uint32_t)(host_us_since(t_throttle) * throttle);
+  }
+  return virtual_us;
+}
+
+unsigned long millis() {
+  return real_clock ? micros() / 1000 : virtual_us / 1000;
+}
+
+/*------------------------------------------------------------------------------
+  Jobs
+------------------------------------------------------------------------------*/
+
+// Effects of the `matrix` jobs. Left out are the overrides and the effects
+// depending on hardware or on a host PC.
+// clang-format off
+State *const matrix_fx[] = {
+  &fx__FadeToRed  , &fx__HeartBeatAwaken, &fx__HeartBeat , &fx__HeartBeat_2,
+  &fx__Rainbow    , &fx__Sinelon        , &fx__BPM       , &fx__Juggle,
+  &fx__Strobe     , &fx__Dennis         , &fx__Try       , &fx__DoubleWave,
+  &fx__RainbowBarf, &fx__RainbowBarf_2  , &fx__RainbowHeartBeat,
+  &fx__RainbowSurf, &fx__Noise          , &fx__VM0       , &fx__VM1,
+  &fx__VM2        , &fx__VM3            , &fx__Layers,
+};
+// clang-format on
+const uint16_t N_MATRIX_FX = sizeof(matrix_fx) / sizeof(matrix_fx[0]);
+const uint16_t N_STYLES = (uint16_t)StyleEnum::EOL;
+
+// Playlist holding the single preset of a `matrix` job
+static std::array<FX_preset, 1> matrix_list;
+
+struct Job {
+  FX_playlist list;
+  uint16_t idx;    // Index of the preset to record inside `list`
+  uint16_t fx_id;  // Effect as written to the capture file
+  uint16_t n_jobs; // Number of jobs of this kind
+  bool warmup;     // Run the previous preset of `list` first?
+};
+
+static bool get_job(const char *name, uint16_t idx, Job *job) {
+  /* Look up job `idx` of the jobs `name`. Returns false when unknown.
+   */
+  if (!strcmp(name, "day") || !strcmp(name, "night")) {
+    FX_playlist list =
+        strcmp(name, "day") ? FX_playlist(fx_list_night) : fx_list_day;
+    *job = {list, idx, idx, list.size(), true};
+  } else if (!strcmp(name, "matrix")) {
+    uint16_t fx = idx / N_STYLES;
+    matrix_list[0] =
+        FX_preset(*matrix_fx[fx % N_MATRIX_FX], (StyleEnum)(idx % N_STYLES));
+    *job = {FX_playlist(matrix_list), 0, fx, N_MATRIX_FX * N_STYLES, false};
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/*------------------------------------------------------------------------------
+  Rendering
+------------------------------------------------------------------------------*/
+
+static void write_frame(FILE *f, uint32_t t_ms, uint8_t fx) {
+  uint8_t header[6] = {(uint8_t)t_ms,         (uint8_t)(t_ms >> 8),
+                       (uint8_t)(t_ms >> 16), (uint8_t)(t_ms >> 24),
+                       fx,                    (uint8_t)segmntr1.get_style()};
+  fwrite(header, 1, sizeof(header), f);
+  for (uint16_t idx = 0; idx < FLC::N; idx++) {
+    fwrite(leds[idx].raw, 1, 3, f);
+  }
+}
+
+static uint32_t render(FastLED_EffectManager &mgr, uint32_t period_us,
+                       uint32_t max_ms, FILE *f, uint8_t fx) {
+  /* Render the current preset of `mgr` until it has finished or for `max_ms`,
+  advancing virtual time by `period_us` per frame. Frames get written to `f`,
+  unless NULL. Returns the number of frames.
+  */
+  uint32_t t0 = virtual_us;
+  uint32_t n_frames = 0;
+
+  for (;;) {
+    mgr.update();
+    anim_recorder.add(leds); // As `upd__ShowFastLED()`, when recording
+    if (f) {
+      write_frame(f, (virtual_us - t0) / 1000, fx);
+    }
+    n_frames++;
+    virtual_us += period_us;
+
+    if (fx_has_finished || (virtual_us - t0 >= max_ms * 1000)) {
+      return n_frames;
+    }
+  }
+}
+
+static void govern(FastLED_EffectManager &mgr, double factor,
+                   uint32_t max_ms) {
+  /* Run the current preset of `mgr` for `max_ms` on the clock throttled by
+  `factor`, printing the governor once per second
+  */
+  const uint32_t min_period_us = 1000000UL / FLC::MAX_REFRESH_RATE;
+  uint32_t t0 = virtual_us;
+  uint32_t t_print = virtual_us;
+  uint32_t n_frames = 0;
+
+  throttle = factor;
+  while (virtual_us - t0 < max_ms * 1000) {
+    t_throttle = std::chrono::steady_clock::now();
+    mgr.update();
+    uint32_t period_us = micros() - virtual_us + FLC::QOS_SHOW_US;
+    virtual_us += max(period_us, min_period_us);
+    n_frames++;
+
+    if (virtual_us - t_print >= 1000000) {
+      printf("  %6.1f %8.0f %6.0f %5u %9u\n", (virtual_us - t0) / 1e6, factor,
+             n_frames * 1e6 / (virtual_us - t_print), mgr.qos_level(),
+             mgr.fx_cost_us());
+      t_print = virtual_us;
+      n_frames = 0;
+    }
+  }
+  throttle = 0;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+static int usage() {
+  fprintf(stderr, "Usage: render jobs LIST\n"
+                  "       render job LIST IDX OUT.fxcap [FPS] [MAX_MS] "
+                  "[WARMUP_MS]\n"
+                  "       render anim LIST IDX OUT.fxan [MAX_MS] [WARMUP_MS]\n"
+                  "       render qos LIST IDX THROTTLE[,THROTTLE...] [MAX_MS]\n"
+                  "       render bench\n"
+                  "LIST: day, night or matrix\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  Job job{FX_playlist(fx_list_day), 0, 0, 0, false};
+
+  if ((argc == 2) && !strcmp(argv[1], "bench")) {
+    real_clock = true;
+    generate_HeartBeat();
+    benchmark_layers(&Serial, layers_demo.data(), layers_demo.size());
+    return 0;
+  }
+
+  if ((argc < 3) || !get_job(argv[2], 0, &job)) {
+    return usage();
+  }
+
+  if (!strcmp(argv[1], "jobs")) {
+    for (uint16_t idx = 0; idx < job.n_jobs; idx++) {
+      get_job(argv[2], idx, &job);
+      const FX_preset &preset = job.list[job.idx];
+      printf("%u\t%s\t%u\t%s\n", idx, preset.fx->getName(),
+             (unsigned)preset.style, style_names[(int)preset.style]);
+    }
+    return 0;
+  }
+
+  if (!strcmp(argv[1], "qos") && (argc >= 5)) {
+    static std::array<FX_preset, 1> list;
+    uint16_t idx = atoi(argv[3]);
+    uint32_t max_ms = (argc > 5) ? atol(argv[5]) : 10000;
+    if (idx >= job.n_jobs) {
+      return usage();
+    }
+    get_job(argv[2], idx, &job);
+    list[0] = job.list[job.idx];
+    list[0].duration = 0;
+
+    // As `setup()` of the firmware
+    generate_HeartBeat();
+    FLC::GEOMETRY.perimeter_xy(perimeter_xy);
+    fill_solid(leds, FLC::N, CRGB::Black);
+
+    FastLED_EffectManager mgr(list);
+    mgr.set_fx(0);
+    printf("%s, %u LEDs, budget %u us\n", list[0].fx->getName(), FLC::N,
+           1000000U / FLC::QOS_MIN_FPS - FLC::QOS_SHOW_US);
+    printf("  %6s %8s %6s %5s %9s\n", "t [s]", "throttle", "FPS", "level",
+           "cost [us]");
+    for (char *arg = strtok(argv[4], ","); arg; arg = strtok(NULL, ",")) {
+      govern(mgr, atof(arg), max_ms);
+    }
+    return 0;
+  }
+
+  const bool anim = !strcmp(argv[1], "anim");
+  if ((strcmp(argv[1], "job") && !anim) || (argc < 5)) {
+    return usage();
+  }
+  int argi = anim ? 5 : 6; // Index of MAX_MS, `anim` has no FPS argument
+  uint16_t idx = atoi(argv[3]);
+  uint16_t fps = (!anim && (argc > 5)) ? atoi(argv[5]) : 100;
+  uint32_t max_ms = (argc > argi) ? atol(argv[argi]) : 20000;
+  uint32_t warmup_ms = (argc > argi + 1) ? atol(argv[argi + 1]) : 2000;
+  if ((idx >= job.n_jobs) || (fps == 0)) {
+    return usage();
+  }
+  get_job(argv[2], idx, &job);
+
+  FILE *f = fopen(argv[4], "wb");
+  if (f == NULL) {
+    perror(argv[4]);
+    return 1;
+  }
+  if (!anim) {
+    uint8_t header[6] = {'F', 'X', 'C', 'P', (uint8_t)FLC::N,
+                         (uint8_t)(FLC::N >> 8)};
+    fwrite(header, 1, sizeof(header), f);
+  }
+
+  // As `setup()` of the firmware
+  generate_HeartBeat();
+  FLC::GEOMETRY.perimeter_xy(perimeter_xy);
+  fill_solid(leds, FLC::N, CRGB::Black);
+
+  const uint32_t period_us = 1000000UL / fps;
+  FastLED_EffectManager mgr(job.list);
+  if (job.warmup && (job.idx > 0) && warmup_ms) {
+    mgr.set_fx((uint16_t)(job.idx - 1));
+    render(mgr, period_us, warmup_ms, NULL, 0);
+  }
+  mgr.set_fx(job.idx);
+
+  if (!anim) {
+    uint32_t n_frames = render(mgr, period_us, max_ms, f, job.fx_id);
+    fclose(f);
+    fprintf(stderr, "%s: %u frames\n", argv[4], n_frames);
+    return 0;
+  }
+
+  // Record into a flash image of its own, as jobs may run in parallel
+  std::string image = std::string(argv[4]) + ".qspi";
+  AnimHeader header;
+  std::vector<uint8_t> bytes;
+
+  remove(image.c_str());
+  QSPIFlash::begin(image.c_str());
+  anim_recorder.start();
+  render(mgr, period_us, max_ms, NULL, 0);
+  anim_recorder.stop();
+
+  QSPIFlash::read(FLC::ANIM_ADDR, (uint8_t *)&header, sizeof(header));
+  bytes.resize(sizeof(header) + header.n_bytes);
+  QSPIFlash::read(FLC::ANIM_ADDR, bytes.data(), bytes.size());
+  fwrite(bytes.data(), 1, bytes.size(), f);
+  fclose(f);
+  remove(image.c_str());
+  fprintf(stderr, "%s: %u frames, %zu bytes\n", argv[4], header.n_frames,
+          bytes.size());
+  return 0;
+}
@@ -0,0 +1,207 @@
+/* Standby simulation
+
+Simulates the standby mode of `DvG_Standby.h` on the host PC: the CPU duty
+cycle of the main loop while waiting for an audience, and the time it takes
+to wake up once a visitor walks up to the mirror.
+
+Usage:
+  standby_sim [--loop CYCLES] [--ir CYCLES] [--adc US] [--runs N]
+
+Duty cycle
+----------
+In standby the core sleeps until the 1 ms SysTick interrupt, runs one pass of
+`loop()` and goes back to sleep. Every `FLC::STANDBY_IR_PERIOD` ms that pass
+samples the IR distance sensor as well. The costs are modelled as:
+  --loop  Core cycles of one pass of `loop()` including the SysTick
+          interrupt, default 2000
+  --ir    Core cycles of updating the IR distance filters, default 2000
+  --adc   Time [us] the core waits on `analogRead()`, default 15. The ADC
+          runs on its own clock, unaffected by `FLC::STANDBY_CPU_DIV`.
+The defaults are rough estimates. Serial command 's' prints the duty cycle as
+measured on the mirror, to calibrate `--loop` against. The duty cycle gets
+tabulated for all core clock dividers and a range of IR sample periods, the
+firmware setting marked by '*'.
+
+Wake-up lag
+-----------
+A visitor walks up from 150 to 50 cm in 2.5 s, at a random moment, like in
+`src_python/ir_trace.py`, and with the same sensor noise and spikes. The
+samples get fed through `DvG_IR_Distance.h` and standby ends at the first
+sample that estimates the distance below `FLC::AUDIENCE_DISTANCE`. The lag
+is measured from the moment the true distance crosses it, over `--runs` runs,
+default 200, for:
+  awake     Sampling every `FLC::IR_PERIOD` ms, as reference
+  standby   Sampling every `FLC::STANDBY_IR_PERIOD` ms
+  full avg  Same, but keeping the running average over `IR_AVG_N` samples,
+            like before the standby window got introduced
+
+Build and run with `pio run -e standby_sim -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_IR_Distance.h"
+
+Serial_ Serial;
+
+unsigned long millis() {
+  return 0;
+}
+unsigned long micros() {
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  Duty cycle
+------------------------------------------------------------------------------*/
+
+struct Costs {
+  float loop = 2000; // [cycles]
+  float ir = 2000;   // [cycles]
+  float adc = 15;    // [us]
+};
+
+static float duty_cycle(const Costs &c, uint8_t cpu_div, uint16_t ir_period) {
+  /* Fraction of time the core is awake, over one IR sample period, as
+  `Standby::duty_cycle()` measures it
+  */
+  const float f_mhz = F_CPU / 1e6 / cpu_div;
+  float awake_us = ir_period * c.loop / f_mhz + c.ir / f_mhz + c.adc;
+  return min(awake_us / (ir_period * 1000.f), 1.f);
+}
+
+/*------------------------------------------------------------------------------
+  Wake-up lag
+------------------------------------------------------------------------------*/
+
+// Sensor imperfections, must match `src_python/ir_trace.py`
+const float NOISE_LSB = 3;
+const float SPIKE_PROB = 0.01;
+const float SPIKE_LSB[] = {30, 80};
+
+static float to_bitval(float cm) {
+  /* Inverse of the calibration fit
+   */
+  return pow(IR_CALIB_A / (cm + IR_CALIB_B), 1 / IR_CALIB_C);
+}
+
+static float visitor(float t, float t_walk) {
+  /* True distance [cm] at time `t` [s], walking up from 150 to 50 cm from
+  `t_walk` on, eased in and out over 2.5 s
+  */
+  float w = constrain((t - t_walk) / 2.5f, 0.f, 1.f);
+  return 150 - 100 * (1 - cos(PI * w)) / 2;
+}
+
+enum WakeMode { AWAKE, STANDBY, FULL_AVG };
+
+static float wake_lag(WakeMode mode, std::mt19937 &rng) {
+  /* Lag [ms] from the true distance crossing `FLC::AUDIENCE_DISTANCE` up to
+  the first sample estimating it below, or NAN when never
+  */
+  std::normal_distribution<float> noise(0, NOISE_LSB);
+  std::uniform_real_distribution<float> uni(0, 1);
+  const uint16_t period = mode == AWAKE ? FLC::IR_PERIOD
+                                        : FLC::STANDBY_IR_PERIOD;
+  const float t_walk = 5 + uni(rng); // [s]
+
+  // Moment the true distance crosses the audience distance
+  float w = acos(1 - 2 * (150.f - FLC::AUDIENCE_DISTANCE) / 100) / PI;
+  const float t_cross = t_walk + 2.5f * w;
+
+  IR_Distance ir;
+  ir.set_standby(mode == STANDBY);
+  for (uint32_t t_ms = 0; t_ms < 10000; t_ms += period) {
+    float bitval = to_bitval(visitor(t_ms / 1000.f, t_walk)) + noise(rng);
+    if (uni(rng) < SPIKE_PROB) {
+      float a = SPIKE_LSB[0] + uni(rng) * (SPIKE_LSB[1] - SPIKE_LSB[0]);
+      bitval += uni(rng) < 0.5 ? -a : a;
+    }
+    uint16_t b = constrain(lround(bitval), 0L, 1023L);
+    ir.add(b, t_ms * 1000);
+    if ((t_ms / 1000.f > t_walk) &&
+        (ir.estimate(t_ms * 1000) < FLC::AUDIENCE_DISTANCE)) {
+      return t_ms - t_cross * 1000;
+    }
+  }
+  return NAN;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  Costs c;
+  int runs = 200;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--loop") && (i + 1 < argc)) {
+      c.loop = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--ir") && (i + 1 < argc)) {
+      c.ir = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--adc") && (i + 1 < argc)) {
+      c.adc = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--runs") && (i + 1 < argc)) {
+      runs = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: standby_sim [--loop CYCLES] [--ir CYCLES] "
+                      "[--adc US] [--runs N]\n");
+      return 2;
+    }
+  }
+
+  const uint16_t ir_periods[] = {25, 50, 100, 200, 500};
+  printf("CPU duty cycle [%%], loop %.0f cycles, IR %.0f cycles, ADC %.0f "
+         "us\n",
+         c.loop, c.ir, c.adc);
+  printf("  %-12s", "div \\ IR [ms]");
+  for (uint16_t p : ir_periods) {
+    printf(" %6u%c", p, p == FLC::STANDBY_IR_PERIOD ? '*' : ' ');
+  }
+  printf("\n");
+  for (uint8_t div = 1; div && (div <= 128); div <<= 1) {
+    printf("  %3u%c        ", div, div == FLC::STANDBY_CPU_DIV ? '*' : ' ');
+    for (uint16_t p : ir_periods) {
+      printf(" %6.2f ", duty_cycle(c, div, p) * 100);
+    }
+    printf("\n");
+  }
+
+  printf("\nWake-up lag [ms] over %d runs, audience distance %u cm\n", runs,
+         FLC::AUDIENCE_DISTANCE);
+  printf("  %-9s %6s %6s %8s %8s %8s\n", "mode", "period", "avg N", "mean",
+         "max", "missed");
+  const char *names[] = {"awake", "standby", "full avg"};
+  for (WakeMode mode : {AWAKE, STANDBY, FULL_AVG}) {
+    std::mt19937 rng(1);
+    std::vector<float> lags;
+    int missed = 0;
+    for (int r = 0; r < runs; r++) {
+      float lag = wake_lag(mode, rng);
+      if (isnan(lag)) {
+        missed++;
+      } else {
+        lags.push_back(lag);
+      }
+    }
+    float sum = 0, worst = 0;
+    for (float lag : lags) {
+      sum += lag;
+      worst = max(worst, lag);
+    }
+    printf("  %-9s %6u %6u %8.0f %8.0f %8d\n", names[mode],
+           mode == AWAKE ? FLC::IR_PERIOD : FLC::STANDBY_IR_PERIOD,
+           mode == STANDBY ? IR_AVG_N_STANDBY : IR_AVG_N,
+           lags.empty() ? NAN : sum / lags.size(), worst, missed);
+  }
+  return 0;
+}
@@ -0,0 +1,309 @@
+/* Stream check
+
+Builds the frame stream receiver `FrameStream` of `DvG_FastLED_Stream.h` on
+the host PC. Either checks it against packet sequences prone to go wrong, or
+receives from a pseudo-terminal to measure throughput and latency.
+
+Usage:
+  stream_check          Run the checks, fails when any does not hold
+  stream_check --stdin  Receive packets from stdin, run by
+                        `src_python/stream_frames.py --selftest`
+
+Checks:
+  order     Frames come out in order, one per `FLC::STREAM_PERIOD`, by
+            swapping buffers with `leds` instead of copying
+  dup       A duplicate or reordered sequence number counts as a duplicate
+            and gets dropped, not as 255 lost packets
+  crc       A packet with a CRC error leaves a full jitter buffer intact,
+            only a good one drops the oldest frame
+  partial   A PARTIAL packet builds on the newest frame, also once that one
+            has been released into `leds`
+
+With `--stdin`, stdin is the receiving end of the pseudo-terminal. The main
+loop of the firmware gets mimicked on the real clock: parsing all available
+bytes and playing out frames. Each frame committed to the jitter buffer
+prints a line `R <time> <received>` to stdout, the time [s] being that of
+`CLOCK_MONOTONIC`. At the END packet the counters get printed.
+
+Build and run with `pio run -e stream_check -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <algorithm>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_Stream.h"
+
+Serial_ Serial;
+
+static uint32_t virtual_ms = 0;
+static bool real_clock = false;
+
+static double monotonic() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+unsigned long millis() {
+  return real_clock ? (uint32_t)(monotonic() * 1000) : virtual_ms;
+}
+unsigned long micros() {
+  return real_clock ? (uint32_t)(monotonic() * 1e6) : virtual_ms * 1000;
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+CRGB leds_buf[FLC::N];
+CRGB *leds = leds_buf;
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+/*------------------------------------------------------------------------------
+  Packets
+------------------------------------------------------------------------------*/
+
+class FeedStream : public Stream {
+  /* Holds the bytes sent, all available at once
+   */
+public:
+  std::vector<uint8_t> bytes;
+  size_t pos = 0;
+
+  int available() override {
+    return bytes.size() - pos;
+  }
+  int read() override {
+    return pos < bytes.size() ? bytes[pos++] : -1;
+  }
+};
+
+static void send(FeedStream &feed, uint8_t type, uint8_t seq, uint8_t color,
+                 uint16_t first = 0, uint16_t n = FLC::N,
+                 bool corrupt = false) {
+  /* Append a packet, the LEDs all of the same `color`
+   */
+  std::vector<uint8_t> body = {type, seq, (uint8_t)first,
+                               (uint8_t)(first >> 8), (uint8_t)n,
+                               (uint8_t)(n >> 8)};
+  body.insert(body.end(), 3 * n, color);
+  uint16_t crc = 0xFFFF;
+  for (uint8_t b : body) {
+    crc = crc16_ccitt(crc, b);
+  }
+  crc ^= corrupt;
+  feed.bytes.insert(feed.bytes.end(), {STREAM_SYNC_0, STREAM_SYNC_1});
+  feed.bytes.insert(feed.bytes.end(), body.begin(), body.end());
+  feed.bytes.insert(feed.bytes.end(), {(uint8_t)crc, (uint8_t)(crc >> 8)});
+}
+
+static std::vector<int> play_all(FrameStream &stream) {
+  /* Play out until the jitter buffer runs dry. Returns the red value of LED
+  0 of each frame played out.
+  */
+  std::vector<int> frames;
+  for (uint8_t i = 0; i < 4 * FLC::STREAM_DEPTH; i++) {
+    virtual_ms += FLC::STREAM_PERIOD;
+    if (stream.playout(leds)) {
+      frames.push_back(leds[0].r);
+    }
+  }
+  return frames;
+}
+
+/*------------------------------------------------------------------------------
+  Checks
+------------------------------------------------------------------------------*/
+
+static bool check_order() {
+  static FrameStream stream;
+  FeedStream feed;
+  std::vector<CRGB *> seen;
+  bool ok = true;
+
+  stream.start();
+  for (uint8_t i = 0; i < FLC::STREAM_DEPTH; i++) {
+    send(feed, STREAM_TYPE_FRAME, i, 10 + i);
+  }
+  stream.poll(&feed);
+  for (uint8_t i = 0; i < FLC::STREAM_DEPTH; i++) {
+    CRGB *before = leds;
+    ok &= stream.playout(leds) && (leds != before) && (leds[0].r == 10 + i) &&
+          (leds[FLC::N - 1].r == 10 + i);
+    seen.push_back(leds);
+    virtual_ms += FLC::STREAM_PERIOD / 2;
+    ok &= !stream.playout(leds); // Not due yet
+    virtual_ms += FLC::STREAM_PERIOD - FLC::STREAM_PERIOD / 2;
+  }
+  std::sort(seen.begin(), seen.end());
+  ok &= (std::unique(seen.begin(), seen.end()) == seen.end()) &&
+        (stream.counters().received == FLC::STREAM_DEPTH) &&
+        (stream.counters().lost == 0);
+  return check(ok, "order: in order, swapped into `leds`, no copies");
+}
+
+static bool check_dup() {
+  static FrameStream stream;
+  FeedStream feed;
+
+  stream.start();
+  send(feed, STREAM_TYPE_FRAME, 254, 1);
+  send(feed, STREAM_TYPE_FRAME, 255, 2);
+  send(feed, STREAM_TYPE_FRAME, 255, 2); // Duplicate
+  send(feed, STREAM_TYPE_FRAME, 1, 3);   // Wraps, 0 lost
+  send(feed, STREAM_TYPE_FRAME, 0, 4);   // Reordered
+  stream.poll(&feed);
+  const StreamCounters &c = stream.counters();
+  std::vector<int> frames = play_all(stream);
+  bool ok = (c.received == 3) && (c.dup == 2) && (c.lost == 1) &&
+            (frames == std::vector<int>({1, 2, 3}));
+
+  char what[64];
+  snprintf(what, sizeof(what), "dup: received %u, dup %u, lost %u", c.received,
+           c.dup, c.lost);
+  return check(ok, what);
+}
+
+static bool check_crc() {
+  static FrameStream stream;
+  FeedStream feed;
+
+  stream.start();
+  for (uint8_t i = 0; i < FLC::STREAM_DEPTH; i++) {
+    send(feed, STREAM_TYPE_FRAME, i, 10 + i);
+  }
+  send(feed, STREAM_TYPE_FRAME, FLC::STREAM_DEPTH, 99, 0, FLC::N, true);
+  stream.poll(&feed);
+  const StreamCounters &c = stream.counters();
+  bool ok = (c.crc == 1) && (c.overflow == 0);
+  std::vector<int> frames = play_all(stream);
+  ok &= (frames.size() == FLC::STREAM_DEPTH) && (frames[0] == 10);
+  ok = check(ok, "crc: a bad packet leaves a full buffer intact");
+
+  stream.start();
+  feed = FeedStream();
+  for (uint8_t i = 0; i <= FLC::STREAM_DEPTH; i++) {
+    send(feed, STREAM_TYPE_FRAME, i, 10 + i);
+  }
+  stream.poll(&feed);
+  frames = play_all(stream);
+  return check((c.overflow == 1) && (frames.size() == FLC::STREAM_DEPTH) &&
+                   (frames[0] == 11),
+               "crc: a good packet drops the oldest frame") &&
+         ok;
+}
+
+static bool check_partial() {
+  static FrameStream stream;
+  FeedStream feed;
+  bool ok = true;
+
+  stream.start();
+  for (uint8_t i = 0; i < FLC::STREAM_DEPTH / 2 + 1; i++) {
+    send(feed, STREAM_TYPE_FRAME, i, 50);
+  }
+  stream.poll(&feed);
+  ok &= (play_all(stream).size() == FLC::STREAM_DEPTH / 2 + 1);
+
+  // The newest frame now lives in `leds`
+  feed = FeedStream();
+  for (uint8_t i = 0; i < FLC::STREAM_DEPTH / 2 + 1; i++) {
+    send(feed, STREAM_TYPE_PARTIAL, FLC::STREAM_DEPTH / 2 + 1 + i, 60 + i, i,
+         1);
+  }
+  stream.poll(&feed);
+  play_all(stream);
+  for (uint8_t i = 0; i < FLC::STREAM_DEPTH / 2 + 1; i++) {
+    ok &= (leds[i].r == 60 + i);
+  }
+  ok &= (leds[FLC::STREAM_DEPTH / 2 + 1].r == 50) &&
+        (leds[FLC::N - 1].r == 50);
+  return check(ok, "partial: builds on the newest frame, released or not");
+}
+
+/*------------------------------------------------------------------------------
+  Receiving from stdin
+------------------------------------------------------------------------------*/
+
+class FdStream : public Stream {
+  /* Non-blocking reads from a file descriptor, buffered
+   */
+public:
+  int fd;
+  uint8_t buf[4096];
+  int n = 0;
+  int pos = 0;
+
+  int available() override {
+    if (pos == n) {
+      int avail = 0;
+      ioctl(fd, FIONREAD, &avail);
+      n = avail > 0 ? ::read(fd, buf, min(avail, (int)sizeof(buf))) : 0;
+      n = max(n, 0);
+      pos = 0;
+    }
+    return n - pos;
+  }
+  int read() override {
+    return pos < n ? buf[pos++] : -1;
+  }
+};
+
+static int receive() {
+  static FrameStream stream;
+  FdStream in;
+  uint32_t received = 0;
+
+  real_clock = true;
+  in.fd = STDIN_FILENO;
+  stream.start();
+  while (stream.is_active()) {
+    stream.poll(&in);
+    if (stream.counters().received != received) {
+      double now = monotonic();
+      while (received != stream.counters().received) {
+        printf("R %.6f %u\n", now, ++received);
+      }
+      fflush(stdout);
+    }
+    stream.playout(leds);
+    usleep(100);
+  }
+  const StreamCounters &c = stream.counters();
+  printf("C %u %u %u %u %u %u\n", c.received, c.crc, c.lost, c.dup,
+         c.overflow, c.underrun);
+  return 0;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main(int argc, char **argv) {
+  bool ok = true;
+
+  if ((argc == 2) && !strcmp(argv[1], "--stdin")) {
+    return receive();
+  }
+  printf("FrameStream, %u LEDs, jitter buffer of %u frames\n", FLC::N,
+         FLC::STREAM_DEPTH);
+  ok &= check_order();
+  ok &= check_dup();
+  ok &= check_crc();
+  ok &= check_partial();
+  return ok ? 0 : 1;
+}
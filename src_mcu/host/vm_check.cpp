@@ -0,0 +1,318 @@
+/* VM check
+
+Checks the effect interpreter of `DvG_FastLED_VM.h` on the host PC: the
+validation of uploaded programs, the interpreter on the corner cases they
+may hold and the non-blocking serial upload. Fails when any check does not
+hold.
+
+Usage:
+  vm_check
+
+Checks:
+  validate  Skips onto `LOOP` or `ENDL` get rejected, like unbalanced loops
+            and too many `EVERY` timers
+  every     An `EVERY` inside a `LOOP` keeps to its own timer, whatever the
+            length of the loop, and fires at a single `idx` per period
+  wrap      `ADD`, `SUB`, `MUL` and `DIV` wrap around at 32 bits, including
+            `INT32_MIN / -1`
+  upload    `VM_Upload` accepts a program arriving in bits and pieces, and
+            rejects a bad checksum, an invalid character and a silent line,
+            consuming the rest of the line in all cases
+
+Build and run with `pio run -e vm_check -t exec`, see `platformio.ini`.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include <Arduino.h>
+#include <string>
+
+#include "FastLED.h"
+
+#include "DvG_FastLED_VM.h"
+
+Serial_ Serial;
+
+static uint32_t now_ms = 0;
+
+unsigned long millis() {
+  return now_ms;
+}
+unsigned long micros() {
+  return now_ms * 1000;
+}
+
+CRGBPalette16 custom_palette_1 = RainbowColors_p;
+
+void profile_gauss8strip(uint8_t gauss8[FLC::N], uint16_t, float) {
+  memset(gauss8, 0, FLC::N);
+}
+
+// Referenced by FastLED's `blur2d()`, which goes unused
+uint16_t XY(uint8_t x, uint8_t y) {
+  return y * FLC::GEOMETRY.width + x;
+}
+
+CRGB fx[FLC::N];
+FastLED_VM vm;
+
+static bool check(bool ok, const char *what) {
+  printf("  %-60s : %s\n", what, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+template <size_t N> static bool valid(const VM_Instr (&code)[N]) {
+  return vm_validate(code, N);
+}
+
+/*------------------------------------------------------------------------------
+  validate
+------------------------------------------------------------------------------*/
+
+static bool check_validate() {
+  // clang-format off
+  const VM_Instr every_endl[] = {
+    {VM_LOOP, 0, 0, 0}, {VM_EVERY, 0, 100, 0}, {VM_ENDL, 0, 0, 0},
+    {VM_END, 0, 0, 0}};
+  const VM_Instr skipz_loop[] = {
+    {VM_SKIPZ, 0, 0, 0}, {VM_LOOP, 0, 0, 0}, {VM_ENDL, 0, 0, 0},
+    {VM_END, 0, 0, 0}};
+  const VM_Instr every_loop[] = {
+    {VM_EVERY, 0, 100, 0}, {VM_LOOP, 0, 0, 0}, {VM_ENDL, 0, 0, 0},
+    {VM_END, 0, 0, 0}};
+  const VM_Instr skipz_endl[] = {
+    {VM_LOOP, 0, 0, 0}, {VM_SKIPZ, 0, 0, 0}, {VM_ENDL, 0, 0, 0},
+    {VM_END, 0, 0, 0}};
+  const VM_Instr unbalanced[] = {
+    {VM_LOOP, 0, 0, 0}, {VM_END, 0, 0, 0}};
+  const VM_Instr skips_inside[] = {
+    {VM_LOOP, 0, 0, 0}, {VM_EVERY, 0, 100, 0}, {VM_HSV, 0, 0, 0},
+    {VM_SKIPZ, 0, 0, 0}, {VM_HSV, 0, 0, 0}, {VM_ENDL, 0, 0, 0},
+    {VM_END, 0, 0, 0}};
+  // clang-format on
+  VM_Instr many_every[VM_MAX_EVERY + 2];
+  for (VM_Instr &in : many_every) {
+    in = {VM_EVERY, 0, 100, 0};
+  }
+  many_every[VM_MAX_EVERY + 1] = {VM_END, 0, 0, 0};
+  bool ok = true;
+
+  ok &= check(!valid(every_endl), "validate: rejects EVERY before ENDL");
+  ok &= check(!valid(skipz_loop), "validate: rejects SKIPZ before LOOP");
+  ok &= check(!valid(every_loop), "validate: rejects EVERY before LOOP");
+  ok &= check(!valid(skipz_endl), "validate: rejects SKIPZ before ENDL");
+  ok &= check(!valid(unbalanced), "validate: rejects an unbalanced LOOP");
+  ok &= check(!valid(many_every), "validate: rejects too many EVERY");
+  ok &= check(valid(skips_inside), "validate: accepts skips inside a LOOP");
+  ok &= check(valid(vm_demo_program), "validate: accepts vm_demo_program");
+  return ok;
+}
+
+/*------------------------------------------------------------------------------
+  every
+------------------------------------------------------------------------------*/
+
+static uint32_t n_lit(uint16_t s) {
+  uint32_t n = 0;
+  for (uint16_t i = 0; i < s; i++) {
+    n += (bool)fx[i];
+  }
+  return n;
+}
+
+static bool check_every() {
+  /* A loop over all LEDs with two `EVERY`s inside, of 100 and 250 ms, each
+  lighting up the LED at which it fires. Before, every iteration took the
+  next timer, writing past the `VM_MAX_EVERY` timers.
+  */
+  // clang-format off
+  const VM_Instr code[] = {
+    {VM_LDI  , 0, 255, 0},    // r0 = 255
+    {VM_LOOP , 0, 0  , 0},
+    {VM_EVERY, 0, 100, 0},    //   every 100 ms
+    {VM_HSV  , 0, 0  , 0},    //     fx1[idx] = CHSV(255, 255, 255)
+    {VM_EVERY, 0, 250, 0},    //   every 250 ms
+    {VM_HSV  , 0, 0  , 0},    //     fx1[idx] = CHSV(255, 255, 255)
+    {VM_ENDL , 0, 0  , 0},
+    {VM_END  , 0, 0  , 0},
+  };
+  // clang-format on
+  bool ok = vm_store(0, code, sizeof(code) / sizeof(VM_Instr)) && vm.load(0);
+  uint32_t n_fired = 0;
+
+  vm.reset(0);
+  for (now_ms = 1; now_ms <= 1000; now_ms++) {
+    bool due = (now_ms % 100 == 0) || (now_ms % 250 == 0);
+    memset(fx, 0, sizeof(fx));
+    vm.run(fx, FLC::N, now_ms);
+    ok &= (n_lit(FLC::N) == due) && (!due || fx[0]);
+    n_fired += n_lit(FLC::N);
+  }
+  ok &= (n_fired == 12);
+
+  char what[64];
+  snprintf(what, sizeof(what), "every: %u LEDs, lit up %u times in 1 s", FLC::N,
+           n_fired);
+  return check(ok, what);
+}
+
+/*------------------------------------------------------------------------------
+  wrap
+------------------------------------------------------------------------------*/
+
+static bool check_wrap() {
+  /* Compute `INT32_MIN` by multiplication, divide it by -1, overflow it some
+  more and show the result as hue: 2 when all of it wrapped around
+  */
+  // clang-format off
+  const VM_Instr code[] = {
+    {VM_LDI , 0, 0x00, 0x80},  // r0 = -32768
+    {VM_LDI , 1, 0x00, 0x01},  // r1 = 256
+    {VM_MUL , 0, 0   , 1},     // r0 = -2^23
+    {VM_MUL , 0, 0   , 1},     // r0 = -2^31
+    {VM_LDI , 2, 0xFF, 0xFF},  // r2 = -1
+    {VM_DIV , 0, 0   , 2},     // r0 = -2^31
+    {VM_SUB , 0, 0   , 2},     // r0 = -2^31 + 1
+    {VM_ADD , 0, 0   , 0},     // r0 = 2
+    {VM_MUL , 3, 1   , 1},     // r3 = 2^16
+    {VM_MUL , 3, 3   , 3},     // r3 = 0
+    {VM_ADD , 0, 0   , 3},     // r0 = 2
+    {VM_LDI , 4, 0   , 0},     // r4 = 0
+    {VM_HSV , 0, 4   , 1},     // fx1[0] = CHSV(2, 0, 0)
+    {VM_LDI , 1, 255 , 0},     // r1 = 255
+    {VM_HSV , 0, 1   , 1},     // fx1[0] = CHSV(2, 255, 255)
+    {VM_END , 0, 0   , 0},
+  };
+  // clang-format on
+  bool ok = vm_store(0, code, sizeof(code) / sizeof(VM_Instr)) && vm.load(0);
+
+  vm.reset(0);
+  memset(fx, 0, sizeof(fx));
+  vm.run(fx, 1, 0);
+  ok &= (fx[0] == CRGB(CHSV(2, 255, 255)));
+
+  return check(ok, "wrap: INT32_MIN / -1 and overflowing ADD, SUB, MUL");
+}
+
+/*------------------------------------------------------------------------------
+  upload
+------------------------------------------------------------------------------*/
+
+class FeedStream : public Stream {
+  /* Hands out its text a few bytes per `loop()` iteration, like a serial
+  port at a low baud rate
+  */
+public:
+  std::string text;
+  size_t pos = 0;
+  size_t chunk = 3;
+  size_t avail = 0;
+
+  void next_loop() {
+    avail = min(chunk, text.size() - pos);
+  }
+  int available() override {
+    return avail;
+  }
+  int read() override {
+    if (!avail) {
+      return -1;
+    }
+    avail--;
+    return (uint8_t)text[pos++];
+  }
+};
+
+static std::string to_hex(const VM_Instr *code, uint16_t n_instr,
+                          int8_t checksum_error) {
+  std::string hex;
+  uint8_t sum = 0;
+  char buf[4];
+  for (uint16_t i = 0; i < n_instr * sizeof(VM_Instr); i++) {
+    uint8_t b = ((const uint8_t *)code)[i];
+    sum += b;
+    snprintf(buf, sizeof(buf), "%02x", b);
+    hex += buf;
+    if (i % 4 == 3) {
+      hex += " ";
+    }
+  }
+  snprintf(buf, sizeof(buf), "%02x", (uint8_t)(0 - sum + checksum_error));
+  return hex + buf;
+}
+
+static VM_UploadStatus upload(FeedStream &feed, uint32_t *n_loops) {
+  /* Serial command 'u' followed by `loop()` iterations of 1 ms each, until
+  the upload has finished
+  */
+  VM_UploadStatus status = VM_UPLOAD_BUSY;
+  vm_upload.start();
+  for (*n_loops = 0; vm_upload.is_active(); (*n_loops)++) {
+    now_ms++;
+    feed.next_loop();
+    status = vm_upload.poll(&feed);
+    if (*n_loops > 10000) {
+      break;
+    }
+  }
+  return status;
+}
+
+static bool check_upload() {
+  const uint16_t n = sizeof(vm_demo_program) / sizeof(VM_Instr);
+  const std::string good = to_hex(vm_demo_program, n, 0);
+  char what[64];
+  uint32_t n_loops;
+  bool ok = true;
+  FeedStream feed;
+
+  feed.text = "0 " + good + "\n?";
+  ok = (upload(feed, &n_loops) == VM_UPLOAD_OK) && (n_loops > 1) &&
+       (feed.text[feed.pos] == '?');
+  snprintf(what, sizeof(what), "upload: %zu bytes over %u loop iterations",
+           good.size(), n_loops);
+  ok &= check(ok, what);
+
+  feed = FeedStream();
+  feed.text = "0 " + to_hex(vm_demo_program, n, 1) + "\n?";
+  ok &= check((upload(feed, &n_loops) == VM_UPLOAD_REJECTED) &&
+                  (feed.text[feed.pos] == '?'),
+              "upload: rejects a bad checksum");
+
+  feed = FeedStream();
+  feed.text = "0 0100zz00 " + good + "\n?";
+  ok &= check((upload(feed, &n_loops) == VM_UPLOAD_REJECTED) &&
+                  (feed.text[feed.pos] == '?'),
+              "upload: rejects an invalid character, consuming the line");
+
+  feed = FeedStream();
+  feed.text = "4 " + good + "\n?";
+  ok &= check((upload(feed, &n_loops) == VM_UPLOAD_REJECTED) &&
+                  (feed.text[feed.pos] == '?'),
+              "upload: rejects a slot out of range");
+
+  feed = FeedStream();
+  feed.text = "0 0100";
+  uint32_t t0 = now_ms;
+  ok &= upload(feed, &n_loops) == VM_UPLOAD_REJECTED;
+  snprintf(what, sizeof(what), "upload: gives up on silence after %u ms",
+           now_ms - t0);
+  ok &= check(now_ms - t0 <= VM_UPLOAD_TIMEOUT + 10, what);
+  return ok;
+}
+
+/*------------------------------------------------------------------------------
+  main
+------------------------------------------------------------------------------*/
+
+int main() {
+  bool ok = true;
+
+  printf("VM, %u LEDs\n", FLC::N);
+  ok &= check_validate();
+  ok &= check_every();
+  ok &= check_wrap();
+  ok &= check_upload();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+/* wiring_private.h
+
+Stand-in for the pin multiplexing of the SAMD51 Arduino core on the host PC,
+see `SPI.h`. `pinPeripheral()` records the peripheral each pin got muxed to.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef WIRING_PRIVATE_H
+#define WIRING_PRIVATE_H
+
+#include <Arduino.h>
+
+enum EPioType { PIO_NOT_A_PIN = -1, PIO_DIGITAL, PIO_SERCOM, PIO_SERCOM_ALT };
+
+inline EPioType *host_pin_pio() {
+  // Peripheral of each pin, as last set by `pinPeripheral()`
+  static EPioType pio[64] = {PIO_DIGITAL};
+  return pio;
+}
+
+inline int pinPeripheral(uint32_t pin, EPioType pio) {
+  host_pin_pio()[pin & 63] = pio;
+  return 0;
+}
+
+#endif
@@ -6,6 +6,13 @@ Edited:
 Dennis van Gils
 18-11-2021
 
+Edited:
+  - `State` constructors moved to the header as `constexpr`, the name is no
+    longer copied into RAM
+
+Dennis van Gils
+18-10-2026
+
 ||
 || @file FiniteStateMachine.cpp
 || @version 1.7
@@ -37,48 +44,6 @@ Dennis van Gils
 #include "FiniteStateMachine.h"
 
 // FINITE STATE
-State::State(void (*updateFunction)()) {
-  userEnter = 0;
-  userUpdate = updateFunction;
-  userExit = 0;
-}
-
-State::State(void (*enterFunction)(), void (*updateFunction)()) {
-  userEnter = enterFunction;
-  userUpdate = updateFunction;
-  userExit = 0;
-}
-
-State::State(void (*enterFunction)(), void (*updateFunction)(),
-             void (*exitFunction)()) {
-  userEnter = enterFunction;
-  userUpdate = updateFunction;
-  userExit = exitFunction;
-}
-
-State::State(const char *name, void (*updateFunction)()) {
-  snprintf(_name, STATE_NAME_LEN, name);
-  userEnter = 0;
-  userUpdate = updateFunction;
-  userExit = 0;
-}
-
-State::State(const char *name, void (*enterFunction)(),
-             void (*updateFunction)()) {
-  snprintf(_name, STATE_NAME_LEN, name);
-  userEnter = enterFunction;
-  userUpdate = updateFunction;
-  userExit = 0;
-}
-
-State::State(const char *name, void (*enterFunction)(),
-             void (*updateFunction)(), void (*exitFunction)()) {
-  snprintf(_name, STATE_NAME_LEN, name);
-  userEnter = enterFunction;
-  userUpdate = updateFunction;
-  userExit = exitFunction;
-}
-
 // what to do when entering this state
 void State::enter() {
   if (userEnter) {
@@ -6,6 +6,17 @@ Edited:
 Dennis van Gils
 31-03-2023
 
+Edited:
+  - `State` holds a pointer to its name string, residing in flash, instead of
+    a copy of it in a 64-byte RAM array
+  - `State` constructors are `constexpr`, so that States are constant
+    initialized without any start-up code
+  - Added table-driven `StateTableFSM` working on a `constexpr` array of
+    `StateDef` in flash, with optional per-state timing counters
+
+Dennis van Gils
+18-10-2026
+
 ||
 || @file FiniteStateMachine.h
 || @version 1.7
@@ -62,22 +73,31 @@ terry@yourduino.com
 #  endif
 
 #  define FSM FiniteStateMachine
-#  define STATE_NAME_LEN 64
 
 // define the functionality of the states
 class State {
 public:
-  State(void (*updateFunction)());
-  State(void (*enterFunction)(), void (*updateFunction)());
-  State(void (*enterFunction)(), void (*updateFunction)(),
-        void (*exitFunction)());
+  constexpr State(void (*updateFunction)())
+      : userUpdate(updateFunction) {}
+  constexpr State(void (*enterFunction)(), void (*updateFunction)())
+      : userEnter(enterFunction), userUpdate(updateFunction) {}
+  constexpr State(void (*enterFunction)(), void (*updateFunction)(),
+                  void (*exitFunction)())
+      : userEnter(enterFunction), userUpdate(updateFunction),
+        userExit(exitFunction) {}
 
-  State(const char *name, void (*updateFunction)());
-  State(const char *name, void (*enterFunction)(), void (*updateFunction)());
-  State(const char *name, void (*enterFunction)(), void (*updateFunction)(),
-        void (*exitFunction)());
+  constexpr State(const char *name, void (*updateFunction)())
+      : _name(name), userUpdate(updateFunction) {}
+  constexpr State(const char *name, void (*enterFunction)(),
+                  void (*updateFunction)())
+      : _name(name), userEnter(enterFunction), userUpdate(updateFunction) {}
+  constexpr State(const char *name, void (*enterFunction)(),
+                  void (*updateFunction)(), void (*exitFunction)())
+      : _name(name), userEnter(enterFunction), userUpdate(updateFunction),
+        userExit(exitFunction) {}
 
-  char _name[STATE_NAME_LEN] = {"\0"};
+  // Points to a string literal, hence the name resides in flash
+  const char *_name = "";
 
   void enter();
   void update();
@@ -112,6 +132,118 @@ private:
   unsigned long stateChangeTime;
 };
 
+/*------------------------------------------------------------------------------
+  Table-driven finite state machine
+
+  The states are described by a `constexpr` array of `StateDef`, which the
+  compiler places in flash. The state machine itself only keeps the index of
+  the current and next state in RAM. Optionally, an array of `StateTiming`
+  can be passed to collect per-state timing counters.
+
+  Example:
+    constexpr StateDef states[] = {
+      // name     enter       update       exit
+      {"Idle"   , nullptr   , upd__Idle  , nullptr},
+      {"Blink"  , entr__Blink, upd__Blink, nullptr},
+    };
+    StateTableFSM fsm(states, 2);
+    ...
+    fsm.transitionTo(1);
+    fsm.update();
+------------------------------------------------------------------------------*/
+
+struct StateDef {
+  const char *name;
+  void (*enter)();
+  void (*update)();
+  void (*exit)();
+};
+
+struct StateTiming {
+  uint32_t n_updates; // Number of times `update` has been called
+  uint32_t us_total;  // [us] Total time spent inside `update`
+  uint32_t us_max;    // [us] Longest time spent inside a single `update`
+};
+
+class StateTableFSM {
+public:
+  StateTableFSM(const StateDef *table, uint8_t n_states, uint8_t initial = 0,
+                StateTiming *timing = nullptr)
+      : _table(table), _timing(timing), _n_states(n_states),
+        _current(initial), _next(initial) {}
+
+  StateTableFSM &update() {
+    // simulate a transition to the first state
+    // this only happens the first time update is called
+    if (_need_to_trigger_enter) {
+      call(_table[_current].enter);
+      _need_to_trigger_enter = false;
+    } else {
+      if (_current != _next) {
+        immediateTransitionTo(_next);
+      }
+      if (_timing) {
+        uint32_t t0 = micros();
+        call(_table[_current].update);
+        uint32_t dt = micros() - t0;
+        StateTiming &t = _timing[_current];
+        t.n_updates++;
+        t.us_total += dt;
+        t.us_max = dt > t.us_max ? dt : t.us_max;
+      } else {
+        call(_table[_current].update);
+      }
+    }
+    return *this;
+  }
+
+  StateTableFSM &transitionTo(uint8_t state_idx) {
+    _next = state_idx < _n_states ? state_idx : _n_states - 1;
+    _state_change_time = millis();
+    return *this;
+  }
+
+  StateTableFSM &immediateTransitionTo(uint8_t state_idx) {
+    call(_table[_current].exit);
+    _current = _next = state_idx < _n_states ? state_idx : _n_states - 1;
+    call(_table[_current].enter);
+    _state_change_time = millis();
+    return *this;
+  }
+
+  uint8_t getCurrentState() const { return _current; }
+  boolean isInState(uint8_t state_idx) const { return state_idx == _current; }
+  const char *getCurrentStateName() const { return _table[_current].name; }
+  unsigned long timeInCurrentState() const {
+    return millis() - _state_change_time;
+  }
+
+  const StateTiming *getTiming(uint8_t state_idx) const {
+    return _timing ? &_timing[state_idx] : nullptr;
+  }
+
+  void resetTiming() {
+    if (_timing) {
+      memset(_timing, 0, _n_states * sizeof(StateTiming));
+    }
+  }
+
+private:
+  static void call(void (*fun)()) {
+    if (fun) {
+      fun();
+    }
+  }
+
+  const StateDef *_table;
+  StateTiming *_timing;
+  uint8_t _n_states;
+  uint8_t _current;
+  uint8_t _next;
+  bool _need_to_trigger_enter = true;
+  unsigned long _state_change_time = 0;
+};
+
 #endif
 
 /*
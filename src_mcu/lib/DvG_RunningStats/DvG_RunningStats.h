@@ -0,0 +1,266 @@
+/* DvG_RunningStats.h
+
+Heap-free, fixed-size alternative to `RunningAverage` operating on integer
+(fixed-point) samples. All statistics are maintained incrementally, so each of
+them costs O(1) amortised per added sample instead of iterating over the full
+buffer on every call:
+
+  - average            : integer running sum
+  - min / max          : monotonic deques over the sliding window
+  - variance / std dev : integer running sum of squares
+
+Additionally, `MedianFilter` provides a median-of-K outlier rejector to be put
+in front of `RunningStats`, suppressing single-sample spikes as produced by,
+e.g., the Sharp IR distance sensor.
+
+Usage:
+  RunningStats<20, uint16_t> RS;  // Window of 20 samples, stored as uint16_t
+  RS.add(value);
+  RS.getAverage();
+
+Template parameters:
+  N: Window size, i.e. the number of samples to keep, [1 - 32767]
+  T: Integer sample type, e.g. `uint16_t` for fixed-point values
+  S: Integer type to accumulate the sum in, must hold `N * max(T)`. Defaults
+     to `int32_t` for a signed `T`, else to `uint32_t`.
+  Q: Unsigned integer type to accumulate the sum of squares in, must hold
+     `N^2 * max(T)^2`, which `uint64_t` does for up to 16-bit samples
+
+The variance gets derived from the integer sums as
+`(n * sum(x^2) - sum(x)^2) / n^2`, exact up to the final division. A sliding
+Welford update in floating point, as used before, accumulates round-off with
+every sample that enters and leaves the window and drifts away over time.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_RUNNINGSTATS_H
+#define DVG_RUNNINGSTATS_H
+
+#include <math.h>
+#include <stdint.h>
+#include <type_traits>
+
+/*------------------------------------------------------------------------------
+  RunningStats
+------------------------------------------------------------------------------*/
+
+template <uint16_t N, typename T = uint16_t,
+          typename S = typename std::conditional<std::is_signed<T>::value,
+                                                 int32_t, uint32_t>::type,
+          typename Q = uint64_t>
+class RunningStats {
+  static_assert(N > 0, "RunningStats: window size must be > 0");
+  static_assert(std::is_signed<S>::value || std::is_unsigned<T>::value,
+                "RunningStats: signed samples need a signed sum, see S");
+  static_assert(N < 32768, "RunningStats: window size must be < 32768");
+  static_assert(sizeof(T) <= 2 || sizeof(Q) > 8,
+                "RunningStats: sum of squares might overflow, see Q");
+
+private:
+  T _buf[N];       // Circular sample buffer
+  uint16_t _idx;   // Index into `_buf` to write the next sample to
+  uint16_t _count; // Number of valid samples in `_buf`
+  uint16_t _seq;   // Sequence number of the next sample, wraps around
+  S _sum;          // Running sum over the window
+  Q _sumsq;        // Running sum of squares over the window
+
+  // Monotonic deques over the sliding window, each a circular buffer holding
+  // the sequence number and value of candidate extremes
+  struct Deque {
+    T val[N];
+    uint16_t seq[N];
+    uint16_t head;
+    uint16_t size;
+  };
+  Deque _dq_min;
+  Deque _dq_max;
+
+  void deque_clear(Deque &dq) {
+    dq.head = 0;
+    dq.size = 0;
+  }
+
+  template <typename Compare>
+  void deque_push(Deque &dq, T value, Compare discard) {
+    /* Drop expired candidates at the front, then drop all candidates at the
+    back that can never become the extreme again because of the new value.
+    Each value gets pushed and popped at most once: amortised O(1).
+    */
+    while (dq.size && (uint16_t)(_seq - dq.seq[dq.head]) >= N) {
+      dq.head = (dq.head + 1) % N;
+      dq.size--;
+    }
+    while (dq.size && discard(dq.val[(dq.head + dq.size - 1) % N], value)) {
+      dq.size--;
+    }
+    uint16_t tail = (dq.head + dq.size) % N;
+    dq.val[tail] = value;
+    dq.seq[tail] = _seq;
+    dq.size++;
+  }
+
+public:
+  RunningStats() {
+    clear();
+  }
+
+  void clear() {
+    /* Reset all samples and statistics
+     */
+    for (uint16_t i = 0; i < N; i++) {
+      _buf[i] = 0;
+    }
+    _idx = 0;
+    _count = 0;
+    _seq = 0;
+    _sum = 0;
+    _sumsq = 0;
+    deque_clear(_dq_min);
+    deque_clear(_dq_max);
+  }
+
+  void add(T value) {
+    /* Add a new sample to the window, pushing out the oldest sample when the
+    window is full. O(1) amortised.
+    */
+    if (_count < N) {
+      _count++;
+    } else {
+      // Window full: replace the oldest sample by the new one
+      T oldest = _buf[_idx];
+      _sum -= oldest;
+      _sumsq -= (Q)oldest * oldest;
+    }
+    _sum += value;
+    _sumsq += (Q)value * value;
+
+    _buf[_idx] = value;
+    _idx = (_idx + 1) % N;
+
+    deque_push(_dq_min, value, [](T back, T v) { return back >= v; });
+    deque_push(_dq_max, value, [](T back, T v) { return back <= v; });
+    _seq++;
+  }
+
+  void fill(T value) {
+    /* Fill the complete window with the same value
+     */
+    clear();
+    for (uint16_t i = 0; i < N; i++) {
+      add(value);
+    }
+  }
+
+  /*----------------------------------------------------------------------------
+    Statistics, all O(1)
+  ----------------------------------------------------------------------------*/
+
+  float getAverage() const {
+    return _count ? (float)_sum / _count : 0;
+  }
+
+  S getSum() const {
+    return _sum;
+  }
+
+  T getMin() const {
+    // Minimum inside the current window
+    return _dq_min.size ? _dq_min.val[_dq_min.head] : 0;
+  }
+
+  T getMax() const {
+    // Maximum inside the current window
+    return _dq_max.size ? _dq_max.val[_dq_max.head] : 0;
+  }
+
+  float getVariance() const {
+    // Population variance inside the current window
+    return _count ? (float)getM2() / ((float)_count * _count) : 0;
+  }
+
+  float getStandardDeviation() const {
+    // Sample standard deviation inside the current window, same definition as
+    // `RunningAverage::getStandardDeviation()`
+    return _count > 1 ? sqrtf((float)getM2() / ((float)_count * (_count - 1)))
+                      : 0;
+  }
+
+  Q getM2() const {
+    // `_count` times the sum of squared deviations from the mean, exact. The
+    // unsigned arithmetic wraps consistently, also for negative samples.
+    return (Q)_count * _sumsq - (Q)_sum * (Q)_sum;
+  }
+
+  /*----------------------------------------------------------------------------
+    Buffer info
+  ----------------------------------------------------------------------------*/
+
+  T getElement(uint16_t idx) const {
+    return _buf[idx % N];
+  }
+
+  bool bufferIsFull() const {
+    return _count == N;
+  }
+
+  uint16_t getCount() const {
+    return _count;
+  }
+
+  constexpr uint16_t getSize() const {
+    return N;
+  }
+};
+
+/*------------------------------------------------------------------------------
+  MedianFilter
+
+  Median-of-K outlier rejector: outputs the median of the last `K` samples.
+  `K` is expected to be small and odd, e.g. 3 or 5, making the insertion sort
+  effectively O(1) per sample. Introduces a lag of `K / 2` samples.
+------------------------------------------------------------------------------*/
+
+template <uint8_t K, typename T = uint16_t> class MedianFilter {
+  static_assert(K % 2 == 1, "MedianFilter: K must be odd");
+
+private:
+  T _buf[K];      // Circular buffer of the last `K` samples
+  uint8_t _idx;   // Index into `_buf` to write the next sample to
+  uint8_t _count; // Number of valid samples in `_buf`
+
+public:
+  MedianFilter() {
+    clear();
+  }
+
+  void clear() {
+    _idx = 0;
+    _count = 0;
+  }
+
+  T add(T value) {
+    /* Add a new sample and return the median of the last `K` samples. When
+    less than `K` samples are available, the median of those is returned.
+    */
+    _buf[_idx] = value;
+    _idx = (_idx + 1) % K;
+    if (_count < K) {
+      _count++;
+    }
+
+    T sorted[K];
+    for (uint8_t i = 0; i < _count; i++) {
+      T v = _buf[i];
+      uint8_t j = i;
+      while (j > 0 && sorted[j - 1] > v) {
+        sorted[j] = sorted[j - 1];
+        j--;
+      }
+      sorted[j] = v;
+    }
+    return sorted[_count / 2];
+  }
+};
+
+#endif
@@ -0,0 +1,73 @@
+/* rs_performance.ino
+
+Timing of `RunningStats` against `RunningAverage`, mimicking the use inside
+`update_IR_dist()` of the infinity mirror: add a sample and retrieve the
+average twice.
+
+Dennis van Gils
+18-10-2026
+*/
+
+#include "DvG_RunningStats.h"
+#include "RunningAverage.h"
+
+#define N_WINDOW 20
+#define N_REPEAT 1000
+
+RunningAverage RA(N_WINDOW);
+RunningStats<N_WINDOW, uint16_t> RS;
+
+uint32_t tick;
+volatile float x;
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.println("\nPerformance RunningStats vs RunningAverage");
+  Serial.print("Window: ");
+  Serial.print(N_WINDOW);
+  Serial.print(", repeats: ");
+  Serial.println(N_REPEAT);
+  Serial.println("All timings in [us] per call\n");
+
+  tick = micros();
+  for (uint16_t i = 0; i < N_REPEAT; i++) {
+    RA.addValue(random(16, 150));
+    x = RA.getAverage();
+    x = RA.getAverage();
+  }
+  Serial.print("RunningAverage: add + 2x getAverage : ");
+  Serial.println((float)(micros() - tick) / N_REPEAT);
+
+  tick = micros();
+  for (uint16_t i = 0; i < N_REPEAT; i++) {
+    RS.add(random(16, 150) * 64);
+    x = RS.getAverage();
+    x = RS.getAverage();
+  }
+  Serial.print("RunningStats  : add + 2x getAverage : ");
+  Serial.println((float)(micros() - tick) / N_REPEAT);
+
+  tick = micros();
+  for (uint16_t i = 0; i < N_REPEAT; i++) {
+    x = RA.getMinInBuffer();
+    x = RA.getMaxInBuffer();
+    x = RA.getStandardDeviation();
+  }
+  Serial.print("RunningAverage: min, max, std dev   : ");
+  Serial.println((float)(micros() - tick) / N_REPEAT);
+
+  tick = micros();
+  for (uint16_t i = 0; i < N_REPEAT; i++) {
+    x = RS.getMin();
+    x = RS.getMax();
+    x = RS.getStandardDeviation();
+  }
+  Serial.print("RunningStats  : min, max, std dev   : ");
+  Serial.println((float)(micros() - tick) / N_REPEAT);
+
+  Serial.println("\ndone...");
+}
+
+void loop() {}
@@ -0,0 +1,269 @@
+/* DvG_APA102_MultiSPI.h
+
+Parallel output of APA102 LED data over several SERCOM SPI ports of the SAMD51.
+
+A single FastLED APA102 controller shifts out the full strip serially, so the
+transmission time of a frame grows linearly with the number of LEDs: 4 bytes
+per LED, i.e. 32 us per LED at `DATA_RATE_MHZ(1)`. Instead, the strip can be
+split over `FLC::N_CHANNELS` physical channels, each driven by its own SERCOM
+in SPI mode. Every channel gets a slice of the single `leds` buffer: one or two
+mirror sides for a single panel, or else a group of panels.
+
+`APA102_DMAController` is a FastLED controller that encodes its slice into an
+APA102 byte stream and hands that over to the DMA of its SPI port, returning
+immediately. Hence, a single `FastLED.show()` starts all channels within
+microseconds of each other and they transmit concurrently. The next `show()`
+waits for the previous transfer of a channel to complete before re-encoding.
+
+Pin assignment for the Adafruit ItsyBitsy M4, leaving the IR distance sensor
+(A2) and the button (D9) free:
+
+  channel  SERCOM  data  clock  pads         peripheral
+  0        1       MOSI  SCK    PA00 / PA01  PIO_SERCOM_ALT
+  1        0       A4    A1     PA04 / PA05  PIO_SERCOM_ALT
+  2        3       D1    D0     PA17 / PA16  PIO_SERCOM_ALT
+  3        2       SDA   SCL    PA12 / PA13  PIO_SERCOM
+
+The SPI ports of channels 1 - 3 only get constructed when used, leaving their
+SERCOMs, e.g. SERCOM2 of I2C on SDA / SCL, free otherwise.
+
+On the host PC, `host/SPI.h` and `host/wiring_private.h` stand in for the
+SERCOM SPI ports, see `host/multispi_check.cpp`.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_APA102_MULTISPI_H
+#define DVG_APA102_MULTISPI_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+// Number of bytes of an APA102 frame of `n` LEDs: start frame, LED frames and
+// end frame, identical to FastLED's own `APA102Controller`
+#define APA102_FRAME_SIZE(n) (4 + 4 * (n) + 4 * ((n) / 32 + 1))
+
+/*------------------------------------------------------------------------------
+  Channel slices
+------------------------------------------------------------------------------*/
+
+constexpr uint32_t channel_start(const Geometry &geom, uint8_t ch_idx,
+                                 uint8_t n_channels) {
+  /* Index of the first LED of channel `ch_idx` out of `n_channels`. A single
+  panel gets split at the mirror sides, multiple panels at panel boundaries.
+  */
+  return (ch_idx >= n_channels) ? geom.numel()
+         : (geom.n_panels == 1) && (4 % n_channels == 0)
+             ? geom.side_start(ch_idx * 4 / n_channels)
+         : (geom.n_panels % n_channels == 0)
+             ? (uint32_t)geom.perimeter() * (geom.n_panels / n_channels) *
+                   ch_idx
+             : geom.numel() * ch_idx / n_channels;
+}
+
+constexpr uint32_t channel_numel(const Geometry &geom, uint8_t ch_idx,
+                                 uint8_t n_channels) {
+  return channel_start(geom, ch_idx + 1, n_channels) -
+         channel_start(geom, ch_idx, n_channels);
+}
+
+constexpr uint32_t max_channel_numel(const Geometry &geom,
+                                     uint8_t n_channels) {
+  uint32_t max_numel = 0;
+  for (uint8_t ch_idx = 0; ch_idx < n_channels; ch_idx++) {
+    uint32_t numel = channel_numel(geom, ch_idx, n_channels);
+    max_numel = numel > max_numel ? numel : max_numel;
+  }
+  return max_numel;
+}
+
+#if defined(ADAFRUIT_ITSYBITSY_M4_EXPRESS) || defined(DVG_HOST)
+#include "SPI.h"
+#include "wiring_private.h" // pinPeripheral()
+
+/*------------------------------------------------------------------------------
+  APA102_DMAController
+------------------------------------------------------------------------------*/
+
+template <EOrder RGB_ORDER, uint16_t MAX_LEDS>
+class APA102_DMAController : public CPixelLEDController<RGB_ORDER> {
+private:
+  SPIClass *_spi = nullptr;
+  uint8_t _pin_data;
+  uint8_t _pin_clk;
+  EPioType _pio;
+  uint32_t _clock;
+  uint8_t _buf[APA102_FRAME_SIZE(MAX_LEDS)]; // Byte stream, read by the DMA
+  uint16_t _len = 0;                         // Bytes in `_buf` to send out
+
+public:
+  void set_port(SPIClass *spi, uint8_t pin_data, uint8_t pin_clk, EPioType pio,
+                uint32_t clock) {
+    /* To be called before `FastLED.addLeds()`
+     */
+    _spi = spi;
+    _pin_data = pin_data;
+    _pin_clk = pin_clk;
+    _pio = pio;
+    _clock = clock;
+  }
+
+  virtual void init() {
+    _spi->begin();
+    // `begin()` muxes the pins as per the board variant, override
+    pinPeripheral(_pin_data, _pio);
+    pinPeripheral(_pin_clk, _pio);
+    _spi->beginTransaction(SPISettings(_clock, MSBFIRST, SPI_MODE0));
+  }
+
+  uint16_t frame_size() {
+    // Number of bytes of the last frame
+    return _len;
+  }
+
+  uint32_t frame_time_us() {
+    // Modelled wall-clock transmission time of the last frame
+    return (uint32_t)((uint64_t)_len * 8 * 1000000 / _clock);
+  }
+
+protected:
+  virtual void showPixels(PixelController<RGB_ORDER> &pixels) {
+    // The DMA might still be reading `_buf`
+    _spi->waitForTransfer();
+
+    uint8_t s0 = pixels.getScale0();
+    uint8_t s1 = pixels.getScale1();
+    uint8_t s2 = pixels.getScale2();
+    uint8_t *p = _buf;
+    uint16_t n = 0;
+
+    // Start frame
+    for (uint8_t i = 0; i < 4; i++) {
+      *p++ = 0x00;
+    }
+
+    // LED frames, global brightness at its maximum like `APA102Controller`
+    while (pixels.has(1) && (n < MAX_LEDS)) {
+      *p++ = 0xE0 | 0x1F;
+      *p++ = pixels.loadAndScale0(0, s0);
+      *p++ = pixels.loadAndScale1(0, s1);
+      *p++ = pixels.loadAndScale2(0, s2);
+      pixels.stepDithering();
+      pixels.advanceData();
+      n++;
+    }
+
+    // End frame: at least half a clock edge per LED to push the data through
+    for (uint16_t i = 0; i <= n / 32; i++) {
+      *p++ = 0xFF;
+      *p++ = 0x00;
+      *p++ = 0x00;
+      *p++ = 0x00;
+    }
+
+    _len = p - _buf;
+    _spi->transfer(_buf, nullptr, _len, false); // Non-blocking DMA transfer
+  }
+};
+
+/*------------------------------------------------------------------------------
+  MultiSPI
+------------------------------------------------------------------------------*/
+
+namespace MultiSPI {
+  static_assert((FLC::N_CHANNELS >= 1) & (FLC::N_CHANNELS <= 4),
+                "FLC::N_CHANNELS must be [1 - 4]");
+
+  const uint32_t MAX_NUMEL =
+      max_channel_numel(FLC::GEOMETRY, FLC::N_CHANNELS);
+  static_assert(APA102_FRAME_SIZE(MAX_NUMEL) < 65536,
+                "MultiSPI: Channel too long for a single DMA transfer");
+
+  typedef APA102_DMAController<FLC::COLOR_ORDER, MAX_NUMEL> Controller;
+
+  static Controller *controllers = nullptr;
+
+  SPIClass *port(uint8_t ch) {
+    /* SPI port of channel `ch`, constructed on first use only
+     */
+    switch (ch) {
+      case 1: {
+        static SPIClass SPI_ch1(&sercom0, A4, A1, A4, SPI_PAD_0_SCK_1,
+                                SERCOM_RX_PAD_3);
+        return &SPI_ch1;
+      }
+      case 2: {
+        static SPIClass SPI_ch2(&sercom3, 1, 0, 1, SPI_PAD_0_SCK_1,
+                                SERCOM_RX_PAD_3);
+        return &SPI_ch2;
+      }
+      case 3: {
+        static SPIClass SPI_ch3(&sercom2, SDA, SCL, SDA, SPI_PAD_0_SCK_1,
+                                SERCOM_RX_PAD_3);
+        return &SPI_ch3;
+      }
+      default:
+        return &SPI;
+    }
+  }
+
+  void begin(CRGB *leds) {
+    /* Register a FastLED controller for each channel, each on its own slice
+    of `leds`
+    */
+    // Constructed on first call, because FastLED lists its controllers in
+    // order of construction
+    static Controller ctrl[FLC::N_CHANNELS];
+    controllers = ctrl;
+
+    const uint8_t pin_data[] = {PIN_SPI_MOSI, A4, 1, SDA};
+    const uint8_t pin_clk[] = {PIN_SPI_SCK, A1, 0, SCL};
+    const EPioType pio[] = {PIO_SERCOM_ALT, PIO_SERCOM_ALT, PIO_SERCOM_ALT,
+                            PIO_SERCOM};
+
+    for (uint8_t ch = 0; ch < FLC::N_CHANNELS; ch++) {
+      ctrl[ch].set_port(port(ch), pin_data[ch], pin_clk[ch], pio[ch],
+                        FLC::SPI_CLOCK);
+      FastLED.addLeds(&ctrl[ch],
+                      leds + channel_start(FLC::GEOMETRY, ch, FLC::N_CHANNELS),
+                      channel_numel(FLC::GEOMETRY, ch, FLC::N_CHANNELS));
+    }
+  }
+
+  void print_timing(Stream *mySerial) {
+    /* Print the modelled transmission time of the last frame per channel, and
+    in total when transmitted concurrently versus serially
+    */
+    uint32_t t_max = 0;
+    uint32_t t_sum = 0;
+
+    if (!controllers) {
+      return;
+    }
+    for (uint8_t ch = 0; ch < FLC::N_CHANNELS; ch++) {
+      uint32_t t = controllers[ch].frame_time_us();
+      t_max = max(t_max, t);
+      t_sum += t;
+      mySerial->print("  Channel ");
+      mySerial->print(ch);
+      mySerial->print(": ");
+      mySerial->print(controllers[ch].frame_size());
+      mySerial->print(" bytes, ");
+      mySerial->print(t);
+      mySerial->println(" us");
+    }
+    mySerial->print("  Parallel: ");
+    mySerial->print(t_max);
+    mySerial->print(" us, serial: ");
+    mySerial->print(t_sum);
+    mySerial->println(" us");
+  }
+} // namespace MultiSPI
+
+#else
+static_assert(FLC::N_CHANNELS == 1,
+              "Parallel output channels are only mapped for the ItsyBitsy M4");
+#endif
+#endif
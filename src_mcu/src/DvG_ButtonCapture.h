@@ -0,0 +1,260 @@
+/* DvG_ButtonCapture.h
+
+Interrupt-driven capture of a push button, built on top of `avdweb_Switch`.
+
+`Switch::poll()` only samples the pin when `loop()` gets around to it. Any
+blocking part of the loop, like a heavy frame or a menu animation, makes
+clicks go missing or get mis-timed as long presses. Instead, `ButtonCapture`
+catches every edge of the pin with an EIC edge interrupt and pushes it,
+timestamped, into a lock-free single-producer/single-consumer ring buffer.
+
+`poll()` drains the ring buffer and replays the edges, at their original
+timestamps, through the debounce, long-press and double-click state machine of
+`Switch`. Hence, event detection depends on the edge timing only and not on the
+moment of polling. A `poll()` stops replaying right after the first moment at
+which events occur, latching those and leaving the later edges queued for the
+next `poll()`. Hence, no event gets lost or merged with a later one of the same
+kind, however long `loop()` got blocked. See `host/button_replay.cpp`.
+
+Usage:
+  ButtonCapture button = ButtonCapture(PIN_BUTTON, INPUT_PULLUP, LOW, ...);
+  void button_ISR() { button.capture(); }
+
+  setup() { button.begin(button_ISR); }
+  loop()  { button.poll(); if (button.singleClick()) {...} }
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_BUTTONCAPTURE_H
+#define DVG_BUTTONCAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "avdweb_Switch.h"
+
+/*------------------------------------------------------------------------------
+  EdgeQueue
+
+  Lock-free single-producer/single-consumer ring buffer of timestamped edges.
+  The producer is the pin interrupt, the consumer is `loop()`. As both run on
+  the same core, compiler fences suffice to order the buffer accesses with
+  respect to the head and tail indices.
+------------------------------------------------------------------------------*/
+
+struct ButtonEdge {
+  uint32_t t;  // [ms] `millis()` at the moment of the edge
+  bool level;  // Pin level right after the edge
+};
+
+template <uint8_t SIZE> class EdgeQueue {
+  static_assert((SIZE & (SIZE - 1)) == 0, "EdgeQueue: SIZE must be 2^n");
+
+private:
+  ButtonEdge _buf[SIZE];
+  volatile uint8_t _head = 0; // Written by the producer only
+  volatile uint8_t _tail = 0; // Written by the consumer only
+  volatile uint16_t _n_dropped = 0;
+
+public:
+  bool push(const ButtonEdge &edge) {
+    // Producer side
+    uint8_t head = _head;
+    if ((uint8_t)(head - _tail) >= SIZE) {
+      _n_dropped = _n_dropped + 1;
+      return false;
+    }
+    _buf[head & (SIZE - 1)] = edge;
+    std::atomic_signal_fence(std::memory_order_release);
+    _head = head + 1;
+    return true;
+  }
+
+  bool pop(ButtonEdge &edge) {
+    // Consumer side
+    uint8_t tail = _tail;
+    if (tail == _head) {
+      return false;
+    }
+    std::atomic_signal_fence(std::memory_order_acquire);
+    edge = _buf[tail & (SIZE - 1)];
+    std::atomic_signal_fence(std::memory_order_release);
+    _tail = tail + 1;
+    return true;
+  }
+
+  bool peek(ButtonEdge &edge) {
+    // Consumer side
+    uint8_t tail = _tail;
+    if (tail == _head) {
+      return false;
+    }
+    std::atomic_signal_fence(std::memory_order_acquire);
+    edge = _buf[tail & (SIZE - 1)];
+    return true;
+  }
+
+  uint16_t n_dropped() {
+    return _n_dropped;
+  }
+};
+
+/*------------------------------------------------------------------------------
+  ButtonCapture
+------------------------------------------------------------------------------*/
+
+#define BUTTON_EDGE_QUEUE_SIZE 32
+
+class ButtonCapture : public Switch {
+private:
+  EdgeQueue<BUTTON_EDGE_QUEUE_SIZE> _queue;
+  volatile bool _isr_level; // Last level pushed by the ISR
+  bool _level;              // Pin level as replayed up to `_t_sim`
+  uint32_t _t_sim;          // [ms] Time up to which the state machine has run
+  uint32_t _t_last_edge;    // [ms] Time of the last replayed edge
+  uint32_t _horizon;        // [ms] Time after an edge in which events can occur
+
+  // Events latched during the last `poll()`
+  bool _ev_switched, _ev_pushed, _ev_released;
+  bool _ev_longPress, _ev_doubleClick, _ev_singleClick;
+
+  bool step(uint32_t t) {
+    // Run the `Switch` state machine once at time `t` and latch its events.
+    // Returns true when any event occurred.
+    input = _level;
+    ms = t;
+    process();
+    _ev_switched |= Switch::switched();
+    _ev_pushed |= Switch::pushed();
+    _ev_released |= Switch::released();
+    _ev_longPress |= Switch::longPress();
+    _ev_doubleClick |= Switch::doubleClick();
+    _ev_singleClick |= Switch::singleClick();
+    return Switch::switched() || Switch::longPress() ||
+           Switch::doubleClick() || Switch::singleClick();
+  }
+
+  bool advance_to(uint32_t t) {
+    /* Advance the state machine up to time `t` while holding the current pin
+    level. Close after an edge, the deglitch, debounce and click timers can
+    expire at any millisecond, so we step with 1 ms resolution. Past the
+    horizon nothing can change anymore, except for conditions that remain true
+    once met, hence we can jump straight to `t`. Stops early, returning true,
+    at the first step with events.
+    */
+    while ((int32_t)(t - _t_sim) > 0) {
+      if (_t_sim - _t_last_edge < _horizon) {
+        _t_sim++;
+      } else {
+        _t_sim = t;
+      }
+      if (step(_t_sim)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+public:
+  ButtonCapture(byte _pin, byte PinMode = INPUT_PULLUP, bool polarity = LOW,
+                unsigned long debouncePeriod = 50,
+                unsigned long longPressPeriod = 300,
+                unsigned long doubleClickPeriod = 250,
+                unsigned long deglitchPeriod = 10)
+      : Switch(_pin, PinMode, polarity, debouncePeriod, longPressPeriod,
+               doubleClickPeriod, deglitchPeriod) {
+    _level = _isr_level = digitalRead(pin);
+    _t_sim = _t_last_edge = millis();
+    _horizon = max(max(deglitchPeriod + debouncePeriod, longPressPeriod),
+                   doubleClickPeriod) +
+               deglitchPeriod + debouncePeriod + 2;
+    clear_events();
+  }
+
+  void begin(void (*isr)()) {
+    /* Attach the edge interrupt. `isr` should simply call `capture()`.
+     */
+    attachInterrupt(digitalPinToInterrupt(pin), isr, CHANGE);
+  }
+
+  void capture() {
+    /* To be called from the pin interrupt only
+     */
+    bool level = digitalRead(pin);
+    if (level != _isr_level) {
+      _isr_level = level;
+      _queue.push(ButtonEdge{(uint32_t)millis(), level});
+    }
+  }
+
+  bool push_edge(uint32_t t, bool level) {
+    /* Inject an edge by hand, e.g. to replay a recorded edge trace. Must not be
+    mixed with an attached interrupt.
+    */
+    _isr_level = level;
+    return _queue.push(ButtonEdge{t, level});
+  }
+
+  bool poll() {
+    return poll(millis());
+  }
+
+  bool poll(uint32_t now) {
+    /* Replay the captured edges up to time `now` through the state machine,
+    up to the first moment with events. Returns true when the debounced state
+    has switched.
+    */
+    ButtonEdge edge;
+
+    clear_events();
+    while (_queue.peek(edge) && ((int32_t)(edge.t - now) <= 0)) {
+      if (advance_to(edge.t - 1)) { // Old level held up to just before the edge
+        return _ev_switched;
+      }
+      _queue.pop(edge);
+      _level = edge.level;
+      _t_last_edge = edge.t;
+      if ((int32_t)(edge.t - _t_sim) > 0) {
+        _t_sim = edge.t;
+      }
+      if (step(_t_sim)) {
+        return _ev_switched;
+      }
+    }
+    advance_to(now);
+
+    return _ev_switched;
+  }
+
+  void clear_events() {
+    _ev_switched = _ev_pushed = _ev_released = false;
+    _ev_longPress = _ev_doubleClick = _ev_singleClick = false;
+  }
+
+  uint16_t n_dropped_edges() {
+    return _queue.n_dropped();
+  }
+
+  // Events, refreshed by `poll()`
+  bool switched() {
+    return _ev_switched;
+  }
+  bool pushed() {
+    return _ev_pushed;
+  }
+  bool released() {
+    return _ev_released;
+  }
+  bool longPress() {
+    return _ev_longPress;
+  }
+  bool doubleClick() {
+    return _ev_doubleClick;
+  }
+  bool singleClick() {
+    return _ev_singleClick;
+  }
+};
+
+#endif
@@ -17,15 +17,6 @@ https://www.mathworks.com/matlabcentral/fileexchange/10858-ecg-simulation-using-
 #define M_TWOPI 6.283185307179586476925286766559
 #endif
 
-typedef struct ECG_params {
-    double a_p, d_p, t_p;
-    double a_q, d_q, t_q;
-    double a_qrs, d_qrs, t_qrs;
-    double a_s, d_s, t_s;
-    double a_t, d_t, t_t;
-    double a_u, d_u, t_u;
-} ECG_params;
-
 typedef struct ECG_derived {
     double x_shift_p, x_shift_q, x_shift_qrs, x_shift_s, x_shift_t, x_shift_u;
     double b_p, b_q, b_qrs, b_s, b_t, b_u;
@@ -77,32 +68,37 @@ static void derive_ECG_params(const ECG_params  *prms,
 ------------------------------------------------------------------------------*/
 
 static void init_ECG_params(void) {
+    ECG_default_params(&ecg_prms);
+    derive_ECG_params(&ecg_prms, &ecg_drvd);
+}
+
+void ECG_default_params(ECG_params *prms) {
     // Standard ECG parameters
-    ecg_prms.a_p = 0.25;
-    ecg_prms.d_p = 0.09;
-    ecg_prms.t_p = 0.16;
+    prms->heart_rate = 60.;
 
-    ecg_prms.a_q = 0.025;
-    ecg_prms.d_q = 0.066;
-    ecg_prms.t_q = 0.166;
+    prms->a_p = 0.25;
+    prms->d_p = 0.09;
+    prms->t_p = 0.16;
 
-    ecg_prms.a_qrs = 1.6;
-    ecg_prms.d_qrs = 0.11;
-    ecg_prms.t_qrs = 0.;
+    prms->a_q = 0.025;
+    prms->d_q = 0.066;
+    prms->t_q = 0.166;
 
-    ecg_prms.a_s = 0.25;
-    ecg_prms.d_s = 0.066;
-    ecg_prms.t_s = 0.09;
+    prms->a_qrs = 1.6;
+    prms->d_qrs = 0.11;
+    prms->t_qrs = 0.;
 
-    ecg_prms.a_t = 0.35;
-    ecg_prms.d_t = 0.142;
-    ecg_prms.t_t = 0.2;
+    prms->a_s = 0.25;
+    prms->d_s = 0.066;
+    prms->t_s = 0.09;
 
-    ecg_prms.a_u = 0.035;
-    ecg_prms.d_u = 0.0476;
-    ecg_prms.t_u = 0.433;
+    prms->a_t = 0.35;
+    prms->d_t = 0.142;
+    prms->t_t = 0.2;
 
-    derive_ECG_params(&ecg_prms, &ecg_drvd);
+    prms->a_u = 0.035;
+    prms->d_u = 0.0476;
+    prms->t_u = 0.433;
 }
 
 static void derive_ECG_params(const ECG_params  *prms,
@@ -422,6 +418,79 @@ static void add_ECG_wave_part(ECG_wave_part ecg_part,
 
 #endif
 
+/*------------------------------------------------------------------------------
+    generate_ECG_direct
+------------------------------------------------------------------------------*/
+
+typedef struct ECG_pulse {
+    float shift;  // Phase of the pulse center at sample 0, [periods]
+    float half;   // Half the pulse width, [periods]
+    float a;      // Signed amplitude
+    bool  cosine; // Cosine pulse, otherwise a triangular pulse
+} ECG_pulse;
+
+float generate_ECG_direct(float *ecg,
+                          const uint16_t N_SMP,
+                          const ECG_params *prms) {
+    // Durations and intervals [s] relative to the period
+    const float f = (float) (prms->heart_rate / 60.);
+    const ECG_pulse pulses[6] = {
+        { f * (float)  prms->t_p,
+          f * (float)  prms->d_p   / 2.f, (float)  prms->a_p  , true },
+        { f * (float)  prms->t_q,
+          f * (float)  prms->d_q   / 2.f, (float) -prms->a_q  , false},
+        { f * (float)  prms->t_qrs,
+          f * (float)  prms->d_qrs / 2.f, (float)  prms->a_qrs, false},
+        { f * (float) -prms->t_s,
+          f * (float)  prms->d_s   / 2.f, (float) -prms->a_s  , false},
+        { f * (float) (prms->t_t - 0.045),
+          f * (float)  prms->d_t   / 2.f, (float)  prms->a_t  , true },
+        { f * (float) -prms->t_u,
+          f * (float)  prms->d_u   / 2.f, (float)  prms->a_u  , true },
+    };
+    const float dx = 1.f / N_SMP;
+    uint16_t i;
+    uint8_t  k;
+
+    for (i = 0; i < N_SMP; i++) {ecg[i] = 0.f;}
+
+    // Add each pulse. Its Fourier series has the pulse center at a phase of
+    // 0, i.e. at 'i * dx + shift' equal to an integer.
+    for (k = 0; k < 6; k++) {
+        const ECG_pulse *p = &pulses[k];
+        if (p->half <= 0.f) {continue;}
+        const float w = (float) M_PI_2 / p->half;
+
+        for (i = 0; i < N_SMP; i++) {
+            float x = i * dx + p->shift;
+            x = fabsf(x - floorf(x + .5f)); // Distance to the center [periods]
+            if (x >= p->half) {continue;}
+
+            if (p->cosine) {
+                ecg[i] += p->a * cosf(w * x);
+            } else {
+                ecg[i] += p->a * (1.f - x / p->half);
+            }
+        }
+    }
+
+    // Normalize ECG output to [0 ... 1]. The resting level is 0 in here.
+    float ecg_min = 0.f;
+    float ecg_max = 0.f;
+    for (i = 0; i < N_SMP; i++) {
+        if (ecg_min > ecg[i]) {ecg_min = ecg[i];}
+        if (ecg_max < ecg[i]) {ecg_max = ecg[i];}
+    }
+    if (ecg_max <= ecg_min) {return 0.f;}
+
+    const float scale = 1.f / (ecg_max - ecg_min);
+    for (i = 0; i < N_SMP; i++) {
+        ecg[i] = (ecg[i] - ecg_min) * scale;
+    }
+
+    return -ecg_min * scale;
+}
+
 /*------------------------------------------------------------------------------
     Copy of source:
     https://www.mathworks.com/matlabcentral/fileexchange/10858-ecg-simulation-using-matlab
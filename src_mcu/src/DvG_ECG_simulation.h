@@ -45,7 +45,36 @@ This library can operate in two modes depending on the available resources.
 
 #include <stdint.h>
 
+// Amplitudes [mV], durations [s] and intervals [s] of the ECG wave parts
+typedef struct ECG_params {
+    double heart_rate; // [BPM] Only used by 'generate_ECG_direct()'
+    double a_p, d_p, t_p;
+    double a_q, d_q, t_q;
+    double a_qrs, d_qrs, t_qrs;
+    double a_s, d_s, t_s;
+    double a_t, d_t, t_t;
+    double a_u, d_u, t_u;
+} ECG_params;
+
+void ECG_default_params(ECG_params *prms);
+
+// Fourier series of the ECG wave parts, using the default parameters at
+// 60 BPM. Takes O(N_SMP * ECG_N_ITER) trigonometric evaluations.
 void generate_ECG(float *ecg,            // Array to output ECG waveform to
                   const uint16_t N_SMP); // No. samples for one full period
 
+/*
+Evaluates the ECG wave parts directly, as the periodic cosine pulses (P, T and
+U) and triangular pulses (Q, QRS and S) that the Fourier series converge to.
+Takes O(N_SMP) single-precision operations and no extra RAM, fast enough to
+regenerate the waveform in between two frames. The durations and intervals
+are taken relative to the period at 'prms->heart_rate'.
+
+Returns the resting level of the heart, i.e. the flat parts in between the
+pulses, within the normalized output range [0 ... 1].
+*/
+float generate_ECG_direct(float *ecg,              // Array to output to
+                          const uint16_t N_SMP,    // No. samples for 1 period
+                          const ECG_params *prms); // Parameters of the parts
+
 #endif
@@ -0,0 +1,486 @@
+/* DvG_FastLED_Animation.h
+
+Recording and playback of precomputed animations in the external QSPI flash.
+
+`AnimRecorder` samples the LED data of the full strip at a fixed period while
+any effect is playing, encodes each frame against the previous one and
+streams the result into the QSPI flash. `AnimPlayer` streams it back out.
+Playback costs only a small flash read and a decode per frame, independent of
+how expensive the recorded effect is to calculate.
+
+Frame codec
+-----------
+Each frame is encoded as a sequence of runs against the previous frame, which
+is all black before the first frame. Every run starts with a single byte:
+bits 7-6 hold the opcode and bits 5-0 hold the run length minus 1, [1 - 64].
+
+  00  SKIP    LEDs unchanged with respect to the previous frame
+  01  LITERAL followed by one CRGB per LED, 3 bytes each
+  10  REPEAT  followed by a single CRGB, repeated over all LEDs of the run
+
+Slowly changing effects mostly encode into a few SKIP runs, and blocks of a
+single colour into REPEAT runs. The worst case, a frame of all distinct and
+all changed LEDs, takes 3 bytes per LED plus 1 byte per 64 LEDs.
+
+File layout in flash, at `FLC::ANIM_ADDR`
+-----------------------------------------
+  AnimHeader, then per frame: uint16 payload size (little-endian), payload
+
+Uploading
+---------
+Effects too expensive to record in real time can be recorded by the offline
+renderer `host/render.cpp` instead, in virtual time, into a `.fxan` file
+holding the very same bytes as the flash. `src_python/upload_anim.py` sends it
+over serial command 'd': the file followed by its CRC-16/CCITT-FALSE,
+little-endian. `AnimUpload` erases the flash region, programs the bytes as
+they come in, without blocking the main loop, and programs the header last,
+only when the CRC checks out. After an error it keeps consuming bytes until
+`ANIM_UPLOAD_TIMEOUT` ms of silence.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_ANIMATION_H
+#define DVG_FASTLED_ANIMATION_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_Stream.h" // crc16_ccitt()
+#include "DvG_FastLED_config.h"
+#include "DvG_QSPIFlash.h"
+#include "FastLED.h"
+
+static_assert(FLC::ANIM_ADDR % QSPIFlash::BLOCK_SIZE == 0,
+              "FLC::ANIM_ADDR must be 64 kB aligned");
+static_assert(FLC::ANIM_SIZE % QSPIFlash::BLOCK_SIZE == 0,
+              "FLC::ANIM_SIZE must be a multiple of 64 kB");
+static_assert(FLC::ANIM_ADDR + FLC::ANIM_SIZE <= QSPIFlash::SIZE,
+              "Animation region exceeds the QSPI flash");
+
+#define ANIM_MAGIC 0x4E415846 // "FXAN"
+#define ANIM_UPLOAD_TIMEOUT 1000 // [ms]
+#define ANIM_MAX_FRAME_SIZE(n) (3 * (n) + (n) / 64 + 1)
+
+#define ANIM_OP_SKIP 0x00
+#define ANIM_OP_LITERAL 0x40
+#define ANIM_OP_REPEAT 0x80
+#define ANIM_OP_MASK 0xC0
+#define ANIM_MAX_RUN 64
+
+struct AnimHeader {
+  uint32_t magic;     // `ANIM_MAGIC` when the flash holds a valid recording
+  uint16_t numel;     // Number of LEDs per frame
+  uint16_t period;    // [ms] Frame period
+  uint32_t n_frames;  // Number of recorded frames
+  uint32_t n_bytes;   // Number of bytes of all frames, sizes included
+};
+
+/*------------------------------------------------------------------------------
+  Codec
+------------------------------------------------------------------------------*/
+
+uint16_t anim_encode_frame(const CRGB *cur, const CRGB *prev, uint16_t numel,
+                           uint8_t *out) {
+  /* Encode frame `cur` against frame `prev` into `out`, which must be able to
+  hold `ANIM_MAX_FRAME_SIZE(numel)` bytes. Returns the number of bytes.
+  */
+  uint8_t *p = out;
+  uint16_t idx = 0;
+  uint16_t run;
+
+  while (idx < numel) {
+    if (cur[idx] == prev[idx]) {
+      run = 1;
+      while ((idx + run < numel) && (run < ANIM_MAX_RUN) &&
+             (cur[idx + run] == prev[idx + run])) {
+        run++;
+      }
+      *p++ = ANIM_OP_SKIP | (run - 1);
+
+    } else if ((idx + 1 < numel) && (cur[idx + 1] == cur[idx])) {
+      run = 2;
+      while ((idx + run < numel) && (run < ANIM_MAX_RUN) &&
+             (cur[idx + run] == cur[idx])) {
+        run++;
+      }
+      *p++ = ANIM_OP_REPEAT | (run - 1);
+      *p++ = cur[idx].r;
+      *p++ = cur[idx].g;
+      *p++ = cur[idx].b;
+
+    } else {
+      // Extend the literal until a SKIP or REPEAT run would start
+      run = 1;
+      while ((idx + run < numel) && (run < ANIM_MAX_RUN) &&
+             (cur[idx + run] != prev[idx + run]) &&
+             !((idx + run + 1 < numel) &&
+               (cur[idx + run + 1] == cur[idx + run]))) {
+        run++;
+      }
+      *p++ = ANIM_OP_LITERAL | (run - 1);
+      for (uint16_t i = idx; i < idx + run; i++) {
+        *p++ = cur[i].r;
+        *p++ = cur[i].g;
+        *p++ = cur[i].b;
+      }
+    }
+    idx += run;
+  }
+
+  return p - out;
+}
+
+bool anim_decode_frame(const uint8_t *in, uint16_t len, CRGB *frame,
+                       uint16_t numel) {
+  /* Decode `len` bytes of `in` on top of the previous frame held by `frame`.
+  Returns false when the data is corrupt.
+  */
+  const uint8_t *end = in + len;
+  uint16_t idx = 0;
+
+  while (in < end) {
+    uint8_t op = *in & ANIM_OP_MASK;
+    uint16_t run = (*in++ & ~ANIM_OP_MASK) + 1;
+
+    if (idx + run > numel) {
+      return false;
+    }
+    switch (op) {
+      case ANIM_OP_SKIP:
+        break;
+
+      case ANIM_OP_LITERAL:
+        if (in + 3 * run > end) {
+          return false;
+        }
+        for (uint16_t i = idx; i < idx + run; i++) {
+          frame[i] = CRGB(in[0], in[1], in[2]);
+          in += 3;
+        }
+        break;
+
+      case ANIM_OP_REPEAT:
+        if (in + 3 > end) {
+          return false;
+        }
+        fill_solid(&frame[idx], run, CRGB(in[0], in[1], in[2]));
+        in += 3;
+        break;
+
+      default:
+        return false;
+    }
+    idx += run;
+  }
+
+  return idx == numel;
+}
+
+/*------------------------------------------------------------------------------
+  AnimRecorder
+------------------------------------------------------------------------------*/
+
+class AnimRecorder {
+private:
+  bool _recording = false;
+  AnimHeader _header;
+  CRGB _prev[FLC::N];                // Last recorded frame
+  uint8_t _buf[QSPIFlash::PAGE_SIZE]; // Collects bytes up to a full page
+  uint16_t _buf_fill = 0;
+  uint32_t _addr = 0;                // Flash address of `_buf[0]`
+  uint32_t _tick = 0;
+
+  bool append(const uint8_t *data, uint16_t len) {
+    /* Append bytes to the recording, programming each page once full.
+    Returns false when the flash region is full.
+    */
+    if (_addr + _buf_fill + len > FLC::ANIM_ADDR + FLC::ANIM_SIZE) {
+      return false;
+    }
+    while (len--) {
+      _buf[_buf_fill++] = *data++;
+      if (_buf_fill == sizeof(_buf)) {
+        QSPIFlash::write(_addr, _buf, _buf_fill);
+        _addr += _buf_fill;
+        _buf_fill = 0;
+      }
+    }
+    return true;
+  }
+
+public:
+  void start() {
+    /* Erase the flash region and start recording. Blocks for up to a second
+    or so, depending on `FLC::ANIM_SIZE`.
+    */
+    const uint32_t end = FLC::ANIM_ADDR + FLC::ANIM_SIZE;
+    for (uint32_t addr = FLC::ANIM_ADDR; addr < end;
+         addr += QSPIFlash::BLOCK_SIZE) {
+      QSPIFlash::erase(addr, true);
+    }
+    _header.magic = ANIM_MAGIC;
+    _header.numel = FLC::N;
+    _header.period = FLC::ANIM_PERIOD;
+    _header.n_frames = 0;
+    _header.n_bytes = 0;
+    fill_solid(_prev, FLC::N, CRGB::Black);
+
+    // The header gets programmed last, once the recording is complete
+    _addr = FLC::ANIM_ADDR;
+    _buf_fill = 0;
+    memset(_buf, 0xFF, sizeof(AnimHeader));
+    _buf_fill = sizeof(AnimHeader);
+    _tick = millis();
+    _recording = true;
+  }
+
+  void stop() {
+    if (!_recording) {
+      return;
+    }
+    _recording = false;
+    if (_buf_fill) {
+      QSPIFlash::write(_addr, _buf, _buf_fill);
+    }
+    QSPIFlash::write(FLC::ANIM_ADDR, (const uint8_t *)&_header,
+                     sizeof(AnimHeader));
+  }
+
+  void add(const CRGB *frame) {
+    /* To be called every loop iteration with the LED data of the full strip,
+    recording it once per `FLC::ANIM_PERIOD`. Stops automatically once the
+    flash region is full.
+    */
+    static uint8_t enc[ANIM_MAX_FRAME_SIZE(FLC::N)];
+
+    if (!_recording || (millis() - _tick < FLC::ANIM_PERIOD)) {
+      return;
+    }
+    _tick += FLC::ANIM_PERIOD;
+    if (millis() - _tick >= FLC::ANIM_PERIOD) {
+      // Fallen behind, e.g. after a long blocking call: skip the backlog
+      _tick = millis();
+    }
+
+    uint16_t len = anim_encode_frame(frame, _prev, FLC::N, enc);
+    uint8_t len_le[2] = {(uint8_t)len, (uint8_t)(len >> 8)};
+    if (!append(len_le, 2) || !append(enc, len)) {
+      stop();
+      return;
+    }
+    memcpy8(_prev, frame, FLC::N * sizeof(CRGB));
+    _header.n_frames++;
+    _header.n_bytes += 2 + len;
+  }
+
+  bool is_recording() { return _recording; }
+
+  void print_info(Stream *mySerial) {
+    mySerial->print("Recorded frames: ");
+    mySerial->print(_header.n_frames);
+    mySerial->print(", bytes/frame: ");
+    mySerial->println(_header.n_frames
+                          ? (float)_header.n_bytes / _header.n_frames
+                          : 0);
+  }
+};
+
+/*------------------------------------------------------------------------------
+  AnimPlayer
+------------------------------------------------------------------------------*/
+
+class AnimPlayer {
+private:
+  AnimHeader _header;
+  bool _valid = false;
+  uint32_t _addr;     // Flash address of the next frame
+  uint32_t _i_frame;  // Index of the next frame
+  uint32_t _tick;
+  CRGB _frame[FLC::N]; // Decoded frame, decoding builds on top of it
+
+  void rewind() {
+    _addr = FLC::ANIM_ADDR + sizeof(AnimHeader);
+    _i_frame = 0;
+    fill_solid(_frame, FLC::N, CRGB::Black);
+  }
+
+public:
+  bool begin() {
+    /* Read the header and rewind. Returns true when the flash holds a
+    recording matching the current strip.
+    */
+    QSPIFlash::read(FLC::ANIM_ADDR, (uint8_t *)&_header, sizeof(AnimHeader));
+    _valid = (_header.magic == ANIM_MAGIC) && (_header.numel == FLC::N) &&
+             (_header.n_frames > 0) && (_header.period > 0);
+    rewind();
+    _tick = millis() - _header.period;
+    return _valid;
+  }
+
+  const CRGB *update() {
+    /* Decode the next frame once its period has passed, looping at the end.
+    Returns the current frame, or nullptr when there is no valid recording.
+    */
+    static uint8_t enc[ANIM_MAX_FRAME_SIZE(FLC::N)];
+    uint8_t len_le[2];
+    uint16_t len;
+
+    if (!_valid) {
+      return nullptr;
+    }
+    if (millis() - _tick < _header.period) {
+      return _frame;
+    }
+    _tick += _header.period;
+    if (millis() - _tick >= _header.period) {
+      // Fallen behind, e.g. after a long blocking call: skip the backlog
+      _tick = millis();
+    }
+
+    if (_i_frame >= _header.n_frames) {
+      rewind();
+    }
+    QSPIFlash::read(_addr, len_le, 2);
+    len = len_le[0] | len_le[1] << 8;
+    if (len > sizeof(enc)) {
+      _valid = false;
+      return nullptr;
+    }
+    QSPIFlash::read(_addr + 2, enc, len);
+    if (!anim_decode_frame(enc, len, _frame, FLC::N)) {
+      _valid = false;
+      return nullptr;
+    }
+    _addr += 2 + len;
+    _i_frame++;
+
+    return _frame;
+  }
+};
+
+/*------------------------------------------------------------------------------
+  AnimUpload
+------------------------------------------------------------------------------*/
+
+enum AnimUploadStatus {
+  ANIM_UPLOAD_BUSY,
+  ANIM_UPLOAD_OK,
+  ANIM_UPLOAD_REJECTED
+};
+
+class AnimUpload {
+private:
+  AnimHeader _header;
+  uint8_t _buf[QSPIFlash::PAGE_SIZE]; // Collects bytes up to a full page
+  uint16_t _buf_fill;
+  uint32_t _addr;  // Flash address of `_buf[0]`
+  uint32_t _pos;   // Number of bytes received, CRC excluded
+  uint32_t _size;  // Size of the file, known once the header is in
+  uint16_t _crc;   // Running CRC
+  uint16_t _crc_rx; // Received CRC
+  bool _error;
+  bool _active = false;
+  uint32_t _tick; // [ms] `millis()` at the last received byte
+
+  bool check_header() {
+    return (_header.magic == ANIM_MAGIC) && (_header.numel == FLC::N) &&
+           (_header.n_frames > 0) && (_header.period > 0) &&
+           (sizeof(AnimHeader) + _header.n_bytes <= FLC::ANIM_SIZE);
+  }
+
+  AnimUploadStatus finish() {
+    /* Program the header once all bytes are in and the CRC checks out
+     */
+    _active = false;
+    if (_buf_fill) {
+      QSPIFlash::write(_addr, _buf, _buf_fill);
+    }
+    if (_crc_rx != _crc) {
+      return ANIM_UPLOAD_REJECTED;
+    }
+    QSPIFlash::write(FLC::ANIM_ADDR, (const uint8_t *)&_header,
+                     sizeof(AnimHeader));
+    return ANIM_UPLOAD_OK;
+  }
+
+public:
+  void start() {
+    /* To be called on serial command 'd'. Erases the flash region, blocking
+    like `AnimRecorder::start()` does.
+    */
+    const uint32_t end = FLC::ANIM_ADDR + FLC::ANIM_SIZE;
+    for (uint32_t addr = FLC::ANIM_ADDR; addr < end;
+         addr += QSPIFlash::BLOCK_SIZE) {
+      QSPIFlash::erase(addr, true);
+    }
+
+    // The header gets programmed last, once the upload is complete
+    memset(_buf, 0xFF, sizeof(AnimHeader));
+    _buf_fill = sizeof(AnimHeader);
+    _addr = FLC::ANIM_ADDR;
+    _pos = 0;
+    _size = sizeof(AnimHeader);
+    _crc = 0xFFFF;
+    _crc_rx = 0;
+    _error = false;
+    _tick = millis();
+    _active = true;
+  }
+
+  bool is_active() { return _active; }
+
+  AnimUploadStatus poll(Stream *mySerial) {
+    /* Consume all bytes available right now, programming each page once
+    full. To be called every loop iteration while active.
+    */
+    int n = mySerial->available();
+    uint8_t c;
+
+    if (n > 0) {
+      _tick = millis();
+    } else if (millis() - _tick > ANIM_UPLOAD_TIMEOUT) {
+      _active = false;
+      return ANIM_UPLOAD_REJECTED;
+    }
+    while (n-- > 0) {
+      c = mySerial->read();
+      if (_error) {
+        continue;
+      }
+
+      if (_pos >= _size) {
+        // CRC, little-endian
+        _crc_rx |= (uint16_t)c << (8 * (_pos++ - _size));
+        if (_pos == _size + 2) {
+          return finish();
+        }
+        continue;
+      }
+
+      _crc = crc16_ccitt(_crc, c);
+      if (_pos < sizeof(AnimHeader)) {
+        ((uint8_t *)&_header)[_pos++] = c;
+        if (_pos == sizeof(AnimHeader)) {
+          _error = !check_header();
+          _size = sizeof(AnimHeader) + _header.n_bytes;
+        }
+        continue;
+      }
+
+      _buf[_buf_fill++] = c;
+      _pos++;
+      if (_buf_fill == sizeof(_buf)) {
+        QSPIFlash::write(_addr, _buf, _buf_fill);
+        _addr += _buf_fill;
+        _buf_fill = 0;
+      }
+    }
+    return ANIM_UPLOAD_BUSY;
+  }
+};
+
+AnimRecorder anim_recorder;
+AnimPlayer anim_player;
+AnimUpload anim_upload;
+
+#endif
@@ -0,0 +1,164 @@
+/* DvG_FastLED_Benchmark.h
+
+Micro-benchmarks of the FastLED primitives used by the effects, to tell which
+of them are worth optimizing: `scale8()`, `qadd8()`, `beatsin8()`, `sin16()`,
+`hsv2rgb_rainbow()`, `ColorFromPalette()`, `blur1d()` and `nblend()`.
+
+The SAMD51 is a Cortex-M4, hence instead of modelling the cycle counts, they
+get counted on the device itself by the DWT cycle counter. Each case calls
+the primitive `N_CALLS` times on inputs taken from a fixed pseudo-random
+table, stores the results into a volatile sink, and subtracts the cycles of
+the same loop with an empty body. Interrupts, i.e. SysTick and USB, stay
+enabled, hence the minimum over `N_RUNS` runs gets reported. On other boards
+the cycles get estimated from `micros()` and `F_CPU`. On the host PC they get
+timed by `std::chrono` in nanoseconds and expressed in cycles of `F_CPU`,
+hence the `ns_per_call` column holds the host time, see
+`host/bench_fastled.cpp`.
+
+The inputs get drawn from FastLED's random generator at a fixed seed, after
+which its seed gets restored, so that the effects keep their own sequence.
+
+Serial command 'k' prints the results as CSV, framed by `# begin` and
+`# end`. `src_python/benchmark_fastled.py` stores them to a file, from the
+mirror or from the host run, and compares them against an earlier file, e.g.
+one of the previous commit. Columns:
+
+  name,calls,cycles_per_call,ns_per_call
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_BENCHMARK_H
+#define DVG_FASTLED_BENCHMARK_H
+
+#include <Arduino.h>
+#ifdef DVG_HOST
+#include <chrono>
+#endif
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+namespace Bench {
+  const uint16_t N_CALLS = 256; // Calls per run
+#ifdef DVG_HOST
+  const uint8_t N_RUNS = 200; // The fastest run gets reported, the host PC
+                              // being busy with more than just this
+#else
+  const uint8_t N_RUNS = 5; // The fastest run gets reported
+#endif
+
+  static uint8_t in8[N_CALLS];   // Pseudo-random inputs
+  static uint16_t in16[N_CALLS]; // Pseudo-random inputs
+  static CRGB in_rgb[N_CALLS];   // Pseudo-random inputs
+  static volatile uint32_t sink;
+
+  inline uint32_t cycles() {
+#if defined(__SAMD51__)
+    return DWT->CYCCNT;
+#elif defined(DVG_HOST)
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+               .count() *
+           (F_CPU / 1000000) / 1000;
+#else
+    return micros() * (F_CPU / 1000000);
+#endif
+  }
+
+  template <typename F> uint32_t run(F body, uint16_t n_calls = N_CALLS) {
+    /* Fewest cycles over `N_RUNS` runs of `n_calls` calls of `body(i)`
+     */
+    uint32_t best = UINT32_MAX;
+    for (uint8_t r = 0; r < N_RUNS; r++) {
+      uint32_t t0 = cycles();
+      for (uint16_t i = 0; i < n_calls; i++) {
+        body(i);
+      }
+      best = min(best, cycles() - t0);
+    }
+    return best;
+  }
+
+  void print_row(Stream *mySerial, const char *name, uint16_t calls,
+                 uint32_t cycles, uint32_t overhead) {
+    float per_call = (float)(cycles > overhead ? cycles - overhead : 0) / calls;
+    mySerial->print(name);
+    mySerial->print(",");
+    mySerial->print(calls);
+    mySerial->print(",");
+    mySerial->print(per_call, 1);
+    mySerial->print(",");
+    mySerial->println(per_call * 1e9f / F_CPU, 1);
+  }
+} // namespace Bench
+
+void benchmark_fastled(Stream *mySerial, CRGB *strip, uint16_t numel) {
+  /* Print the cost per call of the FastLED primitives as CSV. The strip-wide
+  `blur1d()` counts as a single call over `numel` LEDs of `strip`, which gets
+  overwritten.
+  */
+  using namespace Bench;
+  uint32_t overhead;
+  CRGB rgb;
+  CRGBPalette16 palette = RainbowColors_p;
+
+#ifdef __SAMD51__
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+  uint16_t seed = random16_get_seed();
+  random16_set_seed(1337);
+  for (uint16_t i = 0; i < N_CALLS; i++) {
+    in8[i] = random8();
+    in16[i] = random16();
+    in_rgb[i] = CHSV(in8[i], 255, 255);
+  }
+  random16_set_seed(seed);
+  for (uint16_t i = 0; i < numel; i++) {
+    strip[i] = in_rgb[i % N_CALLS];
+  }
+
+  mySerial->println("# begin");
+  mySerial->println("name,calls,cycles_per_call,ns_per_call");
+
+  overhead = run([&](uint16_t i) { sink = in8[i]; });
+  print_row(mySerial, "loop_overhead", N_CALLS, overhead, 0);
+
+  print_row(mySerial, "scale8", N_CALLS, run([&](uint16_t i) {
+              sink = scale8(in8[i], in8[N_CALLS - 1 - i]);
+            }),
+            overhead);
+  print_row(mySerial, "qadd8", N_CALLS, run([&](uint16_t i) {
+              sink = qadd8(in8[i], in8[N_CALLS - 1 - i]);
+            }),
+            overhead);
+  print_row(mySerial, "beatsin8", N_CALLS,
+            run([&](uint16_t i) { sink = beatsin8(in8[i], 0, 255); }),
+            overhead);
+  print_row(mySerial, "sin16", N_CALLS,
+            run([&](uint16_t i) { sink = sin16(in16[i]); }), overhead);
+  print_row(mySerial, "hsv2rgb_rainbow", N_CALLS, run([&](uint16_t i) {
+              hsv2rgb_rainbow(CHSV(in8[i], 255, in8[N_CALLS - 1 - i]), rgb);
+              sink = rgb.r;
+            }),
+            overhead);
+  print_row(mySerial, "ColorFromPalette", N_CALLS, run([&](uint16_t i) {
+              rgb = ColorFromPalette(palette, in8[i], in8[N_CALLS - 1 - i]);
+              sink = rgb.r;
+            }),
+            overhead);
+  print_row(mySerial, "nblend", N_CALLS, run([&](uint16_t i) {
+              rgb = in_rgb[i];
+              nblend(rgb, in_rgb[N_CALLS - 1 - i], in8[i]);
+              sink = rgb.r;
+            }),
+            overhead);
+  print_row(mySerial, "blur1d_strip", 1,
+            run([&](uint16_t) { blur1d(strip, numel, 64); }, 1), 0);
+
+  mySerial->println("# end");
+}
+
+#endif
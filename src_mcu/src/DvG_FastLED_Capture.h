@@ -0,0 +1,235 @@
+/* DvG_FastLED_Capture.h
+
+Capture of every LED frame that gets sent out, over serial to a host PC, to
+see afterwards what the mirror actually showed. Toggled by serial command 'c'.
+
+Each frame of the full strip is taken after the segmenter, encoded against the
+previously captured frame with the codec of `DvG_FastLED_Animation.h`, and
+sent out as a packet together with the effect index, style and timestamp.
+Every `FLC::CAPTURE_KEYFRAME` frames a keyframe gets encoded against black
+instead, so that the host can (re)synchronize after a corrupted packet.
+
+Packet
+------
+  offset  size  field
+  0       2     sync: 0xA5, 0x5A
+  2       1     type: 0x11 KEYFRAME, 0x12 DELTA
+  3       1     sequence number, incrementing by 1 per packet, wrapping
+  4       4     [ms] `millis()` timestamp, uint32 little-endian
+  8       1     effect: playlist index, or 0x80 | `FxOverrideEnum` when
+                overridden
+  9       1     style: `StyleEnum`
+  10      2     payload size `n`, uint16 little-endian
+  12      n     encoded frame
+  12 + n  2     CRC-16/CCITT-FALSE over bytes [2, 12 + n), little-endian
+
+Text printed to `Serial` in between gets skipped by the host decoder,
+`src_python/capture_frames.py`.
+
+Sending
+-------
+`add()` does not write to `Serial`, which could block the render loop when the
+USB host is slow. It queues the packet whole into a ring buffer of
+`FLC::CAPTURE_QUEUE_SIZE` bytes, or drops the frame when it does not fit. A
+dropped frame does not take a sequence number and does not become the
+reference for the next delta, so the host decodes on without a gap.
+`drain()` gets called from the main loop and sends out only as many bytes as
+`Serial` can take without blocking. It reports when no packet is left half
+sent, so that other text output can be held back until then. Text printed
+halfway a packet anyhow corrupts that packet, which the host drops by its CRC
+and recovers from at the next keyframe.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_CAPTURE_H
+#define DVG_FASTLED_CAPTURE_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_Animation.h"
+#include "DvG_FastLED_Stream.h"
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+#define CAPTURE_TYPE_KEYFRAME 0x11
+#define CAPTURE_TYPE_DELTA 0x12
+#define CAPTURE_HEADER_SIZE 12
+#define CAPTURE_FX_OVERRIDE 0x80
+#define CAPTURE_N_STATS 256 // One per value of the effect field
+#define CAPTURE_MAX_PACKET_SIZE                                                \
+  (CAPTURE_HEADER_SIZE + ANIM_MAX_FRAME_SIZE(FLC::N) + 2)
+
+static_assert((FLC::CAPTURE_QUEUE_SIZE & (FLC::CAPTURE_QUEUE_SIZE - 1)) == 0,
+              "FLC::CAPTURE_QUEUE_SIZE must be a power of 2");
+static_assert(FLC::CAPTURE_QUEUE_SIZE > CAPTURE_MAX_PACKET_SIZE,
+              "FLC::CAPTURE_QUEUE_SIZE must hold a packet of the worst case");
+
+class FrameCapture {
+private:
+  bool _active = false;
+  uint8_t _seq = 0;
+  uint16_t _i_frame = 0; // Frames since the last keyframe
+  CRGB _prev[FLC::N];    // Last queued frame
+
+  // Ring buffer of whole packets, waiting to be sent out
+  uint8_t _queue[FLC::CAPTURE_QUEUE_SIZE];
+  uint16_t _head = 0;        // Read position
+  uint16_t _tail = 0;        // Write position
+  uint16_t _packet_left = 0; // Bytes left of the packet being sent out
+  uint32_t _n_dropped = 0;   // Frames dropped because the queue was full
+
+  // Bandwidth statistics per effect
+  uint32_t _n_frames[CAPTURE_N_STATS];
+  uint32_t _n_bytes[CAPTURE_N_STATS];
+
+  uint16_t used() {
+    return (_tail - _head) & (FLC::CAPTURE_QUEUE_SIZE - 1);
+  }
+
+  void put(const uint8_t *data, uint16_t len, uint16_t &crc) {
+    for (uint16_t i = 0; i < len; i++) {
+      crc = crc16_ccitt(crc, data[i]);
+      _queue[_tail] = data[i];
+      _tail = (_tail + 1) & (FLC::CAPTURE_QUEUE_SIZE - 1);
+    }
+  }
+
+public:
+  void start() {
+    fill_solid(_prev, FLC::N, CRGB::Black);
+    memset(_n_frames, 0, sizeof(_n_frames));
+    memset(_n_bytes, 0, sizeof(_n_bytes));
+    _i_frame = 0;
+    _n_dropped = 0;
+    _active = true;
+  }
+
+  void stop() {
+    /* Stop capturing. The packets still queued get sent out by `drain()`.
+     */
+    _active = false;
+  }
+
+  bool is_active() { return _active; }
+
+  void add(const CRGB *frame, uint8_t fx, uint8_t style) {
+    /* To be called once per frame sent out, with the LED data of the full
+    strip. Queues the packet, or drops the frame when the queue is full.
+    */
+    static const CRGB black[FLC::N] = {};
+    static uint8_t enc[ANIM_MAX_FRAME_SIZE(FLC::N)];
+    uint8_t header[CAPTURE_HEADER_SIZE];
+    uint16_t crc = 0xFFFF;
+    uint32_t now = millis();
+
+    if (!_active) {
+      return;
+    }
+
+    bool keyframe = (_i_frame == 0);
+    uint16_t len =
+        anim_encode_frame(frame, keyframe ? black : _prev, FLC::N, enc);
+
+    // One byte stays free to tell a full queue from an empty one
+    if (FLC::CAPTURE_QUEUE_SIZE - 1 - used() < CAPTURE_HEADER_SIZE + len + 2) {
+      _n_dropped++;
+      return;
+    }
+    _i_frame = (_i_frame + 1) % FLC::CAPTURE_KEYFRAME;
+
+    header[0] = STREAM_SYNC_0;
+    header[1] = STREAM_SYNC_1;
+    header[2] = keyframe ? CAPTURE_TYPE_KEYFRAME : CAPTURE_TYPE_DELTA;
+    header[3] = _seq++;
+    header[4] = now;
+    header[5] = now >> 8;
+    header[6] = now >> 16;
+    header[7] = now >> 24;
+    header[8] = fx;
+    header[9] = style;
+    header[10] = len;
+    header[11] = len >> 8;
+
+    put(header, 2, crc);
+    crc = 0xFFFF;
+    put(&header[2], CAPTURE_HEADER_SIZE - 2, crc);
+    put(enc, len, crc);
+    const uint8_t crc_le[2] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+    put(crc_le, 2, crc);
+    memcpy8(_prev, frame, FLC::N * sizeof(CRGB));
+
+    _n_frames[fx]++;
+    _n_bytes[fx] += CAPTURE_HEADER_SIZE + len + 2;
+  }
+
+  bool drain(Stream *mySerial) {
+    /* Send out as many queued bytes as `mySerial` takes without blocking. To
+    be called once per loop iteration. Returns true when no packet is left
+    half sent.
+    */
+    int n_free = mySerial->availableForWrite();
+
+    while (used() && (n_free > 0)) {
+      if (_packet_left == 0) {
+        // At the start of a packet, read its size from the header
+        uint16_t len = _queue[(_head + 10) & (FLC::CAPTURE_QUEUE_SIZE - 1)] |
+                       _queue[(_head + 11) & (FLC::CAPTURE_QUEUE_SIZE - 1)]
+                           << 8;
+        _packet_left = CAPTURE_HEADER_SIZE + len + 2;
+      }
+
+      // Contiguous run up to the end of the packet or of the ring buffer
+      uint16_t n = min(_packet_left,
+                       (uint16_t)(FLC::CAPTURE_QUEUE_SIZE - _head));
+      n = min((int)n, n_free);
+      n = mySerial->write(&_queue[_head], n);
+      if (n == 0) {
+        break;
+      }
+      _head = (_head + n) & (FLC::CAPTURE_QUEUE_SIZE - 1);
+      _packet_left -= n;
+      n_free -= n;
+    }
+    return _packet_left == 0;
+  }
+
+  void flush(Stream *mySerial) {
+    /* Send out all queued packets, blocking
+     */
+    while (used()) {
+      drain(mySerial);
+    }
+  }
+
+  void print_bandwidth(Stream *mySerial) {
+    /* Print the average number of bytes per captured frame for each effect,
+    with the overrides marked by '*'
+    */
+    mySerial->println("Capture bandwidth [bytes/frame] per effect");
+    for (uint16_t i = 0; i < CAPTURE_N_STATS; i++) {
+      if (_n_frames[i] == 0) {
+        continue;
+      }
+      mySerial->print("  ");
+      if (i & CAPTURE_FX_OVERRIDE) {
+        mySerial->print("*");
+      }
+      mySerial->print(i & ~CAPTURE_FX_OVERRIDE);
+      mySerial->print(": ");
+      mySerial->print((float)_n_bytes[i] / _n_frames[i]);
+      mySerial->print(" over ");
+      mySerial->print(_n_frames[i]);
+      mySerial->println(" frames");
+    }
+    mySerial->print("  Raw: ");
+    mySerial->println(CAPTURE_HEADER_SIZE + 3 * FLC::N + 2);
+    mySerial->print("  Dropped, queue full: ");
+    mySerial->print(_n_dropped);
+    mySerial->println(" frames");
+  }
+};
+
+FrameCapture frame_capture;
+
+#endif
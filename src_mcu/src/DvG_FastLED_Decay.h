@@ -0,0 +1,151 @@
+/* DvG_FastLED_Decay.h
+
+Frame-rate independent exponential fading of trails and snapshots.
+
+A fade used to be written as
+
+  EVERY_N_MILLIS(10) {
+    fadeToBlackBy(fx1, s1, 14);
+  }
+
+which quantizes the decay to 10 ms ticks, stutters when a frame overruns and
+changes the look when the effect gets calculated at a different rate. Instead,
+declare a `FastLED_Decay` with the same fade amount and tick, and apply it
+every time the effect gets calculated:
+
+  static FastLED_Decay decay_fx1(14); // 14/256 per 10 ms
+  decay_fx1.apply(fx1, s1);
+
+The time elapsed since the last calculated frame, `fx_dt`, is set by the
+effect manager. It gets looked up in a table of 0.16 fixed-point scale factors,
+precomputed per fade amount for every `dt` up to `FLC::DECAY_LUT_SIZE` ms. The
+scale is accumulated until it amounts to at least one tick of the original
+fade, or one 8-bit step, and then gets applied in a single `nscale8()` pass.
+The remainder of the 8-bit rounding is carried over to the next pass, so that
+the decay rate is exact over time at any frame rate.
+
+At 100 FPS this reproduces the original ticks exactly, and above it the
+decay follows the original within a few steps of 8 bits. Below 100 FPS, `fx_dt`
+gets taken in chunks of at most one tick, each with a pass of its own, so that
+it reproduces the original exactly as well. A single pass over several ticks
+would truncate less than the separate ticks did, and the slowest fades, e.g.
+1/256, would linger near the dim end, as `fadeToBlackBy(..., 1)` is
+effectively a linear fade of 1 step per tick there. The equivalence at 50,
+100 and 250 FPS is checked by `host/decay_check.cpp`.
+
+Timers
+------
+Likewise, `EVERY_N_MILLIS(20)` fires at the first calculated frame at least
+20 ms after it last fired, and starts its next period from there. The overshoot
+gets lost each time, so at 4 ms frames it fires every 20 to 24 ms and the
+effect runs slow. `FastLED_Ticker` keeps the overshoot, counting whole periods
+in the accumulated `fx_dt`:
+
+  static FastLED_Ticker tick(20);
+  for (uint16_t n = tick.ticks(); n; n--) {
+    mu += .4;
+  }
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_DECAY_H
+#define DVG_FASTLED_DECAY_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+// Globally set by `DvG_FastLED_EffectManager.h`
+uint32_t fx_dt = 0; // [ms] Time since the effect was last calculated
+
+class FastLED_Decay {
+private:
+  uint16_t _lut[FLC::DECAY_LUT_SIZE]; // 0.16 fixed-point scale per dt [ms]
+  uint32_t _pending = 65536;          // 0.16 fixed-point scale to be applied
+  uint32_t _threshold;                // Apply once `_pending` drops to this
+  uint8_t _fade = 0;                  // Fade amount per tick, out of 256
+  uint16_t _tick = 0;                 // [ms]
+
+public:
+  FastLED_Decay(uint8_t fade, uint16_t tick = 10) {
+    /* Fade by `fade`/256 every `tick` ms, like `fadeToBlackBy(..., fade)`.
+    The tick must lie within [1, `FLC::DECAY_LUT_SIZE`) ms.
+    */
+    set_fade(fade, tick);
+  }
+
+  void set_fade(uint8_t fade, uint16_t tick = 10) {
+    /* Recomputes the table only when the fade has changed
+     */
+    if ((fade == _fade) & (tick == _tick)) {
+      return;
+    }
+    _fade = fade;
+    _tick = constrain(tick, 1, FLC::DECAY_LUT_SIZE - 1);
+    _threshold = min((uint32_t)(256 - fade) << 8, (uint32_t)255 << 8);
+
+    float per_ms = powf((256 - fade) / 256.f, 1.f / _tick);
+    float scale = 1.f;
+    for (uint8_t dt = 0; dt < FLC::DECAY_LUT_SIZE; dt++) {
+      _lut[dt] = min((uint32_t)(scale * 65536 + .5f), (uint32_t)65535);
+      scale *= per_ms;
+    }
+  }
+
+  uint8_t advance(uint32_t dt) {
+    /* Accumulate the decay over `dt` ms, at most one tick, and return the
+    `nscale8()` scale to apply now, or 255 when nothing has to be applied yet
+    */
+    if (dt) {
+      _pending = ((uint64_t)_pending * _lut[dt]) >> 16;
+    }
+    if (_pending > _threshold) {
+      return 255;
+    }
+
+    // `nscale8()` scales by (scale + 1) / 256. Round to the nearest step and
+    // carry the remainder over, which can be slightly above 1.
+    uint32_t step = max((_pending + 128) >> 8, (uint32_t)1);
+    _pending = (_pending << 8) / step;
+    return step - 1;
+  }
+
+  void apply(CRGB *leds, uint16_t numel) {
+    /* To be called once every time the effect gets calculated. Takes `fx_dt`
+    in chunks of at most one tick.
+    */
+    uint32_t dt = fx_dt;
+
+    do {
+      uint32_t chunk = min(dt, (uint32_t)_tick);
+      uint8_t scale = advance(chunk);
+      if (scale < 255) {
+        nscale8(leds, numel, scale);
+      }
+      dt -= chunk;
+    } while (dt);
+  }
+};
+
+class FastLED_Ticker {
+private:
+  uint32_t _elapsed = 0; // [ms] Accumulated `fx_dt` not yet ticked off
+  uint16_t _period;      // [ms]
+
+public:
+  FastLED_Ticker(uint16_t period) : _period{period} {}
+
+  uint16_t ticks() {
+    /* Return the number of whole periods elapsed since the last call. To be
+    called once every time the effect gets calculated.
+    */
+    _elapsed += fx_dt;
+    uint16_t n = _elapsed / _period;
+    _elapsed -= n * _period;
+    return n;
+  }
+};
+
+#endif
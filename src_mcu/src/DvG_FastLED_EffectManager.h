@@ -9,7 +9,7 @@ Dennis van Gils
 #define DVG_FASTLED_EFFECTMANAGER_H
 
 #include <Arduino.h>
-#include <vector>
+#include <array>
 
 #include "FastLED.h"
 #include "FiniteStateMachine.h"
@@ -17,6 +17,7 @@ Dennis van Gils
 #include "DvG_FastLED_StripSegmenter.h"
 #include "DvG_FastLED_config.h"
 #include "DvG_FastLED_effects.h"
+#include "DvG_Logger.h"
 
 using namespace std;
 
@@ -26,6 +27,8 @@ enum FxOverrideEnum {
   ALL_WHITE,                  // Override: Turn all leds to white
   IR_DIST,                    // Override: Show IR distance test
   TEST_PATTERN,               // Override: Show test pattern
+  PLAYBACK,                   // Override: Play the animation recording
+  STREAM,                     // Override: Show frames streamed by a host PC
   SLEEP_AND_WAIT_FOR_AUDIENCE // Override
 };
 
@@ -35,17 +38,153 @@ enum FxOverrideEnum {
 
 struct FX_preset {
   // Constructors
-  FX_preset(State _fx) : fx{_fx} {}
-  FX_preset(State _fx, uint32_t _duration) : fx{_fx}, duration{_duration} {}
-  FX_preset(State _fx, StyleEnum _style) : fx{_fx}, style{_style} {}
-  FX_preset(State _fx, StyleEnum _style, uint32_t _duration)
-      : fx{_fx}, style{_style}, duration{_duration} {}
+  constexpr FX_preset() {}
+  constexpr FX_preset(State &_fx) : fx{&_fx} {}
+  constexpr FX_preset(State &_fx, uint32_t _duration)
+      : fx{&_fx}, duration{_duration} {}
+  constexpr FX_preset(State &_fx, StyleEnum _style) : fx{&_fx}, style{_style} {}
+  constexpr FX_preset(State &_fx, StyleEnum _style, uint32_t _duration)
+      : fx{&_fx}, style{_style}, duration{_duration} {}
+  constexpr FX_preset(State &_fx, StyleEnum _style, uint32_t _duration,
+                      uint16_t _render_rate)
+      : fx{&_fx}, style{_style}, duration{_duration},
+        render_rate{_render_rate} {}
+  constexpr FX_preset(State &_fx, StyleEnum _style, uint32_t _duration,
+                      uint16_t _render_rate, uint8_t _qos)
+      : fx{&_fx}, style{_style}, duration{_duration},
+        render_rate{_render_rate}, qos{_qos} {}
+  constexpr FX_preset(State &_fx, StyleEnum _style, uint32_t _duration,
+                      uint16_t _render_rate, uint8_t _qos, uint16_t _min_rate)
+      : fx{&_fx}, style{_style}, duration{_duration},
+        render_rate{_render_rate}, qos{_qos}, min_rate{_min_rate} {}
+
+  // Layered presets, see `DvG_FastLED_Layers.h`. The style gets ignored.
+  template <size_t N>
+  constexpr FX_preset(const std::array<FX_layer, N> &_layers,
+                      uint32_t _duration)
+      : fx{&fx__Layers}, duration{_duration}, layers{&_layers[0]},
+        n_layers{N} {}
+  template <size_t N>
+  constexpr FX_preset(const std::array<FX_layer, N> &_layers,
+                      uint32_t _duration, uint16_t _render_rate)
+      : fx{&fx__Layers}, duration{_duration}, render_rate{_render_rate},
+        layers{&_layers[0]}, n_layers{N} {}
+  template <size_t N>
+  constexpr FX_preset(const std::array<FX_layer, N> &_layers,
+                      uint32_t _duration, uint16_t _render_rate, uint8_t _qos)
+      : fx{&fx__Layers}, duration{_duration}, render_rate{_render_rate},
+        qos{_qos}, layers{&_layers[0]}, n_layers{N} {}
 
   // Members and defaults
-  State fx{fx__FadeToBlack};
+  State *fx{nullptr};
   StyleEnum style{StyleEnum::FULL_STRIP};
   uint32_t duration{
       0}; // 0 indicates infinite duration or until effect is done otherwise
+  uint16_t render_rate{
+      0}; // [Hz] 0 indicates calculating the effect every output frame
+  uint8_t qos{QOS_GENERIC}; // Allowed quality degradations, `QosFlags`
+  uint16_t min_rate{
+      FLC::QOS_RENDER_RATE}; // [Hz] Lowest render rate of `QOS_HALF_RATE`
+  const FX_layer *layers{nullptr}; // Layers of `fx__Layers`, in flash
+  uint8_t n_layers{0};
+};
+
+/*------------------------------------------------------------------------------
+  FX playlist
+
+  Non-owning view on a list of FX presets. Declare the list itself as a
+  `constexpr std::array<FX_preset, ...>` so that it resides in flash and costs
+  no RAM, and validate it at compile time using `is_valid_playlist()`:
+
+    constexpr std::array<FX_preset, 2> my_list = {{
+      FX_preset(fx__Rainbow, StyleEnum::FULL_STRIP, 8000),
+      FX_preset(fx__FadeToBlack, 0),
+    }};
+    static_assert(is_valid_playlist(my_list), "Invalid FX playlist");
+
+  Switching between stored playlists is O(1), see
+  `FastLED_EffectManager::set_fx_list()`.
+------------------------------------------------------------------------------*/
+
+// Allowed range of non-zero preset durations
+constexpr uint32_t FX_MIN_DURATION = 1000;   // [ms]
+constexpr uint32_t FX_MAX_DURATION = 600000; // [ms]
+
+// Allowed range of non-zero preset render rates
+constexpr uint16_t FX_MIN_RENDER_RATE = 10;                    // [Hz]
+constexpr uint16_t FX_MAX_RENDER_RATE = FLC::MAX_REFRESH_RATE; // [Hz]
+
+template <size_t N>
+constexpr bool is_valid_playlist(const std::array<FX_preset, N> &list) {
+  /* Return true when all presets have an effect assigned, a valid style, a
+  duration of either 0 (infinite) or inside [FX_MIN_DURATION, FX_MAX_DURATION]
+  and a render rate of either 0 (every output frame) or inside
+  [FX_MIN_RENDER_RATE, FX_MAX_RENDER_RATE], known quality degradations, a
+  minimum render rate inside that same range and, when layered, at most
+  `FX_MAX_LAYERS` valid layers
+  */
+  if (N == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < N; i++) {
+    if (list[i].fx == nullptr) {
+      return false;
+    }
+    if (list[i].style >= StyleEnum::EOL) {
+      return false;
+    }
+    if (list[i].duration &&
+        ((list[i].duration < FX_MIN_DURATION) |
+         (list[i].duration > FX_MAX_DURATION))) {
+      return false;
+    }
+    if (list[i].render_rate &&
+        ((list[i].render_rate < FX_MIN_RENDER_RATE) |
+         (list[i].render_rate > FX_MAX_RENDER_RATE))) {
+      return false;
+    }
+    if (list[i].qos & ~QOS_ALL) {
+      return false;
+    }
+    if ((list[i].min_rate < FX_MIN_RENDER_RATE) |
+        (list[i].min_rate > FX_MAX_RENDER_RATE)) {
+      return false;
+    }
+    if (list[i].n_layers > FX_MAX_LAYERS) {
+      return false;
+    }
+    for (uint8_t l = 0; l < list[i].n_layers; l++) {
+      const FX_layer &layer = list[i].layers[l];
+      if ((layer.pattern == nullptr) | (layer.style >= StyleEnum::EOL) |
+          (layer.mode >= BLEND_EOL) | (layer.shift >= FLC::N)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+class FX_playlist {
+private:
+  const FX_preset *_presets;
+  uint16_t _size;
+
+public:
+  template <size_t N>
+  constexpr FX_playlist(const std::array<FX_preset, N> &list)
+      : _presets{&list[0]}, _size{N} {}
+
+  constexpr const FX_preset &operator[](uint16_t idx) const {
+    return _presets[idx];
+  }
+
+  constexpr uint16_t size() const {
+    return _size;
+  }
+
+  constexpr bool operator==(const FX_playlist &other) const {
+    return _presets == other._presets;
+  }
 };
 
 /*------------------------------------------------------------------------------
@@ -57,34 +196,236 @@ struct FX_preset {
 class FastLED_EffectManager {
 private:
   uint16_t _fx_idx = 0;
-  std::vector<FX_preset> _fx_list;
+  FX_playlist _fx_list;
   bool _fx_has_changed = true;
   FxOverrideEnum _fx_override = FxOverrideEnum::NONE;
 
+  // Standby
+  bool _standby = false;          // Currently in standby?
+  bool _wake_pending = false;     // Woken up, but no LED frame sent out yet?
+  uint32_t _t_wake = 0;           // [us] `micros()` at waking up
+  uint32_t _sleep_latency_us = 0; // [us] Black frame reached -> standby
+  uint32_t _wake_latency_us = 0;  // [us] Wake up -> first LED frame sent
+
+  // Temporal upsampling, see `update()`
+  CRGB _key_prev[FLC::N];   // Second to last calculated keyframe
+  CRGB _key_cur[FLC::N];    // Last calculated keyframe
+  bool _key_valid = false;  // Keyframes hold the current effect?
+  uint32_t _t_key = 0;      // [us] `micros()` at the last keyframe
+  uint32_t _n_frames = 0;   // Output frames of the current effect
+  uint32_t _n_renders = 0;  // Calculated frames of the current effect
+  uint32_t _render_us = 0;  // [us] Total time calculating the effect
+  uint32_t _interp_us = 0;  // [us] Total time interpolating
+  uint32_t _t_calc = 0;     // [ms] `millis()` at the last calculated frame
+
+  // Quality-of-service governor, see `govern()`
+  uint8_t _qos_level = 0;        // Number of degradations in effect
+  uint32_t _cost = 0;            // [us] Time spent in the last `update()`
+  uint32_t _cost_ema = 0;        // [us] Effect cost per frame, moving average
+  uint16_t _qos_n_over = 0;      // Consecutive frames over budget
+  uint16_t _qos_n_under = 0;     // Consecutive frames with headroom
+  uint16_t _qos_n_settle = 0;    // Frames since the last degradation
+  uint32_t _qos_cost_hi = 0;     // [us] Effect cost right before it
+  uint16_t _qos_gain[QOS_N + 1]; // 8.8 fixed-point cost ratio per level
+
   // Finite State Machine governing the FastLED effect calculation
   FSM _fsm_fx = FSM(fx__FadeToBlack);
 
+  void calculate_fx() {
+    /* Run the effect, telling it the time elapsed since its last run in
+    `fx_dt`, see `DvG_FastLED_Decay.h`
+    */
+    uint32_t now = millis();
+    fx_dt = min(now - _t_calc, (uint32_t)FLC::DECAY_MAX_DT);
+    _t_calc = now;
+    _fsm_fx.update();
+  }
+
+  uint8_t qos_flags(uint8_t level) {
+    /* Return the first `level` degradations allowed by the current preset.
+    `QOS_HALF_RATE` counts only when it would lower the render rate.
+     */
+    uint8_t allowed = _fx_override ? 0 : _fx_list[_fx_idx].qos;
+    uint8_t flags = 0;
+    if (half_rate(_fx_list[_fx_idx]) == _fx_list[_fx_idx].render_rate) {
+      allowed &= ~QOS_HALF_RATE;
+    }
+    for (uint8_t bit = 1; level && (bit & QOS_ALL); bit <<= 1) {
+      if (allowed & bit) {
+        flags |= bit;
+        level--;
+      }
+    }
+    return flags;
+  }
+
+  static uint16_t half_rate(const FX_preset &preset) {
+    /* Return the render rate of `preset` under `QOS_HALF_RATE`: half its
+    render rate, or `min_rate` when rendering every output frame, but never
+    below `min_rate`. Returns the render rate itself when already at or below
+    `min_rate`.
+    */
+    uint16_t rate = preset.render_rate;
+    if (rate == 0) {
+      return preset.min_rate;
+    }
+    return rate > preset.min_rate ? max((uint16_t)(rate / 2), preset.min_rate)
+                                  : rate;
+  }
+
+  void set_qos_level(uint8_t level) {
+    _qos_level = level;
+    fx_qos = qos_flags(level);
+    FastLED.setDither((fx_qos & QOS_NO_DITHER) ? DISABLE_DITHER
+                                               : BINARY_DITHER);
+    _qos_n_over = 0;
+    _qos_n_under = 0;
+    _qos_n_settle = 0;
+  }
+
+  void govern() {
+    /* Quality-of-service governor. Degrades the quality of the current effect
+    one level at a time when its cost per output frame, i.e. the time spent
+    in `update()`, stays above the budget: the frame period of
+    `FLC::QOS_MIN_FPS` minus `FLC::QOS_SHOW_US` for the rest of the loop.
+    Below 100 FPS FastLED would otherwise silently turn off dithering, on top
+    of the stuttering. Governing on the effect cost instead of on the loop
+    period keeps the rest of the loop, like serial commands, standby or
+    `show()` waiting for the refresh rate cap, from degrading the effect.
+
+    The gain of each degradation is measured once it has settled, as the
+    ratio of the effect costs before and after. A level gets restored when
+    the effect cost scaled back by that gain fits the budget with 1/8 to
+    spare, for `FLC::QOS_RESTORE` frames on end. This prevents oscillating
+    between levels, also when the load itself changes in between.
+    */
+    const uint32_t budget =
+        1000000UL / FLC::QOS_MIN_FPS - FLC::QOS_SHOW_US; // [us]
+    // Exponential moving average over ~8 frames, clipping outliers like the
+    // first frame of an effect
+    uint32_t cost = min(_cost, 4 * budget);
+    _cost_ema = _cost_ema - (_cost_ema >> 3) + (cost >> 3);
+
+    uint8_t max_level = __builtin_popcount(qos_flags(QOS_N));
+    if (_qos_level && (_qos_n_settle < FLC::QOS_HOLD)) {
+      if (++_qos_n_settle == FLC::QOS_HOLD) {
+        _qos_gain[_qos_level] =
+            min((_qos_cost_hi << 8) / max(_cost_ema, (uint32_t)1),
+                (uint32_t)0xFFFF);
+      }
+      return;
+    }
+
+    if (_cost_ema > budget) {
+      _qos_n_under = 0;
+      if ((_qos_level < max_level) && (++_qos_n_over >= FLC::QOS_HOLD)) {
+        _qos_cost_hi = _cost_ema;
+        set_qos_level(_qos_level + 1);
+        Log::log(LOG_QOS, _qos_level, max_level, _cost_ema);
+      }
+    } else if (_qos_level) {
+      _qos_n_over = 0;
+      uint32_t predicted = (_cost_ema * _qos_gain[_qos_level]) >> 8;
+      if (predicted < budget - budget / 8) {
+        if (++_qos_n_under >= FLC::QOS_RESTORE) {
+          set_qos_level(_qos_level - 1);
+          _qos_n_settle = FLC::QOS_HOLD; // Gain of the lower level is known
+          Log::log(LOG_QOS, _qos_level, max_level, _cost_ema);
+        }
+      } else {
+        _qos_n_under = 0;
+      }
+    } else {
+      _qos_n_over = 0;
+    }
+  }
+
 public:
-  FastLED_EffectManager(std::vector<FX_preset> fx_list) {
+  FastLED_EffectManager(FX_playlist fx_list) : _fx_list{fx_list} {
     /* Constructor, initialized with a presets list of FastLED effects to run
      */
-    _fx_list = fx_list;
-    _fsm_fx.immediateTransitionTo(_fx_list[_fx_idx].fx);
+    _fsm_fx.immediateTransitionTo(*_fx_list[_fx_idx].fx);
     fx_style = _fx_list[_fx_idx].style;
     fx_duration = _fx_list[_fx_idx].duration;
+    fx_layers = _fx_list[_fx_idx].layers;
+    fx_n_layers = _fx_list[_fx_idx].n_layers;
   }
 
-  void set_fx_list(std::vector<FX_preset> fx_list) {
-    /* Dynamically change the presets list of FastLED effects to run
+  void set_fx_list(FX_playlist fx_list) {
+    /* Dynamically change the presets list of FastLED effects to run. O(1), as
+    only the view on the list stored in flash gets swapped.
      */
     _fx_list = fx_list;
     set_fx(_fx_idx); // Assume we are already running, hence play it safe
   }
 
+  FX_playlist fx_list() {
+    return _fx_list;
+  }
+
   void update() {
-    /* Calculate the current FastLED effect
-     */
-    _fsm_fx.update();
+    /* Calculate the current FastLED effect into `leds`.
+
+    Presets with a non-zero render rate get calculated at that rate only. The
+    output frames in between get linearly interpolated from the last two
+    calculated keyframes, using an 8-bit fixed-point weight. The CPU time
+    spent on the effect then scales with the render rate, while the motion
+    stays smooth at the output frame rate. The price is a latency of one
+    render period. Overrides always get calculated every output frame.
+
+    The effects carry their state over in `leds`, hence `leds` gets restored
+    to the last keyframe right before the effect is calculated again.
+
+    NOTE: Timers inside the effect, like `EVERY_N_MILLIS()`, can fire only
+    once per calculated frame and lose the overshoot each time. Keep their
+    periods well above the render period, or use `FastLED_Ticker` instead.
+    Fades are best done by `FastLED_Decay`. Both are independent of the rate.
+    The gain and error per render rate are measured by
+    `host/bench_render_rate.cpp`.
+    */
+    uint16_t rate = _fx_override ? 0 : _fx_list[_fx_idx].render_rate;
+    uint32_t t0 = micros();
+
+    govern();
+    if (fx_qos & QOS_HALF_RATE) {
+      rate = half_rate(_fx_list[_fx_idx]);
+    }
+
+    _n_frames++;
+    if (rate == 0) {
+      calculate_fx();
+      _n_renders++;
+      _cost = micros() - t0;
+      _render_us += _cost;
+      _key_valid = false;
+      return;
+    }
+
+    uint32_t period = 1000000UL / rate; // [us]
+    if (!_key_valid || (t0 - _t_key >= period)) {
+      if (_key_valid) {
+        memcpy8(leds, _key_cur, sizeof(_key_cur));
+      }
+      calculate_fx();
+      memcpy8(_key_prev, _key_valid ? _key_cur : leds, sizeof(_key_prev));
+      memcpy8(_key_cur, leds, sizeof(_key_cur));
+
+      // Stay on the render grid, unless we fell behind by more than a period
+      if (_key_valid && (t0 - _t_key < 2 * period)) {
+        _t_key += period;
+      } else {
+        _t_key = t0;
+      }
+      _key_valid = true;
+      _n_renders++;
+    }
+
+    uint32_t t1 = micros();
+    fract8 weight = (uint32_t)(t0 - _t_key) * 256 / period;
+    blend(_key_prev, _key_cur, leds, FLC::N, weight);
+    _cost = micros() - t0;
+    _interp_us += _cost - (t1 - t0);
+    _render_us += t1 - t0;
   }
 
   uint32_t time_in_current_fx() {
@@ -139,6 +480,14 @@ public:
         _fsm_fx.transitionTo(fx__TestPattern);
         fx_duration = 0;
         break;
+      case FxOverrideEnum::PLAYBACK:
+        _fsm_fx.transitionTo(fx__Playback);
+        fx_duration = 0;
+        break;
+      case FxOverrideEnum::STREAM:
+        _fsm_fx.transitionTo(fx__Stream);
+        fx_duration = 0;
+        break;
       case FxOverrideEnum::SLEEP_AND_WAIT_FOR_AUDIENCE:
         _fsm_fx.transitionTo(fx__SleepAndWaitForAudience);
         fx_duration = 0;
@@ -149,16 +498,50 @@ public:
         break;
     }
     _fx_has_changed = true;
+    reset_render_stats();
+    reset_qos();
   }
 
   void set_fx(uint16_t idx) {
     _fx_override = FxOverrideEnum::NONE;
-    _fx_idx = min(idx, _fx_list.size() - 1);
-    _fsm_fx.transitionTo(_fx_list[_fx_idx].fx);
+    _fx_idx = min(idx, (uint16_t)(_fx_list.size() - 1));
+    _fsm_fx.transitionTo(*_fx_list[_fx_idx].fx);
     _fx_has_changed = true;
+    reset_render_stats();
+    reset_qos();
 
     fx_style = _fx_list[_fx_idx].style;
     fx_duration = _fx_list[_fx_idx].duration;
+    fx_layers = _fx_list[_fx_idx].layers;
+    fx_n_layers = _fx_list[_fx_idx].n_layers;
+  }
+
+  void reset_render_stats() {
+    /* Also forces the next `update()` to calculate a fresh keyframe
+     */
+    _key_valid = false;
+    _n_frames = 0;
+    _n_renders = 0;
+    _render_us = 0;
+    _interp_us = 0;
+  }
+
+  void reset_qos() {
+    /* Start the current effect at full quality
+     */
+    _cost = 0;
+    _cost_ema = 0;
+    set_qos_level(0);
+  }
+
+  uint8_t qos_level() {
+    return _qos_level;
+  }
+
+  uint32_t fx_cost_us() {
+    /* Return the effect cost per output frame [us] as governed by `govern()`
+     */
+    return _cost_ema;
   }
 
   void prev_fx() {
@@ -177,42 +560,103 @@ public:
     segmntr1.next_style();
   }
 
+  /*----------------------------------------------------------------------------
+    Standby
+
+    `SleepAndWaitForAudience` signals when it has faded to black. From then on
+    the main loop can go into standby: Stop sending out LED data, lower the
+    core clock and sample the IR distance sensor at a reduced rate.
+  ----------------------------------------------------------------------------*/
+
+  bool standby_requested() {
+    return fx_standby_ready & !_standby &
+           (_fx_override == FxOverrideEnum::SLEEP_AND_WAIT_FOR_AUDIENCE);
+  }
+
+  bool in_standby() {
+    return _standby;
+  }
+
+  void enter_standby() {
+    _standby = true;
+    _sleep_latency_us = micros() - fx_standby_t0;
+  }
+
+  void exit_standby() {
+    if (_standby) {
+      _standby = false;
+      _wake_pending = true;
+      _t_wake = micros();
+    }
+  }
+
+  void frame_sent() {
+    /* To be called after LED data has been sent out, to time the wake latency
+     */
+    if (_wake_pending) {
+      _wake_pending = false;
+      _wake_latency_us = micros() - _t_wake;
+    }
+  }
+
+  uint32_t sleep_latency_us() {
+    return _sleep_latency_us;
+  }
+
+  uint32_t wake_latency_us() {
+    return _wake_latency_us;
+  }
+
   /*----------------------------------------------------------------------------
     Prints
   ----------------------------------------------------------------------------*/
 
-  void print_fx(Stream *stream) {
+  void print_fx() {
     // NOTE: `_fsm_fx.update()` must have run to print out the proper name
-#ifdef USE_ANSI
-    ansi.foreground(ANSI::yellow);
-#endif
-    stream->print("Effect: ");
     if (_fx_override == FxOverrideEnum::NONE) {
-      stream->print(_fx_idx);
+      Log::log(LOG_FX, _fx_idx, _fsm_fx.getCurrentStateName());
     } else {
-      stream->print("*");
+      Log::log(LOG_FX_OVERRIDE, _fsm_fx.getCurrentStateName());
     }
-    stream->print(" - \"");
-    stream->print(_fsm_fx.getCurrentStateName());
-    stream->println("\"");
-#ifdef USE_ANSI
-    ansi.normal();
-#endif
   }
 
-  void print_style(Stream *stream) {
-    static char buffer[STYLE_NAME_LEN] = {"\0"};
-    segmntr1.get_style_name(buffer);
-#ifdef USE_ANSI
-    ansi.foreground(ANSI::white | ANSI::bright);
-#endif
-    stream->print("Style : ");
-    stream->print((int)segmntr1.get_style());
-    stream->print(" - ");
-    stream->println(buffer);
-#ifdef USE_ANSI
-    ansi.normal();
-#endif
+  void print_style() {
+    StyleEnum style = segmntr1.get_style();
+    Log::log(LOG_STYLE, (int)style, style_names[style]);
+  }
+
+  void print_render_stats(Stream *mySerial) {
+    /* Print the CPU time spent on the current effect per output frame, what
+    it would have cost when calculated every output frame, and its quality
+    level
+    */
+    if ((_n_frames == 0) | (_n_renders == 0)) {
+      return;
+    }
+    float render_us = (float)_render_us / _n_renders;
+    float frame_us = (float)(_render_us + _interp_us) / _n_frames;
+
+    mySerial->print("Render rate [Hz]      : ");
+    mySerial->println(_fx_override ? 0 : _fx_list[_fx_idx].render_rate);
+    mySerial->print("  Frames out/rendered : ");
+    mySerial->print(_n_frames);
+    mySerial->print(" / ");
+    mySerial->println(_n_renders);
+    mySerial->print("  Render       [us]   : ");
+    mySerial->println(render_us);
+    mySerial->print("  Interpolate  [us]   : ");
+    mySerial->println((float)_interp_us / _n_frames);
+    mySerial->print("  Per frame    [us]   : ");
+    mySerial->print(frame_us);
+    mySerial->print(", x");
+    mySerial->print(render_us / frame_us);
+    mySerial->println(" cheaper");
+    mySerial->print("  Quality level       : ");
+    mySerial->print(_qos_level);
+    mySerial->print(" of ");
+    mySerial->println(__builtin_popcount(qos_flags(QOS_N)));
+    mySerial->print("  Effect cost  [us]   : ");
+    mySerial->println(_cost_ema);
   }
 };
 
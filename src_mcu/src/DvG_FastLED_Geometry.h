@@ -0,0 +1,153 @@
+/* DvG_FastLED_Geometry.h
+
+Describes the geometry of the mirror: A rectangle of `width` x `height` LEDs,
+optionally repeated over several panels that are chained one after another.
+
+The LED data arrays of the full strip, like `leds`, are kept in the canonical,
+logical order of each panel: starting at the bottom-left corner and running
+counter-clockwise. Sides are indexed 0: bottom, 1: right, 2: top, 3: left.
+
+            width
+        ┌────<────┐
+        │    2    │
+ height v 3     1 ^ height
+        │    0    │
+        0────>────┘
+            width
+
+The physical wiring of the strip can start at any corner and run in either
+direction. When it differs from the canonical order, `to_physical()` reorders
+the logical LED data into the physical order just before sending it out.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_GEOMETRY_H
+#define DVG_FASTLED_GEOMETRY_H
+
+#include <stdint.h>
+
+enum class StartCorner : uint8_t {
+  BOTTOM_LEFT,
+  BOTTOM_RIGHT,
+  TOP_RIGHT,
+  TOP_LEFT
+};
+
+enum class Winding : uint8_t {
+  CCW, // Counter-clockwise: bottom -> right -> top -> left
+  CW   // Clockwise: left -> top -> right -> bottom
+};
+
+struct XY16 {
+  uint16_t x; // [1/256 LED pitch], 8.8 fixed point
+  uint16_t y; // [1/256 LED pitch], 8.8 fixed point
+};
+
+struct Geometry {
+  uint16_t width;     // Number of LEDs along the bottom and top sides
+  uint16_t height;    // Number of LEDs along the right and left sides
+  StartCorner start;  // Corner at which the physical strip starts
+  Winding winding;    // Direction in which the physical strip runs
+  uint8_t n_panels;   // Number of chained panels
+
+  constexpr Geometry(uint16_t _width, uint16_t _height,
+                     StartCorner _start = StartCorner::BOTTOM_LEFT,
+                     Winding _winding = Winding::CCW, uint8_t _n_panels = 1)
+      : width{_width}, height{_height}, start{_start}, winding{_winding},
+        n_panels{_n_panels} {}
+
+  constexpr uint16_t side(uint8_t side_idx) const {
+    // Number of LEDs of side [0: bottom, 1: right, 2: top, 3: left]
+    return side_idx % 2 ? height : width;
+  }
+
+  constexpr uint16_t side_start(uint8_t side_idx) const {
+    // Logical index of the first LED of a side, inside a panel
+    return (side_idx == 0)   ? 0
+           : (side_idx == 1) ? width
+           : (side_idx == 2) ? width + height
+                             : 2 * width + height;
+  }
+
+  constexpr uint16_t perimeter() const {
+    // Number of LEDs of a single panel
+    return 2 * (width + height);
+  }
+
+  constexpr uint32_t numel() const {
+    // Number of LEDs of the full strip, all panels included
+    return (uint32_t)perimeter() * n_panels;
+  }
+
+  constexpr bool is_square() const {
+    return width == height;
+  }
+
+  constexpr bool is_canonical() const {
+    return (start == StartCorner::BOTTOM_LEFT) & (winding == Winding::CCW);
+  }
+
+  constexpr bool is_valid() const {
+    return (width >= 2) & (height >= 2) & (n_panels >= 1);
+  }
+
+  XY16 xy(uint16_t idx) const {
+    /* Position of the LED at logical index `idx` inside a panel, with the
+    origin at the bottom-left corner. The rectangle spans `width` x `height`
+    LED pitches. Requires `width` and `height` < 256.
+    */
+    uint16_t W = width << 8;
+    uint16_t H = height << 8;
+    uint16_t j; // Index along the side, in 8.8 fixed point at the LED center
+
+    if (idx < width) {
+      j = (idx << 8) + 128;
+      return XY16{j, 0};
+    }
+    if (idx < width + height) {
+      j = ((idx - width) << 8) + 128;
+      return XY16{W, j};
+    }
+    if (idx < 2 * width + height) {
+      j = ((idx - width - height) << 8) + 128;
+      return XY16{(uint16_t)(W - j), H};
+    }
+    j = ((idx - 2 * width - height) << 8) + 128;
+    return XY16{0, (uint16_t)(H - j)};
+  }
+
+  void perimeter_xy(XY16 *out) const {
+    /* Fill `out` with the positions of all `perimeter()` LEDs of a panel
+     */
+    for (uint16_t idx = 0; idx < perimeter(); idx++) {
+      out[idx] = xy(idx);
+    }
+  }
+
+  uint16_t to_physical_idx(uint16_t idx) const {
+    /* Map the logical index `idx` inside a panel onto the physical index
+     */
+    uint16_t P = perimeter();
+    uint16_t corner = side_start((uint8_t)start);
+    if (winding == Winding::CCW) {
+      return (idx + P - corner) % P;
+    }
+    return (corner + 2 * P - idx - 1) % P;
+  }
+
+  template <typename T> void to_physical(const T *in, T *out) const {
+    /* Reorder the LED data `in`, in logical order, into `out`, in physical
+    order. `in` and `out` must not overlap.
+    */
+    uint16_t P = perimeter();
+    for (uint8_t panel = 0; panel < n_panels; panel++) {
+      uint32_t offset = (uint32_t)panel * P;
+      for (uint16_t idx = 0; idx < P; idx++) {
+        out[offset + to_physical_idx(idx)] = in[offset + idx];
+      }
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,312 @@
+/* DvG_FastLED_Layers.h
+
+Layered presets: Several patterns running simultaneously, each on its own
+layer with its own strip segmentation style, stacked on top of each other by
+a blend mode and an opacity. To be included inside `DvG_FastLED_effects.h`,
+after `DvG_FastLED_functions.h`.
+
+Each layer gets drawn by a pattern function, which calculates the base pattern
+of the layer up to the length `s` befitting its style, just like the native
+effects do in `fx1`:
+
+  void layer__Name(CRGB *fx, uint16_t s);
+
+The base pattern persists from frame to frame and fades by the `decay` of the
+layer, see `DvG_FastLED_Decay.h`, hence trails come for free. Layers 0 to 3
+draw into `fx1`, `fx2`, `fx1_strip` and `fx2_strip`, segmented by `segmntr1`
+to `segmntr4`. The full-strip buffers of the native effects are free while a
+layered preset runs, as it never segments into them, hence layers 2 and 3
+only cost their segmenters.
+
+Compositing
+-----------
+Segmenting every layer into a full-strip buffer first and mixing those
+afterwards, like `populate_fx1_strip()`, `rotate_strip_90()` and
+`add_CRGBs()` do, takes several passes over the full strip per layer and a
+full-strip buffer per layer. Instead, `compose_layers()` makes a single pass
+over the output pixels per layer. It gathers the color of each pixel straight
+from the base pattern through the index mapping of the segmenter, optionally
+shifted along the strip, and blends it onto the result of the layers below:
+
+  BLEND_ADD       Saturating add, scaled by the opacity
+  BLEND_MAX       Per-channel maximum, scaled by the opacity
+  BLEND_ALPHA     Cross-fade by the opacity
+  BLEND_MULTIPLY  Per-channel multiply, cross-faded by the opacity
+
+The bottom is the snapshot of `leds` taken when the effect started, fading
+out, hence a layered preset fades in from the previous effect like the native
+effects do. Saturating adds commute, hence the order of `BLEND_ADD` layers
+among themselves does not matter.
+
+A preset declares its layers as a `constexpr std::array<FX_layer, ...>`,
+residing in flash, e.g. `layers_HeartBeat_2` of `DvG_FastLED_effects.h`:
+
+  FX_preset(layers_HeartBeat_2, 9000),
+
+The tables stay constant. What differs per run gets passed to
+`enter_layers()` instead, like the style of the preset that the native effect
+`fx__HeartBeat_2` draws its first layer in.
+
+Serial command 'b' reports the cost of each layer, see `benchmark_layers()`.
+On the host PC: `render bench`, see `host/render.cpp`.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_LAYERS_H
+#define DVG_FASTLED_LAYERS_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_Decay.h"
+#include "DvG_FastLED_StripSegmenter.h"
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+const uint8_t FX_MAX_LAYERS = 4;
+
+enum BlendMode : uint8_t {
+  BLEND_ADD,
+  BLEND_MAX,
+  BLEND_ALPHA,
+  BLEND_MULTIPLY,
+  BLEND_EOL // End of list
+};
+
+const char *blend_names[] = {"add", "max", "alpha", "multiply"};
+
+// Draws the base pattern `fx` of a layer up to length `s`
+typedef void (*LayerPattern)(CRGB *fx, uint16_t s);
+
+struct FX_layer {
+  constexpr FX_layer(LayerPattern _pattern, StyleEnum _style, BlendMode _mode,
+                     uint8_t _opacity, uint8_t _decay = 0,
+                     uint16_t _shift = 0)
+      : pattern{_pattern}, style{_style}, mode{_mode}, opacity{_opacity},
+        decay{_decay}, shift{_shift} {}
+
+  LayerPattern pattern;
+  StyleEnum style;
+  BlendMode mode;
+  uint8_t opacity;
+  uint8_t decay;  // Fade of the base pattern per 10 ms, out of 256, 0: none
+  uint16_t shift; // [LEDs] Rotation along the strip, < `FLC::N`
+};
+
+/*------------------------------------------------------------------------------
+  Layer storage
+------------------------------------------------------------------------------*/
+
+FastLED_StripSegmenter segmntr3;
+FastLED_StripSegmenter segmntr4;
+
+// Populated up to the base length of their segmenter
+CRGB *const layer_fx[FX_MAX_LAYERS] = {fx1, fx2, fx1_strip, fx2_strip};
+FastLED_StripSegmenter *const layer_segmntr[FX_MAX_LAYERS] = {
+    &segmntr1, &segmntr2, &segmntr3, &segmntr4};
+FastLED_Decay layer_decay[FX_MAX_LAYERS] = {0, 0, 0, 0};
+
+/*------------------------------------------------------------------------------
+  Compositing
+------------------------------------------------------------------------------*/
+
+template <BlendMode mode>
+inline void blend_layer(CRGB &pixel, CRGB color, uint8_t opacity) {
+  switch (mode) {
+    case BLEND_ADD:
+      pixel += color.nscale8(opacity);
+      break;
+    case BLEND_MAX:
+      color.nscale8(opacity);
+      pixel.r = max(pixel.r, color.r);
+      pixel.g = max(pixel.g, color.g);
+      pixel.b = max(pixel.b, color.b);
+      break;
+    case BLEND_ALPHA:
+      nblend(pixel, color, opacity);
+      break;
+    case BLEND_MULTIPLY:
+      nblend(pixel,
+             CRGB(scale8(pixel.r, color.r), scale8(pixel.g, color.g),
+                  scale8(pixel.b, color.b)),
+             opacity);
+      break;
+    default:
+      break;
+  }
+}
+
+template <BlendMode mode>
+void blend_mapped(CRGB *out, const CRGB *fx, const uint16_t *map,
+                  uint16_t shift, uint8_t opacity) {
+  /* Blend `fx` through `map`, rotated by `shift`, onto `out` over the full
+  strip. Split in two runs instead of wrapping the index per pixel.
+  */
+  const uint16_t n_head = FLC::N - shift;
+  for (uint16_t idx = 0; idx < n_head; idx++) {
+    blend_layer<mode>(out[idx], fx[map[idx + shift]], opacity);
+  }
+  for (uint16_t idx = n_head; idx < FLC::N; idx++) {
+    blend_layer<mode>(out[idx], fx[map[idx - n_head]], opacity);
+  }
+}
+
+void compose_layers(const FX_layer *layers, uint8_t n_layers, CRGB *out,
+                    const CRGB *bottom) {
+  /* Composite the base patterns of the first `n_layers` layers on top of
+  `bottom` into `out`. Each layer takes a single pass over `out`, gathering
+  straight from its base pattern. The blend mode gets resolved once per layer
+  instead of per pixel, letting the compiler specialize each pass.
+  */
+  n_layers = min(n_layers, FX_MAX_LAYERS);
+  if (out != bottom) {
+    memcpy(out, bottom, sizeof(CRGB) * FLC::N);
+  }
+
+  for (uint8_t l = 0; l < n_layers; l++) {
+    const CRGB *fx = layer_fx[l];
+    const uint16_t *map = layer_segmntr[l]->get_map();
+    const uint16_t shift = layers[l].shift;
+    const uint8_t opacity = layers[l].opacity;
+
+    switch (layers[l].mode) {
+      case BLEND_ADD:
+        blend_mapped<BLEND_ADD>(out, fx, map, shift, opacity);
+        break;
+      case BLEND_MAX:
+        blend_mapped<BLEND_MAX>(out, fx, map, shift, opacity);
+        break;
+      case BLEND_ALPHA:
+        blend_mapped<BLEND_ALPHA>(out, fx, map, shift, opacity);
+        break;
+      case BLEND_MULTIPLY:
+        blend_mapped<BLEND_MULTIPLY>(out, fx, map, shift, opacity);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void enter_layers(const FX_layer *layers, uint8_t n_layers,
+                  const StyleEnum *styles = nullptr) {
+  /* To be called inside the `entr__...` function, after `init_fx()`. The
+  layers get segmented in the `styles` given for this run, when given, else
+  in the style of their table entry.
+  */
+  n_layers = min(n_layers, FX_MAX_LAYERS);
+  create_leds_snapshot();
+  for (uint8_t l = 0; l < n_layers; l++) {
+    layer_segmntr[l]->set_style(styles ? styles[l] : layers[l].style);
+    layer_decay[l].set_fade(layers[l].decay);
+    clear_CRGBs(layer_fx[l]);
+  }
+}
+
+void update_layers(const FX_layer *layers, uint8_t n_layers) {
+  /* Draw the layers, composite them on top of `leds_snapshot` into `leds` and
+  fade them. To be called inside the `upd__...` function.
+  */
+  n_layers = min(n_layers, FX_MAX_LAYERS);
+  for (uint8_t l = 0; l < n_layers; l++) {
+    layers[l].pattern(layer_fx[l], layer_segmntr[l]->get_base_numel());
+  }
+
+  compose_layers(layers, n_layers, leds, leds_snapshot);
+
+  for (uint8_t l = 0; l < n_layers; l++) {
+    if (layers[l].decay) {
+      layer_decay[l].apply(layer_fx[l], layer_segmntr[l]->get_base_numel());
+    }
+  }
+}
+
+/*------------------------------------------------------------------------------
+  benchmark_layers
+------------------------------------------------------------------------------*/
+
+void benchmark_layers(Stream *mySerial, const FX_layer *layers,
+                      uint8_t n_layers) {
+  /* Time drawing each layer of `layers` and the extra cost of blending it in,
+  over `FLC::N` LEDs. Also times compositing two `BLEND_ADD` layers, one
+  rotated, in separate passes through full-strip buffers against the single
+  fused pass. Overwrites the base patterns of all layers and `leds`, hence
+  the running effect might show a glitch.
+  */
+  const uint16_t N_REPEAT = 100;
+  StyleEnum style[FX_MAX_LAYERS];
+  uint32_t t_draw[FX_MAX_LAYERS];
+  uint32_t t_compose[FX_MAX_LAYERS + 1];
+  uint32_t t_separate, t_fused;
+  uint32_t tick;
+
+  n_layers = min(n_layers, FX_MAX_LAYERS);
+  for (uint8_t l = 0; l < FX_MAX_LAYERS; l++) {
+    style[l] = layer_segmntr[l]->get_style();
+  }
+  for (uint8_t l = 0; l < n_layers; l++) {
+    layer_segmntr[l]->set_style(layers[l].style);
+  }
+
+  for (uint8_t l = 0; l < n_layers; l++) {
+    uint16_t s = layer_segmntr[l]->get_base_numel();
+    tick = micros();
+    for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+      layers[l].pattern(layer_fx[l], s);
+    }
+    t_draw[l] = micros() - tick;
+  }
+
+  for (uint8_t n = 0; n <= n_layers; n++) {
+    tick = micros();
+    for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+      compose_layers(layers, n, leds, leds_snapshot);
+    }
+    t_compose[n] = micros() - tick;
+  }
+
+  const FX_layer two[2] = {
+      FX_layer(nullptr, segmntr1.get_style(), BLEND_ADD, 255, 0,
+               FLC::GEOMETRY.width),
+      FX_layer(nullptr, segmntr2.get_style(), BLEND_ADD, 255)};
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    populate_fx1_strip();
+    populate_fx2_strip();
+    rotate_strip_90(fx1_strip);
+    add_CRGBs(fx1_strip, fx2_strip, fx1_strip, FLC::N);
+    add_CRGBs(leds_snapshot, fx1_strip, fx2_strip, FLC::N);
+  }
+  t_separate = micros() - tick;
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    compose_layers(two, 2, fx2_strip, leds_snapshot);
+  }
+  t_fused = micros() - tick;
+
+  for (uint8_t l = 0; l < FX_MAX_LAYERS; l++) {
+    layer_segmntr[l]->set_style(style[l]);
+  }
+
+  mySerial->print("Layers over ");
+  mySerial->print(FLC::N);
+  mySerial->println(" LEDs, [us] per frame");
+  for (uint8_t l = 0; l < n_layers; l++) {
+    mySerial->print("  Layer ");
+    mySerial->print(l);
+    mySerial->print(", ");
+    mySerial->print(blend_names[layers[l].mode]);
+    mySerial->print(": draw ");
+    mySerial->print((float)t_draw[l] / N_REPEAT);
+    mySerial->print(", blend ");
+    mySerial->println(((float)t_compose[l + 1] - t_compose[l]) / N_REPEAT);
+  }
+  mySerial->print("  Compose, all layers  : ");
+  mySerial->println((float)t_compose[n_layers] / N_REPEAT);
+  mySerial->print("  2 layers, separate   : ");
+  mySerial->println((float)t_separate / N_REPEAT);
+  mySerial->print("  2 layers, fused      : ");
+  mySerial->println((float)t_fused / N_REPEAT);
+}
+
+#endif
@@ -0,0 +1,202 @@
+/* DvG_FastLED_Noise.h
+
+Batched sampling of FastLED's 3D noise field `inoise16(x, y, z)` along a path
+of (x, y) positions, like the LEDs along the mirror perimeter.
+
+Calling `inoise16()` per LED per frame recalculates everything from scratch
+for each sample: the 8 lattice hashes of the surrounding unit cube, the fade
+curves and the z-dependent terms. Along a path, neighbouring samples mostly
+fall inside the same lattice cell and share either their x or y coordinate, as
+the perimeter consists of horizontal and vertical sides. `inoise16_path()`
+evaluates the whole path at a single `z` in one go:
+
+  - The z fade curve gets calculated once per batch.
+  - The 8 lattice hashes, 14 table look-ups, get recalculated only when a
+    sample enters a new cell.
+  - The x and y fade curves get recalculated only when x or y changes, i.e.
+    only one of both along each side of the perimeter.
+  - There is a single call per batch instead of one per LED.
+
+The gradient and interpolation math per sample remains. The output is
+bit-identical to `inoise16()`. Serial command 'b' benchmarks the batch against
+per-LED `inoise16()` calls on the device, see `benchmark_noise()`. On the host
+PC, `host/bench_noise.cpp` checks both bit for bit over 52 up to 10k LEDs and
+times them.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_NOISE_H
+#define DVG_FASTLED_NOISE_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_Geometry.h"
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+namespace NoiseBatch {
+  // Ken Perlin's permutation table, identical to the one in FastLED's
+  // `noise.cpp` which is not accessible from outside
+  // clang-format off
+  const uint8_t perm[] = {
+    151, 160, 137,  91,  90,  15, 131,  13, 201,  95,  96,  53, 194, 233,   7, 225,
+    140,  36, 103,  30,  69, 142,   8,  99,  37, 240,  21,  10,  23, 190,   6, 148,
+    247, 120, 234,  75,   0,  26, 197,  62,  94, 252, 219, 203, 117,  35,  11,  32,
+     57, 177,  33,  88, 237, 149,  56,  87, 174,  20, 125, 136, 171, 168,  68, 175,
+     74, 165,  71, 134, 139,  48,  27, 166,  77, 146, 158, 231,  83, 111, 229, 122,
+     60, 211, 133, 230, 220, 105,  92,  41,  55,  46, 245,  40, 244, 102, 143,  54,
+     65,  25,  63, 161,   1, 216,  80,  73, 209,  76, 132, 187, 208,  89,  18, 169,
+    200, 196, 135, 130, 116, 188, 159,  86, 164, 100, 109, 198, 173, 186,   3,  64,
+     52, 217, 226, 250, 124, 123,   5, 202,  38, 147, 118, 126, 255,  82,  85, 212,
+    207, 206,  59, 227,  47,  16,  58,  17, 182, 189,  28,  42, 223, 183, 170, 213,
+    119, 248, 152,   2,  44, 154, 163,  70, 221, 153, 101, 155, 167,  43, 172,   9,
+    129,  22,  39, 253,  19,  98, 108, 110,  79, 113, 224, 232, 178, 185, 112, 104,
+    218, 246,  97, 228, 251,  34, 242, 193, 238, 210, 144,  12, 191, 179, 162, 241,
+     81,  51, 145, 235, 249,  14, 239, 107,  49, 192, 214,  31, 181, 199, 106, 157,
+    184,  84, 204, 176, 115, 121,  50,  45, 127,   4, 150, 254, 138, 236, 205,  93,
+    222, 114,  67,  29,  24,  72, 243, 141, 128, 195,  78,  66, 215,  61, 156, 180,
+    151};
+  // clang-format on
+
+  inline int16_t grad16(uint8_t hash, int16_t x, int16_t y, int16_t z) {
+    // Identical to `grad16()` in FastLED's `noise.cpp`
+    hash = hash & 15;
+    int16_t u = hash < 8 ? x : y;
+    int16_t v = hash < 4 ? y : hash == 12 || hash == 14 ? x : z;
+    if (hash & 1) {
+      u = -u;
+    }
+    if (hash & 2) {
+      v = -v;
+    }
+    return avg15(u, v);
+  }
+} // namespace NoiseBatch
+
+void inoise16_path(const XY16 *path, uint16_t numel, uint32_t x0, uint32_t y0,
+                   uint32_t z, uint16_t scale, uint16_t *out) {
+  /* Sample `inoise16(x, y, z)` at each of the `numel` positions of `path`,
+  with `x = x0 + path.x * scale` and `y = y0 + path.y * scale`. Hence, one LED
+  pitch spans `256 * scale` noise units and a lattice cell spans 65536.
+  */
+  using NoiseBatch::grad16;
+  using NoiseBatch::perm;
+  const uint16_t N = 0x8000;
+
+  // Constant over the batch
+  uint8_t Z = z >> 16;
+  int16_t zz = ((z & 0xFFFF) >> 1) & 0x7FFF;
+  uint16_t w = ease16InOutQuad(z & 0xFFFF);
+
+  // Cached per lattice cell, and per x and y coordinate
+  bool cell_valid = false;
+  uint8_t X = 0, Y = 0;
+  uint8_t h_AA = 0, h_BA = 0, h_AB = 0, h_BB = 0;
+  uint8_t h_AA1 = 0, h_BA1 = 0, h_AB1 = 0, h_BB1 = 0;
+  uint32_t x_prev = 0, y_prev = 0;
+  uint16_t u = 0, v = 0;
+  int16_t xx = 0, yy = 0;
+
+  for (uint16_t idx = 0; idx < numel; idx++) {
+    uint32_t x = x0 + (uint32_t)path[idx].x * scale;
+    uint32_t y = y0 + (uint32_t)path[idx].y * scale;
+    bool new_cell = !cell_valid || ((uint8_t)(x >> 16) != X) ||
+                    ((uint8_t)(y >> 16) != Y);
+
+    if (new_cell) {
+      X = x >> 16;
+      Y = y >> 16;
+      uint8_t A = perm[X] + Y;
+      uint8_t AA = perm[A] + Z;
+      uint8_t AB = perm[(uint8_t)(A + 1)] + Z;
+      uint8_t B = perm[(uint8_t)(X + 1)] + Y;
+      uint8_t BA = perm[B] + Z;
+      uint8_t BB = perm[(uint8_t)(B + 1)] + Z;
+      h_AA = perm[AA];
+      h_BA = perm[BA];
+      h_AB = perm[AB];
+      h_BB = perm[BB];
+      h_AA1 = perm[(uint8_t)(AA + 1)];
+      h_BA1 = perm[(uint8_t)(BA + 1)];
+      h_AB1 = perm[(uint8_t)(AB + 1)];
+      h_BB1 = perm[(uint8_t)(BB + 1)];
+    }
+    if (new_cell || (x != x_prev)) {
+      xx = ((x & 0xFFFF) >> 1) & 0x7FFF;
+      u = ease16InOutQuad(x & 0xFFFF);
+      x_prev = x;
+    }
+    if (new_cell || (y != y_prev)) {
+      yy = ((y & 0xFFFF) >> 1) & 0x7FFF;
+      v = ease16InOutQuad(y & 0xFFFF);
+      y_prev = y;
+    }
+    cell_valid = true;
+
+    // clang-format off
+    int16_t X1 = lerp15by16(grad16(h_AA , xx    , yy    , zz    ),
+                            grad16(h_BA , xx - N, yy    , zz    ), u);
+    int16_t X2 = lerp15by16(grad16(h_AB , xx    , yy - N, zz    ),
+                            grad16(h_BB , xx - N, yy - N, zz    ), u);
+    int16_t X3 = lerp15by16(grad16(h_AA1, xx    , yy    , zz - N),
+                            grad16(h_BA1, xx - N, yy    , zz - N), u);
+    int16_t X4 = lerp15by16(grad16(h_AB1, xx    , yy - N, zz - N),
+                            grad16(h_BB1, xx - N, yy - N, zz - N), u);
+    // clang-format on
+    int16_t Y1 = lerp15by16(X1, X2, v);
+    int16_t Y2 = lerp15by16(X3, X4, v);
+    int32_t ans = lerp15by16(Y1, Y2, w);
+
+    // Same scaling as `inoise16()`
+    ans = ans + 19052L;
+    uint32_t pan = ans;
+    pan *= 440L;
+    out[idx] = pan >> 8;
+  }
+}
+
+void benchmark_noise(Stream *mySerial, const XY16 *path, uint16_t numel) {
+  /* Time sampling the noise field along `path` per LED using `inoise16()`
+  against `inoise16_path()`, and check that both agree
+  */
+  const uint16_t N_REPEAT = 100;
+  const uint16_t scale = 40;
+  static uint16_t out_1[FLC::N];
+  static uint16_t out_2[FLC::N];
+  uint32_t tick;
+  uint32_t t_1, t_2;
+  uint16_t n_diff = 0;
+
+  numel = min(numel, (uint16_t)FLC::N);
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    for (uint16_t idx = 0; idx < numel; idx++) {
+      out_1[idx] = inoise16((uint32_t)path[idx].x * scale,
+                            (uint32_t)path[idx].y * scale, rep * 1000UL);
+    }
+  }
+  t_1 = micros() - tick;
+
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    inoise16_path(path, numel, 0, 0, rep * 1000UL, scale, out_2);
+  }
+  t_2 = micros() - tick;
+
+  for (uint16_t idx = 0; idx < numel; idx++) {
+    n_diff += (out_1[idx] != out_2[idx]);
+  }
+
+  mySerial->print("Noise along ");
+  mySerial->print(numel);
+  mySerial->println(" LEDs, [us] per frame");
+  mySerial->print("  inoise16     : ");
+  mySerial->println((float)t_1 / N_REPEAT);
+  mySerial->print("  inoise16_path: ");
+  mySerial->println((float)t_2 / N_REPEAT);
+  mySerial->print("  Mismatches   : ");
+  mySerial->println(n_diff);
+}
+
+#endif
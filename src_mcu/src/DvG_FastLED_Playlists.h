@@ -0,0 +1,56 @@
+/* DvG_FastLED_Playlists.h
+
+Preset lists of FastLED effects to show consecutively, shared by the firmware
+and by the offline renderer on the host PC, `host/render.cpp`.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_PLAYLISTS_H
+#define DVG_FASTLED_PLAYLISTS_H
+
+#include <array>
+
+#include "DvG_FastLED_EffectManager.h"
+#include "DvG_FastLED_effects.h"
+
+/*------------------------------------------------------------------------------
+  FastLED effect presets
+------------------------------------------------------------------------------*/
+// clang-format off
+// Preset lists of FastLED effects to show consecutively. They reside in flash
+// and are validated at compile time. Slowly changing effects can be given a
+// render rate below the output frame rate, see `FastLED_EffectManager`. The
+// quality degradations, `QosFlags`, default to `QOS_GENERIC`. Halving the
+// render rate coarsens the motion, hence only RainbowSurf allows it. Layered
+// presets give their table of layers instead, see `DvG_FastLED_Layers.h`.
+constexpr std::array<FX_preset, 10> fx_list_day = {{
+  //        FastLED effect       strip segmentation style           duration [ms]  render rate [Hz]  quality degradations
+  //        --------------       ------------------------           -------------  ----------------  --------------------
+  FX_preset(fx__HeartBeatAwaken, StyleEnum::HALFWAY_PERIO_SPLIT_N2, 5800),
+  FX_preset(fx__RainbowSurf    , StyleEnum::FULL_STRIP            , 8000         , 0               , QOS_ALL),
+  FX_preset(fx__RainbowBarf    , StyleEnum::PERIO_OPP_CORNERS_N2  , 11000        , 50              , QOS_GENERIC | QOS_COARSE),
+  FX_preset(fx__Dennis         , StyleEnum::PERIO_OPP_CORNERS_N2  , 13000),
+  FX_preset(layers_HeartBeat_2 ,                                    9000),
+  FX_preset(fx__DoubleWave     , StyleEnum::COPIED_SIDES          , 19000        , 100),
+  FX_preset(fx__Sinelon        , StyleEnum::BI_DIR_SIDE2SIDE      , 13000),
+  FX_preset(fx__Noise          , StyleEnum::FULL_STRIP            , 15000        , 100             , QOS_GENERIC | QOS_NO_BLEND),
+  FX_preset(fx__FadeToRed      , 0),
+  FX_preset(fx__FadeToBlack    , 0),
+}};
+static_assert(is_valid_playlist(fx_list_day), "Invalid FX playlist");
+
+// Calmer effects for at night
+constexpr std::array<FX_preset, 5> fx_list_night = {{
+  //        FastLED effect       strip segmentation style           duration [ms]  render rate [Hz]  quality degradations
+  //        --------------       ------------------------           -------------  ----------------  --------------------
+  FX_preset(fx__HeartBeatAwaken, StyleEnum::HALFWAY_PERIO_SPLIT_N2, 5800),
+  FX_preset(fx__RainbowSurf    , StyleEnum::FULL_STRIP            , 20000        , 0               , QOS_ALL),
+  FX_preset(fx__DoubleWave     , StyleEnum::COPIED_SIDES          , 30000        , 100),
+  FX_preset(fx__Dennis         , StyleEnum::PERIO_OPP_CORNERS_N2  , 20000),
+  FX_preset(fx__FadeToBlack    , 0),
+}};
+static_assert(is_valid_playlist(fx_list_night), "Invalid FX playlist");
+// clang-format on
+
+#endif
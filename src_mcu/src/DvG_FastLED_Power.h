@@ -0,0 +1,120 @@
+/* DvG_FastLED_Power.h
+
+Estimates the current drawn by the LED strip and caps the brightness to stay
+within the budget of the power supply, `FLC::POWER_BUDGET`.
+
+Calibrated on the measurements in `notes.txt`: 52 LEDs draw 58 mA when all
+off and 1.3 A at full white. The 2.0 A supply only managed 1.13 A at full
+white, hence a budget is needed. Full white was measured with the color
+correction of `FLC::COLOR_CORRECTION` in effect, hence the current per color
+channel gets derived from the corrected channel values. The model:
+
+  I = I_idle + brightness / 255 * sum_channels(w_c * sum_leds(value_c))
+
+Both terms are per LED, hence `I_idle` is `FLC::POWER_IDLE` scaled by
+`FLC::N / FLC::POWER_CAL_N`, as the sums already scale with `FLC::N`. The
+figures of `notes.txt` are reproduced by `host/power_check.cpp`.
+
+The per-channel sums get taken over the whole strip every frame, 3 additions
+per LED, negligible next to `show()`. Hence, the cap takes effect on the very
+frame that exceeds the budget, also on a single-frame flash like `fx__Strobe`.
+FastLED's own `calculate_unscaled_power_mW()` would do the same pass, but
+weighs the channels by its own figures instead of those of `notes.txt`.
+
+The brightness cap drops immediately when the budget gets exceeded. It only
+gets raised again, by 1 per frame, once the allowed brightness has stayed at
+least `FLC::POWER_HYSTERESIS` above the cap, or at full, for `FLC::POWER_HOLD`
+frames. This prevents the brightness from pumping along with content hovering
+around the budget.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_POWER_H
+#define DVG_FASTLED_POWER_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+class PowerLimiter {
+private:
+  uint8_t _cap = 255;       // Brightness cap
+  uint16_t _n_headroom = 0; // Consecutive frames with headroom
+  float _full_mA = 0; // [mA] Current of the LEDs at brightness 255
+  float _idle_mA;     // [mA] Current of the LEDs when all off
+  float _w[3];        // [mA] Current per channel per unit of value
+
+public:
+  PowerLimiter() {
+    // Current per channel at value 255, after color correction
+    const uint32_t corr = FLC::COLOR_CORRECTION;
+    const uint8_t c[3] = {(uint8_t)(corr >> 16), (uint8_t)(corr >> 8),
+                          (uint8_t)corr};
+    const float I_channel = (float)(FLC::POWER_FULL_WHITE - FLC::POWER_IDLE) /
+                            FLC::POWER_CAL_N / ((c[0] + c[1] + c[2]) / 255.f);
+
+    for (uint8_t i = 0; i < 3; i++) {
+      _w[i] = I_channel * c[i] / 255.f / 255.f;
+    }
+    _idle_mA = (float)FLC::POWER_IDLE * FLC::N / FLC::POWER_CAL_N;
+  }
+
+  uint8_t update(const CRGB *leds, uint8_t brightness) {
+    /* To be called once per frame, before it gets sent out. Returns the
+    requested `brightness`, capped to stay within the power budget.
+    */
+    uint32_t r = 0, g = 0, b = 0;
+
+    for (uint16_t i = 0; i < FLC::N; i++) {
+      r += leds[i].r;
+      g += leds[i].g;
+      b += leds[i].b;
+    }
+    _full_mA = _w[0] * r + _w[1] * g + _w[2] * b;
+
+    // Highest brightness within the budget
+    const float headroom = max(FLC::POWER_BUDGET - _idle_mA, 0.f);
+    uint8_t allowed = (_full_mA <= headroom) ? 255 : headroom * 255 / _full_mA;
+
+    if (allowed < _cap) {
+      _cap = allowed;
+      _n_headroom = 0;
+    } else if ((_cap < 255) &&
+               (allowed >= min(_cap + FLC::POWER_HYSTERESIS, 255))) {
+      if (_n_headroom < FLC::POWER_HOLD) {
+        _n_headroom++;
+      } else {
+        _cap++;
+      }
+    } else {
+      _n_headroom = 0;
+    }
+
+    return min(brightness, _cap);
+  }
+
+  uint8_t cap() { return _cap; }
+
+  float estimate_mA(uint8_t brightness) {
+    /* Estimated current of the strip at the given brightness
+     */
+    return _idle_mA + _full_mA * brightness / 255;
+  }
+
+  void print_info(Stream *mySerial, uint8_t brightness) {
+    mySerial->print("Power budget   [mA]: ");
+    mySerial->println(FLC::POWER_BUDGET);
+    mySerial->print("  Estimate     [mA]: ");
+    mySerial->println(estimate_mA(min(brightness, _cap)));
+    mySerial->print("  Uncapped     [mA]: ");
+    mySerial->println(estimate_mA(brightness));
+    mySerial->print("  Brightness cap   : ");
+    mySerial->println(_cap);
+  }
+};
+
+PowerLimiter power_limiter;
+
+#endif
@@ -0,0 +1,210 @@
+/* DvG_FastLED_Primitives.h
+
+Sparse, anti-aliased drawing of dots, bars, comets and Gaussian blobs at
+sub-pixel positions, for moving-dot effects.
+
+Writing a single pixel at an integer index from `beatsin16()` makes a moving
+dot jump from LED to LED, which looks steppy on the short sides of the mirror.
+A full-strip float Gaussian, as in `profile_gauss8strip()`, moves smoothly but
+evaluates `exp()` and `pow()` for every LED of the strip and rotates the
+result into place, every frame.
+
+The primitives here take positions and widths in fixed point with 8
+fractional bits, i.e. in units of 1/256 LED, and only touch the O(width)
+pixels that they cover. Positions and widths are 24.8, `uint32_t`, hence
+strips of any length up to `FLC::N` work. The suffix `88` of the function
+names stands for those 8 fractional bits, not for FastLED's 16-bit 8.8 type.
+Each pixel gets the color added, saturating, scaled by the fraction of the
+pixel that the shape covers. Pixel `i` is centered at position `i << 8` and
+spans half a pixel to both sides, hence a dot at `i << 8` lights exactly pixel
+`i` and a dot halfway between two pixels lights both at half intensity.
+
+They draw into the base pattern of a segmenter, e.g. `fx1` of length `s1`,
+so that the segmenter still applies afterwards. Pixels outside of
+[0, `numel`) get clipped. A moving dot typically becomes:
+
+  uint32_t pos = beatpos88(15, s1, fx_timebase);
+  draw_dot88(fx1, s1, pos, CRGB::Red);
+
+as `beatsin16(15, 0, (s1 - 1) << 8, fx_timebase)` would overflow its 16 bits
+above 256 LEDs.
+
+Serial command 'b' benchmarks `draw_gauss88()` against
+`profile_gauss8strip()` on the device, see `benchmark_primitives()`. Hence,
+include this file after `DvG_FastLED_functions.h`.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_PRIMITIVES_H
+#define DVG_FASTLED_PRIMITIVES_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+// exp(-x^2 / 2) * 255 for x = [0 ... 3] sigma in steps of 1/16 sigma
+// clang-format off
+const uint8_t GAUSS8_LUT[49] = {
+  255, 255, 253, 251, 247, 243, 238, 232, 225, 218, 210, 201, 192, 183, 174,
+  164, 155, 145, 135, 126, 117, 108,  99,  91,  83,  75,  68,  61,  55,  49,
+   44,  39,  35,  30,  27,  23,  20,  18,  15,  13,  11,  10,   8,   7,   6,
+    5,   4,   3,   3};
+// clang-format on
+
+inline void add_scaled(CRGB &pixel, const CRGB &color, uint8_t scale) {
+  pixel += CRGB(scale8(color.r, scale), scale8(color.g, scale),
+                scale8(color.b, scale));
+}
+
+inline uint32_t beatpos88(accum88 bpm, uint16_t numel, uint32_t timebase = 0,
+                          uint16_t phase = 0) {
+  /* Position in 24.8 sweeping sinusoidally over [0, `numel` - 1] LEDs at
+  `bpm`. Equal to `beatsin16(bpm, 0, (numel - 1) << 8, timebase, phase)` as
+  long as that fits 16 bits, i.e. up to 256 LEDs.
+  */
+  uint16_t beatsin = sin16(beat16(bpm, timebase) + phase) + 32768;
+  return ((uint64_t)beatsin * (((uint32_t)(numel - 1) << 8) + 1)) >> 16;
+}
+
+inline uint8_t coverage88(int32_t a, int32_t b, int32_t i) {
+  /* Fraction [0 - 255] of pixel `i` covered by the span [a, b) in 8.8
+   */
+  int32_t lo = max(a, i * 256 - 128);
+  int32_t hi = min(b, i * 256 + 128);
+  return (hi > lo) ? (uint8_t)min(hi - lo, (int32_t)255) : 0;
+}
+
+/*------------------------------------------------------------------------------
+  Primitives
+------------------------------------------------------------------------------*/
+
+void draw_bar88(CRGB *strip, uint16_t numel, uint32_t pos, uint32_t width,
+                const CRGB &color) {
+  /* Bar of `width` centered at `pos`, both in 24.8
+   */
+  const int32_t a = (int32_t)pos - (int32_t)(width / 2);
+  const int32_t b = a + width;
+  const int32_t i0 = max((a + 128) >> 8, (int32_t)0);
+  const int32_t i1 = min((b + 127) >> 8, (int32_t)numel - 1);
+
+  for (int32_t i = i0; i <= i1; i++) {
+    add_scaled(strip[i], color, coverage88(a, b, i));
+  }
+}
+
+void draw_dot88(CRGB *strip, uint16_t numel, uint32_t pos, const CRGB &color) {
+  /* Dot of 1 pixel wide at `pos` in 24.8, spread over at most 2 pixels
+   */
+  const uint32_t i = pos >> 8;
+  const uint8_t frac = pos & 0xFF; // Part falling into pixel `i + 1`
+
+  if (i < numel) {
+    add_scaled(strip[i], color, 255 - frac);
+  }
+  if (frac && (i + 1 < numel)) {
+    add_scaled(strip[i + 1], color, frac);
+  }
+}
+
+void draw_comet88(CRGB *strip, uint16_t numel, uint32_t pos, int32_t length,
+                  const CRGB &color) {
+  /* Comet with its head at `pos` and a tail fading out linearly over
+  `length`, both in 24.8. A positive `length` trails behind towards lower
+  positions, i.e. for a comet moving up, a negative one towards higher.
+  */
+  if (length == 0) {
+    return;
+  }
+  const int32_t len = abs(length);
+  const int32_t a = (length > 0) ? (int32_t)pos - len : (int32_t)pos;
+  const int32_t b = a + len;
+  const int32_t i0 = max((a + 128) >> 8, (int32_t)0);
+  const int32_t i1 = min((b + 127) >> 8, (int32_t)numel - 1);
+
+  for (int32_t i = i0; i <= i1; i++) {
+    // Brightness at the pixel center, 255 at the head
+    int32_t x = (length > 0) ? i * 256 - a : b - i * 256;
+    x = constrain(x, (int32_t)0, len);
+    add_scaled(strip[i], color,
+               scale8(coverage88(a, b, i), (uint8_t)((uint32_t)x * 255 / len)));
+  }
+}
+
+void draw_gauss88(CRGB *strip, uint16_t numel, uint32_t pos, uint32_t sigma,
+                  const CRGB &color) {
+  /* Gaussian blob centered at `pos` with standard deviation `sigma`, both in
+  24.8, sampled at the pixel centers and cut off at 3 sigma
+  */
+  sigma = max(sigma, (uint32_t)1);
+  const int32_t reach = (int32_t)sigma * 3;
+  const int32_t i0 = max(((int32_t)pos - reach + 255) >> 8, (int32_t)0);
+  const int32_t i1 = min(((int32_t)pos + reach) >> 8, (int32_t)numel - 1);
+
+  for (int32_t i = i0; i <= i1; i++) {
+    // Distance to the center in units of 1/256 sigma
+    uint32_t t = ((uint32_t)abs(i * 256 - (int32_t)pos) << 8) / sigma;
+    uint8_t idx = t >> 4;
+    if (idx >= 48) {
+      continue;
+    }
+    uint8_t frac = (t & 0x0F) << 4;
+    add_scaled(strip[i], color,
+               lerp8by8(GAUSS8_LUT[idx], GAUSS8_LUT[idx + 1], frac));
+  }
+}
+
+/*------------------------------------------------------------------------------
+  benchmark_primitives
+------------------------------------------------------------------------------*/
+
+void benchmark_primitives(Stream *mySerial, CRGB *strip) {
+  /* Time a moving Gaussian blob drawn by `draw_gauss88()` against the
+  full-strip `profile_gauss8strip()`, over `FLC::N` LEDs. `strip` gets
+  overwritten.
+  */
+  const uint16_t N_REPEAT = 100;
+  const float sigma = 1.5; // [LEDs]
+  uint8_t gauss8[FLC::N];
+  uint32_t tick;
+  uint32_t t_1, t_2, t_3;
+
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    profile_gauss8strip(gauss8, rep * FLC::N / (float)N_REPEAT, sigma);
+    for (uint16_t idx = 0; idx < FLC::N; idx++) {
+      strip[idx] = CRGB(gauss8[idx], 0, 0);
+    }
+  }
+  t_1 = micros() - tick;
+
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    profile_gauss8strip(gauss8, (uint16_t)(rep * FLC::N / N_REPEAT), sigma);
+    for (uint16_t idx = 0; idx < FLC::N; idx++) {
+      strip[idx] = CRGB(gauss8[idx], 0, 0);
+    }
+  }
+  t_2 = micros() - tick;
+
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    fill_solid(strip, FLC::N, CRGB::Black);
+    draw_gauss88(strip, FLC::N, (uint32_t)rep * (FLC::N - 1) * 256 / N_REPEAT,
+                 sigma * 256, CRGB::Red);
+  }
+  t_3 = micros() - tick;
+
+  mySerial->print("Gaussian blob over ");
+  mySerial->print(FLC::N);
+  mySerial->println(" LEDs, [us] per frame");
+  mySerial->print("  profile_gauss8strip, float: ");
+  mySerial->println((float)t_1 / N_REPEAT);
+  mySerial->print("  profile_gauss8strip, int  : ");
+  mySerial->println((float)t_2 / N_REPEAT);
+  mySerial->print("  draw_gauss88 incl. clear  : ");
+  mySerial->println((float)t_3 / N_REPEAT);
+}
+
+#endif
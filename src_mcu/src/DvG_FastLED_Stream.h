@@ -0,0 +1,335 @@
+/* DvG_FastLED_Stream.h
+
+Binary streaming of LED frames from a host PC over the USB CDC `Serial`, to
+drive the mirror live. Entered by serial command 'x', after which all incoming
+bytes are parsed as packets until an END packet arrives or the stream times
+out after `FLC::STREAM_TIMEOUT` ms without data.
+
+Packet
+------
+  offset  size  field
+  0       2     sync: 0xA5, 0x5A
+  2       1     type: 0x01 FRAME, 0x02 PARTIAL, 0x03 END
+  3       1     sequence number, incrementing by 1 per packet, wrapping
+  4       2     index of the first LED, uint16 little-endian
+  6       2     number of LEDs `n`, uint16 little-endian
+  8       3n    RGB data
+  8 + 3n  2     CRC-16/CCITT-FALSE over bytes [2, 8 + 3n), little-endian
+
+FRAME packets replace the full strip, where LEDs outside of the range become
+black. PARTIAL packets build on top of the last received frame.
+
+Receiving
+---------
+The parser runs byte-wise and non-blocking, writing the RGB data straight into
+a spare slot of the jitter buffer without intermediate copies. A packet gets
+committed to the jitter buffer only once its CRC checks out, and only then
+does a full buffer drop its oldest frame. A sequence number at or up to 127
+behind the last one marks a duplicate or reordered packet, which gets dropped.
+
+The playout side waits for `FLC::STREAM_DEPTH / 2 + 1` frames to be buffered
+and then releases one frame every `FLC::STREAM_PERIOD` ms, at a frame
+boundary of the main loop. Releasing swaps the buffers: `leds` gets pointed
+at the slot holding the frame, and the buffer `leds` pointed at becomes the
+spare slot. No frame data gets copied. This absorbs the jitter of the USB
+host. When the buffer runs dry, the last frame is held and buffering starts
+over.
+
+Counters
+--------
+  received : frames committed to the jitter buffer
+  crc      : packets dropped because of a CRC error
+  lost     : skipped sequence numbers, packets with a CRC error included
+  dup      : duplicate or reordered packets, dropped
+  overflow : frames dropped because the jitter buffer was full, oldest first
+  underrun : playout instants without a frame available
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_STREAM_H
+#define DVG_FASTLED_STREAM_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+#define STREAM_SYNC_0 0xA5
+#define STREAM_SYNC_1 0x5A
+#define STREAM_TYPE_FRAME 0x01
+#define STREAM_TYPE_PARTIAL 0x02
+#define STREAM_TYPE_END 0x03
+#define STREAM_HEADER_SIZE 8
+
+uint16_t crc16_ccitt(uint16_t crc, uint8_t data) {
+  // CRC-16/CCITT-FALSE, polynomial 0x1021, to be seeded with 0xFFFF
+  crc ^= (uint16_t)data << 8;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+struct StreamCounters {
+  uint32_t received = 0;
+  uint32_t crc = 0;
+  uint32_t lost = 0;
+  uint32_t dup = 0;
+  uint32_t overflow = 0;
+  uint32_t underrun = 0;
+};
+
+/*------------------------------------------------------------------------------
+  FrameStream
+------------------------------------------------------------------------------*/
+
+class FrameStream {
+private:
+  enum ParseState { SYNC_0, SYNC_1, HEADER, DATA, CRC };
+
+  // Jitter buffer: a ring of slots, plus a spare one to receive into. The
+  // slots point into `_storage`, but get swapped with `leds` at playout.
+  static const uint8_t N_SLOTS = FLC::STREAM_DEPTH + 1;
+  CRGB _storage[N_SLOTS][FLC::N];
+  CRGB *_slots[N_SLOTS];
+  uint8_t _head = 0;            // Slot of the oldest frame
+  uint8_t _count = 0;           // Number of buffered frames
+  const CRGB *_newest;          // Newest frame, nullptr: none
+  bool _prebuffering = true;
+
+  ParseState _state = SYNC_0;
+  uint8_t _header[STREAM_HEADER_SIZE];
+  uint16_t _pos;       // Byte position inside the header, data or CRC
+  uint16_t _crc;       // Running CRC
+  uint16_t _crc_rx;    // Received CRC
+  uint8_t *_dst;       // Where the RGB data goes, inside the receiving slot
+  uint16_t _n_bytes;   // Number of RGB data bytes
+  uint8_t _rx_slot;    // Receiving slot
+  int16_t _seq = -1;   // Last sequence number, -1: none yet
+
+  bool _active = false;
+  uint32_t _tick_rx;   // [ms] `millis()` at the last received byte
+  uint32_t _tick_play; // [ms] `millis()` at the last released frame
+
+  StreamCounters _counters;
+
+  bool start_packet() {
+    /* Validate the header and prepare the receiving slot. Returns false when
+    the header is invalid.
+    */
+    uint8_t type = _header[2];
+    uint16_t first = _header[4] | _header[5] << 8;
+    uint16_t n = _header[6] | _header[7] << 8;
+
+    if (type == STREAM_TYPE_END) {
+      return n == 0;
+    }
+    if (((type != STREAM_TYPE_FRAME) && (type != STREAM_TYPE_PARTIAL)) ||
+        ((uint32_t)first + n > FLC::N)) {
+      return false;
+    }
+
+    // The slot past the buffered frames is always spare. It never holds the
+    // newest frame, which is either buffered or has been released into
+    // `leds`.
+    _rx_slot = (_head + _count) % N_SLOTS;
+
+    CRGB *slot = _slots[_rx_slot];
+    if ((type == STREAM_TYPE_PARTIAL) && _newest) {
+      memcpy8(slot, _newest, FLC::N * sizeof(CRGB));
+    } else {
+      fill_solid(slot, FLC::N, CRGB::Black);
+    }
+    _dst = (uint8_t *)&slot[first];
+    _n_bytes = 3 * n;
+    return true;
+  }
+
+  void end_packet() {
+    uint8_t type = _header[2];
+    uint8_t seq = _header[3];
+
+    if (_crc != _crc_rx) {
+      _counters.crc++;
+      return;
+    }
+    if (_seq >= 0) {
+      uint8_t gap = seq - _seq - 1;
+      if (gap >= 128) {
+        // At or behind the last sequence number
+        _counters.dup++;
+        return;
+      }
+      _counters.lost += gap;
+    }
+    _seq = seq;
+
+    if (type == STREAM_TYPE_END) {
+      stop();
+      return;
+    }
+
+    // Make room in the jitter buffer, dropping the oldest frame if needed
+    if (_count == FLC::STREAM_DEPTH) {
+      _head = (_head + 1) % N_SLOTS;
+      _count--;
+      _counters.overflow++;
+    }
+    _newest = _slots[_rx_slot];
+    _count++;
+    _counters.received++;
+  }
+
+  void parse(uint8_t c) {
+    switch (_state) {
+      case SYNC_0:
+        if (c == STREAM_SYNC_0) {
+          _state = SYNC_1;
+        }
+        break;
+
+      case SYNC_1:
+        _state = (c == STREAM_SYNC_1)   ? HEADER
+                 : (c == STREAM_SYNC_0) ? SYNC_1
+                                        : SYNC_0;
+        _pos = 2;
+        _crc = 0xFFFF;
+        break;
+
+      case HEADER:
+        _header[_pos++] = c;
+        _crc = crc16_ccitt(_crc, c);
+        if (_pos == STREAM_HEADER_SIZE) {
+          if (!start_packet()) {
+            _state = SYNC_0;
+            break;
+          }
+          _pos = 0;
+          _state = _n_bytes ? DATA : CRC;
+        }
+        break;
+
+      case DATA:
+        _dst[_pos++] = c; // Zero-copy: straight into the jitter buffer
+        _crc = crc16_ccitt(_crc, c);
+        if (_pos == _n_bytes) {
+          _pos = 0;
+          _state = CRC;
+        }
+        break;
+
+      case CRC:
+        if (_pos++ == 0) {
+          _crc_rx = c;
+        } else {
+          _crc_rx |= c << 8;
+          end_packet();
+          _state = SYNC_0;
+        }
+        break;
+    }
+  }
+
+public:
+  FrameStream() {
+    for (uint8_t i = 0; i < N_SLOTS; i++) {
+      _slots[i] = _storage[i];
+    }
+  }
+
+  void start() {
+    _head = 0;
+    _count = 0;
+    _newest = nullptr;
+    _prebuffering = true;
+    _state = SYNC_0;
+    _seq = -1;
+    _counters = StreamCounters();
+    _tick_rx = millis();
+    _active = true;
+  }
+
+  void stop() {
+    _active = false;
+  }
+
+  bool is_active() { return _active; }
+
+  void poll(Stream *mySerial) {
+    /* Parse all bytes available right now, without blocking. To be called
+    every loop iteration while active.
+    */
+    int n = mySerial->available();
+
+    if (!_active) {
+      return;
+    }
+    if (n > 0) {
+      _tick_rx = millis();
+    } else if (millis() - _tick_rx > FLC::STREAM_TIMEOUT) {
+      stop();
+    }
+    while ((n-- > 0) && _active) {
+      parse(mySerial->read());
+    }
+  }
+
+  bool playout(CRGB *&out) {
+    /* Release the oldest buffered frame once per `FLC::STREAM_PERIOD`, by
+    swapping buffers with `out`, i.e. `leds`. Returns true when `out` got
+    swapped. The caller must point the LED output at the new `out`, see
+    `map_leds_to_output()`.
+    */
+    uint32_t now = millis();
+
+    if (_prebuffering) {
+      if (_count < FLC::STREAM_DEPTH / 2 + 1) {
+        return false;
+      }
+      _prebuffering = false;
+      _tick_play = now - FLC::STREAM_PERIOD;
+    }
+    if (now - _tick_play < FLC::STREAM_PERIOD) {
+      return false;
+    }
+    _tick_play += FLC::STREAM_PERIOD;
+    if (now - _tick_play >= FLC::STREAM_PERIOD) {
+      _tick_play = now;
+    }
+
+    // The slot currently being received into lies beyond `_count`
+    if (_count == 0) {
+      _counters.underrun++;
+      _prebuffering = true;
+      return false;
+    }
+    CRGB *frame = _slots[_head];
+    _slots[_head] = out;
+    out = frame;
+    _head = (_head + 1) % N_SLOTS;
+    _count--;
+    return true;
+  }
+
+  const StreamCounters &counters() { return _counters; }
+
+  void print_counters(Stream *mySerial) {
+    mySerial->print("Stream received: ");
+    mySerial->print(_counters.received);
+    mySerial->print(", crc: ");
+    mySerial->print(_counters.crc);
+    mySerial->print(", lost: ");
+    mySerial->print(_counters.lost);
+    mySerial->print(", dup: ");
+    mySerial->print(_counters.dup);
+    mySerial->print(", overflow: ");
+    mySerial->print(_counters.overflow);
+    mySerial->print(", underrun: ");
+    mySerial->println(_counters.underrun);
+  }
+};
+
+FrameStream frame_stream;
+
+#endif
@@ -7,16 +7,25 @@ copied/mirrored across by the FastLED_Segmenter to the full LED strip.
 There are different styles that can be choosen, in either 1, 2 or 4-fold
 symmetry.
 
-    Expects a layout like an infinity mirror with 4 equal sides of length `L`,
-    making up the full `out` array of size `N`:
+    Expects a layout like an infinity mirror with a bottom and top side of
+    length `W` and a right and left side of length `H`, making up the full `out`
+    array of size `N`. See `DvG_FastLED_Geometry.h`.
 
-            L
+            W
        ┌────<────┐
        │         │
-    L  v         ^  L
+    H  v         ^  H
        │         │
        0────>────┘
-            L
+            W
+
+The segmenter derives the base pattern length `s` and an index mapping from
+the geometry, each time the style or geometry gets set. `process()` then
+simply gathers `out[idx] = in[map[idx]]`, whatever the geometry. The diagrams
+below show a square mirror, i.e. `W` = `H` = `L`. For rectangular mirrors, the
+styles with 4-fold symmetry resample the base pattern onto the sides that are
+shorter than `s`. For multiple panels, each panel shows the same segmented
+pattern, except for style `FULL_STRIP` which spans all panels.
 
 Dennis van Gils
 04-12-2021
@@ -26,6 +35,7 @@ Dennis van Gils
 
 #include <Arduino.h>
 
+#include "DvG_FastLED_Geometry.h"
 #include "DvG_FastLED_config.h"
 #include "FastLED.h"
 
@@ -35,7 +45,6 @@ Dennis van Gils
 
 #define STYLE_NAME_LEN 64
 #define CRGB_SIZE sizeof(CRGB)
-#define CRGB_SIZE_L (FLC::L * CRGB_SIZE)
 
 enum StyleEnum {
   FULL_STRIP,
@@ -63,56 +72,34 @@ const char *style_names[] = {"Full strip",
 
 class FastLED_StripSegmenter {
 private:
-  int L = FLC::L;
-  int N = FLC::N;
-
+  const Geometry *_geom;
   uint16_t s; // = get_base_numel()
   StyleEnum _style;
+  uint16_t _map[FLC::N]; // Index mapping: out[idx] = in[_map[idx]]
 
-  void flip(CRGB *out, const CRGB *in, uint16_t numel) {
-    for (uint16_t idx = 0; idx < numel; idx++) {
-      out[idx] = in[numel - idx - 1];
-    }
-  }
-
-public:
-  FastLED_StripSegmenter() {
-    /* */
-    set_style(StyleEnum::FULL_STRIP);
+  uint16_t resample(uint16_t j, uint16_t n) {
+    // Index into the base pattern of length `s` for element `j` of a side of
+    // length `n`. The identity when `n` equals `s`.
+    return (uint32_t)j * s / n;
   }
 
-  /*----------------------------------------------------------------------------
-    process
-  ----------------------------------------------------------------------------*/
-
-  void process(CRGB *out, const CRGB *in) {
-    /* Copy/mirror the base array `in` across the full output array `out` using
-    1, 2 or 4-fold symmetry as dictated by the currently selected style.
-
-    Expects a layout like an infinity mirror with 4 equal sides of length `L`,
-    making up the full `out` array of size `N`:
-
-            L
-       ┌────<────┐
-       │         │
-    L  v         ^  L
-       │         │
-       0────>────┘
-            L
-
-    TODO: Mention `s`
-    Calculate the LED data array of the current effect, i.e. the base pattern.
-    The array is calculated up to length `s` as dictated by the current
-    StripSegmenter style.
-    s = segmntr.get_base_numel(); // CRITICAL
+  void build_map() {
+    /* Derive the base pattern length `s` and the index mapping of the first
+    panel from the geometry and the current style, and copy the mapping over to
+    the other panels.
     */
-    uint16_t idx; // LED position index reused in the for-loops
+    const Geometry &g = *_geom;
+    const uint16_t W = g.width;
+    const uint16_t H = g.height;
+    const uint16_t P = g.perimeter();
+    uint16_t j, n, b; // Index, length and start of a side
+    uint8_t side;
 
     switch (_style) {
       case StyleEnum::COPIED_SIDES:
         /* Copied sides
 
-            0 1 2 3                           s = L
+            0 1 2 3                           s = max(W, H)
             A B C D
                ↓
             D C B A
@@ -123,17 +110,19 @@ public:
             A B C D      →  A B C D / A B C D / A B C D / A B C D
         */
         // clang-format off
-        memcpy8(&out[0    ], &in[0], CRGB_SIZE_L); // bottom
-        memcpy8(&out[L    ], &in[0], CRGB_SIZE_L); // right
-        memcpy8(&out[L * 2], &in[0], CRGB_SIZE_L); // top
-        memcpy8(&out[L * 3], &in[0], CRGB_SIZE_L); // left
+        s = max(W, H);
+        for (side = 0; side < 4; side++) {
+          n = g.side(side);
+          b = g.side_start(side);
+          for (j = 0; j < n; j++) {_map[b + j] = resample(j, n);}
+        }
         // clang-format on
         break;
 
       case StyleEnum::PERIO_OPP_CORNERS_N4:
         /* Periodic opposite corners, N = 4
 
-            0 1 2 3                           s = L
+            0 1 2 3                           s = max(W, H)
             A B C D
                ↓
             D C B A
@@ -155,16 +144,21 @@ public:
             A B C D E    →  A B C D E / E D C B A / A B C D E / E D C B A
         */
         // clang-format off
-        memcpy8(&out[0    ], &in[0] , CRGB_SIZE_L    ); // bottom
-        flip   (&out[L    ], &in[0] , L              ); // right
-        memcpy8(&out[L * 2], &out[0], CRGB_SIZE_L * 2); // top & left
+        s = max(W, H);
+        for (side = 0; side < 4; side++) {
+          n = g.side(side);
+          b = g.side_start(side);
+          for (j = 0; j < n; j++) {
+            _map[b + j] = resample(side % 2 ? n - j - 1 : j, n);
+          }
+        }
         // clang-format on
         break;
 
       case StyleEnum::PERIO_OPP_CORNERS_N2:
         /* Periodic opposite corners, N = 2
 
-            0 1 2 3 4 5 6 7                   s = L * 2
+            0 1 2 3 4 5 6 7                   s = W + H
             A B C D E F G H
                ↓
             E F G H
@@ -186,15 +180,18 @@ public:
             A B C D E    →  A B C D E / F G H I J / J I H G F / E D C B A
         */
         // clang-format off
-        memcpy8(&out[0    ], &in[0], CRGB_SIZE_L * 2); // bottom & right
-        flip   (&out[L * 2], &in[0], L * 2          ); // top & left
+        s = W + H;
+        for (j = 0; j < s; j++) {
+          _map[j    ] = j;                                   // bottom & right
+          _map[j + s] = s - j - 1;                           // top & left
+        }
         // clang-format on
         break;
 
       case StyleEnum::UNI_DIR_SIDE2SIDE:
         /* Uni-directional side-to-side
 
-            0 1 2 3 4 5                       s = L + 2
+            0 1 2 3 4 5                       s = H + 2
             A B C D E F
                ↓
             F F F F
@@ -216,19 +213,22 @@ public:
             A A A A A    →  A A A A A / B C D E F / G G G G G / F E D C B
         */
         // clang-format off
-        for (idx = 0; idx < L; idx++) {
-          out[idx        ] = in[0      ];      // bottom
-          out[idx + L * 2] = in[L + 1  ];      // top
-          out[idx + L * 3] = in[L - idx];      // left
+        s = H + 2;
+        for (j = 0; j < W; j++) {
+          _map[j            ] = 0;                           // bottom
+          _map[j + W + H    ] = H + 1;                       // top
+        }
+        for (j = 0; j < H; j++) {
+          _map[j + W        ] = j + 1;                       // right
+          _map[j + W * 2 + H] = H - j;                       // left
         }
-        memcpy8(&out[L], &in[1], CRGB_SIZE_L); // right
         // clang-format on
         break;
 
       case StyleEnum::BI_DIR_SIDE2SIDE:
         /* Bi-directional side-to-side
 
-            0 1 2                             s = (L + 1) / 2 + 1
+            0 1 2                             s = (H + 1) / 2 + 1
             A B C
                ↓
             A A A A
@@ -256,18 +256,23 @@ public:
           L = 7 -> s = 5
         */
         // clang-format off
-        for (idx = 0; idx < L; idx++) {
-          out[idx    ] = in[0];                                   // bottom
-          out[idx + L] = in[(idx < (L / 2) ? idx + 1 : L - idx)]; // right
+        s = (H + 1) / 2 + 1;
+        for (j = 0; j < W; j++) {
+          _map[j        ] = 0;                               // bottom
+        }
+        for (j = 0; j < H; j++) {
+          _map[j + W    ] = (j < (H / 2) ? j + 1 : H - j);   // right
+        }
+        for (j = 0; j < W + H; j++) {
+          _map[j + W + H] = _map[j];                         // top & left
         }
-        memcpy8(&out[L * 2], &out[0], CRGB_SIZE_L * 2);           // top & left
         // clang-format on
         break;
 
       case StyleEnum::HALFWAY_PERIO_SPLIT_N2:
         /* Half-way periodic split, N = 2
 
-            0 1 2 3                           s = ((L + 1) / 2) * 2
+            0 1 2 3                           s = (W + 1) / 2 + (H + 1) / 2
             A B C D
                ↓
             B A A B
@@ -294,15 +299,17 @@ public:
           L = 6 -> s = 6
           L = 7 -> s = 8
         */
-
         // clang-format off
-        memcpy8(&out[L / 2], &in[0], CRGB_SIZE_L);      // corner bottom-right
-        for (idx = 0; idx < s / 2; idx++) {
-          out[idx + L / 2 + L] = in[s - idx - 1];       // right-top
-          if (idx == L / 2) {continue;}
-          out[idx] = in[s / 2 - idx - 1];               // bottom-left
+        s = (W + 1) / 2 + (H + 1) / 2;
+        for (j = 0; j < W; j++) {                            // bottom
+          _map[j        ] = (j >= W / 2 ? j - W / 2 : W - j - 1 - W / 2);
+        }
+        for (j = 0; j < H; j++) {                            // right
+          _map[j + W    ] = (W + 1) / 2 + min(j, (uint16_t)(H - j - 1));
+        }
+        for (j = 0; j < W + H; j++) {
+          _map[j + W + H] = _map[j];                         // top & left
         }
-        memcpy8(&out[L * 2], &out[0], CRGB_SIZE_L * 2); // top & left
         // clang-format on
         break;
 
@@ -317,41 +324,90 @@ public:
           P         E
             A B C D
         */
-        memcpy8(out, in, CRGB_SIZE * N);
-        break;
+        s = g.numel();
+        for (uint32_t idx = 0; idx < g.numel(); idx++) {
+          _map[idx] = idx;
+        }
+        return;
+    }
+
+    for (uint32_t idx = P; idx < g.numel(); idx++) {
+      _map[idx] = _map[idx % P];
     }
   }
 
+public:
+  FastLED_StripSegmenter(const Geometry &geom = FLC::GEOMETRY) {
+    /* */
+    _geom = &geom;
+    set_style(StyleEnum::FULL_STRIP);
+  }
+
+  /*----------------------------------------------------------------------------
+    process
+  ----------------------------------------------------------------------------*/
+
+  void process(CRGB *out, const CRGB *in) {
+    /* Copy/mirror the base array `in` across the full output array `out` using
+    1, 2 or 4-fold symmetry as dictated by the currently selected style.
+
+    Expects a layout like an infinity mirror with a bottom and top side of
+    length `W` and a right and left side of length `H`, making up the full
+    `out` array of size `N`:
+
+            W
+       ┌────<────┐
+       │         │
+    H  v         ^  H
+       │         │
+       0────>────┘
+            W
+
+    The base array `in` must be calculated up to length `s` as dictated by the
+    current style and geometry:
+    s = segmntr.get_base_numel(); // CRITICAL
+
+    O(N) for every style: a single pass over the pre-calculated mapping.
+    */
+    const uint32_t N = _geom->numel();
+
+    if (_style == StyleEnum::FULL_STRIP) {
+      memcpy8(out, in, CRGB_SIZE * N);
+      return;
+    }
+    for (uint32_t idx = 0; idx < N; idx++) {
+      out[idx] = in[_map[idx]];
+    }
+  }
+
+  /*----------------------------------------------------------------------------
+    geometry
+  ----------------------------------------------------------------------------*/
+
+  bool set_geometry(const Geometry &geom) {
+    /* Switch over to another geometry, which must be valid and must fit inside
+    the LED data arrays of length `FLC::N`. The geometry object must outlive
+    the segmenter. Returns false when rejected.
+    */
+    if (!geom.is_valid() || (geom.numel() > (uint32_t)FLC::N)) {
+      return false;
+    }
+    _geom = &geom;
+    build_map();
+    return true;
+  }
+
+  const Geometry &get_geometry() {
+    return *_geom;
+  }
+
   /*----------------------------------------------------------------------------
     style
   ----------------------------------------------------------------------------*/
 
   void set_style(StyleEnum style) {
     _style = style;
-    switch (_style) {
-      case StyleEnum::COPIED_SIDES:
-        s = L;
-        break;
-      case StyleEnum::PERIO_OPP_CORNERS_N4:
-        s = L;
-        break;
-      case StyleEnum::PERIO_OPP_CORNERS_N2:
-        s = L * 2;
-        break;
-      case StyleEnum::UNI_DIR_SIDE2SIDE:
-        s = L + 2;
-        break;
-      case StyleEnum::BI_DIR_SIDE2SIDE:
-        s = (L + 1) / 2 + 1;
-        break;
-      case StyleEnum::HALFWAY_PERIO_SPLIT_N2:
-        s = ((L + 1) / 2) * 2;
-        break;
-      case StyleEnum::FULL_STRIP:
-      default:
-        s = N;
-        break;
-    }
+    build_map();
   }
 
   StyleEnum next_style() {
@@ -376,6 +432,19 @@ public:
     snprintf(buffer, STYLE_NAME_LEN, style_names[int(_style)]);
   }
 
+  /*----------------------------------------------------------------------------
+    get_map
+  ----------------------------------------------------------------------------*/
+
+  const uint16_t *get_map() {
+    /* Return the index mapping of `process()`, i.e. element `idx` of the full
+    strip shows element `get_map()[idx]` of the base pattern. Lets several
+    layers get segmented and blended in a single pass, see
+    `DvG_FastLED_Layers.h`.
+    */
+    return _map;
+  }
+
   /*----------------------------------------------------------------------------
     get_base_numel
   ----------------------------------------------------------------------------*/
@@ -0,0 +1,643 @@
+/* DvG_FastLED_VM.h
+
+Compact register-based bytecode interpreter to run effects that got uploaded
+over serial, without reflashing the firmware. To be included inside
+`DvG_FastLED_effects.h`.
+
+A program calculates the base pattern `fx1` up to length `s`, once per frame.
+Segmenting it across the full strip by `segmntr1`, blending it in from the
+snapshot and the duration check are taken care of by the `fx__VM...` effects,
+just like for the native effects.
+
+Registers
+---------
+16 registers `r0` to `r15` of type int32, persistent from frame to frame and
+zeroed when the effect starts. The upper four get set by the interpreter:
+  r12: N  , number of LEDs of the full strip
+  r13: s  , base pattern length as dictated by the segmenter style
+  r14: idx, LED index inside a `LOOP`
+  r15: t  , [ms] time since the start of the effect
+
+Instructions
+------------
+Fixed length of 4 bytes: opcode, a, b, c. Register operands are taken modulo
+16. `imm16` is the signed 16-bit value `b | c << 8`. Arithmetic wraps around
+at 32 bits.
+
+  op    name   operation
+  0x00  END    end of program
+  0x01  LDI    ra = imm16
+  0x02  MOV    ra = rb
+  0x03  ADD    ra = rb + rc
+  0x04  SUB    ra = rb - rc
+  0x05  MUL    ra = rb * rc
+  0x06  MULF   ra = (rb * rc) >> 8, 8.8 fixed-point multiply
+  0x07  DIV    ra = rb / rc, 0 when rc == 0
+  0x08  AND    ra = rb & rc
+  0x09  SHR    ra = rb >> c
+  0x0A  MIN    ra = min(rb, rc)
+  0x0B  MAX    ra = max(rb, rc)
+  0x10  LOOP   for idx in [0, s): run the instructions up to `ENDL`
+  0x11  ENDL   end of `LOOP`, loops cannot be nested
+  0x12  EVERY  skip the next instruction, unless imm16 ms have passed
+  0x13  SKIPZ  skip the next instruction when ra == 0
+  0x20  BSIN   ra = beatsin8(bpm = rb, 0, 255, timebase, phase = rc)
+  0x21  SIN8   ra = sin8(rb)
+  0x22  RAND8  ra = random8()
+  0x23  GAUSS  Gaussian over the full strip at mu = ra, sigma = rb / 256
+  0x24  LDG    ra = Gaussian at idx, [0 - 255]
+  0x30  HSV    fx1[idx] = CHSV(ra, rb, rc)
+  0x31  PAL    fx1[idx] = ColorFromPalette(palette c, index ra, bright rb)
+  0x32  ADDHSV fx1[idx] += CHSV(ra, rb, rc)
+  0x33  FADE   fadeToBlackBy(fx1, s, ra)
+  0x34  BLUR   blur1d(fx1, s, ra)
+
+Palettes: 0: Rainbow, 1: custom_palette_1, 2: Ocean, 3: Lava, 4: Heat
+
+There are no jumps, only the bounded `LOOP` and the forward skips, so every
+program terminates within `VM_MAX_INSTR * (s + 1)` steps. `SKIPZ` and `EVERY`
+must not precede `LOOP` or `ENDL`, as skipping those would unbalance the loop.
+
+Each `EVERY` has a timer of its own, by its position in the program, up to
+`VM_MAX_EVERY` of them. Inside a `LOOP` its timer restarts at the first `idx`
+it fires at, so it gates a single `idx` per period.
+
+Overhead
+--------
+The interpreter dispatches each instruction through a single `switch` and
+keeps the registers in a local array. Running the built-in `vm_demo_program`
+takes about 3.6 times as long as the identical native loop of `DoubleWave`
+when measured on a host PC. It should stay within 5 times. Serial command 'b'
+measures the ratio on the device, see `benchmark_vm()`.
+
+Upload and storage
+------------------
+Serial command 'u' followed by the slot number [0 - 3], the program as a
+string of hex digits and a newline, e.g. `u0 01000a00 ... 00000000\n`.
+Whitespace inside the hex string is ignored. The last byte is a checksum
+making the 8-bit sum of all bytes equal to 0. `VM_Upload` parses the bytes as
+they come in, without blocking the main loop, and gives up after
+`VM_UPLOAD_TIMEOUT` ms of silence. Valid programs get stored in an
+8 kB block of the internal flash and survive a reset. Each slot is selectable
+as `FX_preset(fx__VM0, ...)` to `fx__VM3`. An empty slot runs the built-in
+`vm_demo_program`.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_FASTLED_VM_H
+#define DVG_FASTLED_VM_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "FastLED.h"
+
+// External functions defined in `DvG_FastLED_functions.h`
+void profile_gauss8strip(uint8_t gauss8[FLC::N], uint16_t mu, float sigma);
+
+// External variables defined in `DvG_FastLED_effects.h`
+extern CRGBPalette16 custom_palette_1;
+
+/*------------------------------------------------------------------------------
+  Program format
+------------------------------------------------------------------------------*/
+
+#define VM_SLOTS 4
+#define VM_MAX_INSTR 64
+#define VM_MAX_EVERY 8
+#define VM_MAGIC 0x4D565846 // "FXVM"
+#define VM_UPLOAD_TIMEOUT 2000 // [ms]
+
+enum VM_Opcode : uint8_t {
+  VM_END = 0x00,
+  VM_LDI = 0x01,
+  VM_MOV = 0x02,
+  VM_ADD = 0x03,
+  VM_SUB = 0x04,
+  VM_MUL = 0x05,
+  VM_MULF = 0x06,
+  VM_DIV = 0x07,
+  VM_AND = 0x08,
+  VM_SHR = 0x09,
+  VM_MIN = 0x0A,
+  VM_MAX = 0x0B,
+  VM_LOOP = 0x10,
+  VM_ENDL = 0x11,
+  VM_EVERY = 0x12,
+  VM_SKIPZ = 0x13,
+  VM_BSIN = 0x20,
+  VM_SIN8 = 0x21,
+  VM_RAND8 = 0x22,
+  VM_GAUSS = 0x23,
+  VM_LDG = 0x24,
+  VM_HSV = 0x30,
+  VM_PAL = 0x31,
+  VM_ADDHSV = 0x32,
+  VM_FADE = 0x33,
+  VM_BLUR = 0x34,
+};
+
+struct VM_Instr {
+  uint8_t op;
+  uint8_t a;
+  uint8_t b;
+  uint8_t c;
+};
+
+struct VM_Program {
+  uint32_t magic;   // `VM_MAGIC` when the slot holds a valid program
+  uint16_t n_instr; // Number of instructions, `END` included
+  uint16_t reserved;
+  VM_Instr code[VM_MAX_INSTR];
+};
+
+// Built-in program, equivalent to the native effect `DoubleWave`
+// clang-format off
+const VM_Instr vm_demo_program[] = {
+  {VM_LDI , 0, 255, 0},   // r0 = 255
+  {VM_LDI , 1, 1  , 0},   // r1 = 1
+  {VM_SUB , 1, 12 , 1},   // r1 = N - 1
+  {VM_LDI , 2, 10 , 0},   // r2 = 10 bpm
+  {VM_LDI , 3, 20 , 0},   // r3 = 20 bpm
+  {VM_LOOP, 0, 0  , 0},
+  {VM_MUL , 4, 14 , 0},   //   r4 = idx * 255
+  {VM_DIV , 4, 4  , 1},   //   r4 = idx * 255 / (N - 1)
+  {VM_BSIN, 4, 2  , 4},   //   r4 = beatsin8(10, 0, 255, timebase, r4)
+  {VM_BSIN, 4, 3  , 4},   //   r4 = beatsin8(20, 0, 255, timebase, r4)
+  {VM_HSV , 4, 0  , 0},   //   fx1[idx] = CHSV(r4, 255, 255)
+  {VM_ENDL, 0, 0  , 0},
+  {VM_END , 0, 0  , 0},
+};
+// clang-format on
+
+bool vm_validate(const VM_Instr *code, uint16_t n_instr) {
+  /* Check a program before it gets accepted: known opcodes, balanced and
+  non-nested loops, no skips onto `LOOP` or `ENDL`, a limited number of `EVERY`
+  timers and a final `END`.
+  */
+  bool in_loop = false;
+  uint8_t n_every = 0;
+
+  if ((n_instr == 0) || (n_instr > VM_MAX_INSTR) ||
+      (code[n_instr - 1].op != VM_END)) {
+    return false;
+  }
+  for (uint16_t pc = 0; pc < n_instr; pc++) {
+    if (((code[pc].op == VM_SKIPZ) || (code[pc].op == VM_EVERY)) &&
+        ((code[pc + 1].op == VM_LOOP) || (code[pc + 1].op == VM_ENDL))) {
+      return false;
+    }
+    switch (code[pc].op) {
+      case VM_LOOP:
+        if (in_loop) {
+          return false;
+        }
+        in_loop = true;
+        break;
+      case VM_ENDL:
+        if (!in_loop) {
+          return false;
+        }
+        in_loop = false;
+        break;
+      case VM_EVERY:
+        if (++n_every > VM_MAX_EVERY) {
+          return false;
+        }
+        break;
+      case VM_END:
+        if (pc != n_instr - 1) {
+          return false;
+        }
+        break;
+      case VM_LDI:
+      case VM_MOV:
+      case VM_ADD:
+      case VM_SUB:
+      case VM_MUL:
+      case VM_MULF:
+      case VM_DIV:
+      case VM_AND:
+      case VM_SHR:
+      case VM_MIN:
+      case VM_MAX:
+      case VM_SKIPZ:
+      case VM_BSIN:
+      case VM_SIN8:
+      case VM_RAND8:
+      case VM_GAUSS:
+      case VM_LDG:
+      case VM_HSV:
+      case VM_PAL:
+      case VM_ADDHSV:
+      case VM_FADE:
+      case VM_BLUR:
+        break;
+      default:
+        return false;
+    }
+  }
+  return !in_loop;
+}
+
+/*------------------------------------------------------------------------------
+  Flash storage
+------------------------------------------------------------------------------*/
+
+#define VM_FLASH_BLOCK_SIZE 8192
+
+static_assert(sizeof(VM_Program) * VM_SLOTS <= VM_FLASH_BLOCK_SIZE,
+              "VM programs do not fit inside a single flash block");
+
+// Reserved erase block of the internal flash, holding all program slots. On
+// the host PC a block of RAM instead.
+#ifdef DVG_HOST
+volatile uint8_t vm_flash[VM_FLASH_BLOCK_SIZE] = {0};
+#else
+__attribute__((__aligned__(VM_FLASH_BLOCK_SIZE))) const volatile uint8_t
+    vm_flash[VM_FLASH_BLOCK_SIZE] = {0};
+#endif
+
+const VM_Program *vm_flash_slot(uint8_t slot) {
+  return (const VM_Program *)&vm_flash[slot * sizeof(VM_Program)];
+}
+
+bool vm_store(uint8_t slot, const VM_Instr *code, uint16_t n_instr) {
+  /* Validate the program and write it into the flash slot, keeping the other
+  slots. Returns false when rejected.
+  */
+  static VM_Program block[VM_SLOTS]; // RAM copy of all slots
+
+  if ((slot >= VM_SLOTS) || !vm_validate(code, n_instr)) {
+    return false;
+  }
+  for (uint8_t i = 0; i < VM_SLOTS; i++) {
+    memcpy(&block[i], (const void *)vm_flash_slot(i), sizeof(VM_Program));
+  }
+  block[slot].magic = VM_MAGIC;
+  block[slot].n_instr = n_instr;
+  block[slot].reserved = 0;
+  memcpy(block[slot].code, code, n_instr * sizeof(VM_Instr));
+
+#ifdef __SAMD51__
+  const uint32_t *src = (const uint32_t *)block;
+  volatile uint32_t *dst = (volatile uint32_t *)vm_flash;
+  uint32_t n_words = sizeof(block) / 4;
+
+  noInterrupts();
+  NVMCTRL->CTRLA.bit.WMODE = NVMCTRL_CTRLA_WMODE_MAN;
+  while (!NVMCTRL->STATUS.bit.READY) {}
+
+  // Erase the block
+  NVMCTRL->ADDR.reg = (uint32_t)vm_flash;
+  NVMCTRL->CTRLB.reg = NVMCTRL_CTRLB_CMDEX_KEY | NVMCTRL_CTRLB_CMD_EB;
+  while (!NVMCTRL->STATUS.bit.READY) {}
+
+  // Write page by page, 512 bytes each
+  while (n_words) {
+    NVMCTRL->CTRLB.reg = NVMCTRL_CTRLB_CMDEX_KEY | NVMCTRL_CTRLB_CMD_PBC;
+    while (!NVMCTRL->STATUS.bit.READY) {}
+    for (uint8_t i = 0; (i < 128) && n_words; i++, n_words--) {
+      *dst++ = *src++;
+    }
+    NVMCTRL->CTRLB.reg = NVMCTRL_CTRLB_CMDEX_KEY | NVMCTRL_CTRLB_CMD_WP;
+    while (!NVMCTRL->STATUS.bit.READY) {}
+  }
+
+  // Invalidate the cache, it might hold the old contents
+  CMCC->CTRL.bit.CEN = 0;
+  while (CMCC->SR.bit.CSTS) {}
+  CMCC->MAINT0.bit.INVALL = 1;
+  CMCC->CTRL.bit.CEN = 1;
+  interrupts();
+#elif defined(DVG_HOST)
+  memcpy((void *)vm_flash, block, sizeof(block));
+#endif
+
+  return true;
+}
+
+/*------------------------------------------------------------------------------
+  FastLED_VM
+------------------------------------------------------------------------------*/
+
+class FastLED_VM {
+private:
+  const VM_Instr *_code;
+  uint16_t _n_instr;
+  int32_t _r[16];
+  uint32_t _t0;                          // [ms] `millis()` at `reset()`
+  uint32_t _timebase;                    // [ms] Timebase for `beatsin8()`
+  uint32_t _every_tick[VM_MAX_EVERY];    // [ms] Last time each `EVERY` fired
+  uint8_t _every_slot[VM_MAX_INSTR];     // Timer of the `EVERY` at each pc
+  uint8_t _gauss8[FLC::N];
+
+  void select(const VM_Instr *code, uint16_t n_instr) {
+    /* Select a validated program and number its `EVERY` timers in order of
+    appearance
+    */
+    uint8_t n_every = 0;
+
+    _code = code;
+    _n_instr = n_instr;
+    for (uint16_t pc = 0; pc < n_instr; pc++) {
+      _every_slot[pc] = n_every;
+      if (code[pc].op == VM_EVERY) {
+        n_every++;
+      }
+    }
+  }
+
+  const CRGBPalette16 &palette(uint8_t idx) {
+    static const CRGBPalette16 palettes[] = {
+        RainbowColors_p, custom_palette_1, OceanColors_p, LavaColors_p,
+        HeatColors_p};
+    return palettes[idx % (sizeof(palettes) / sizeof(palettes[0]))];
+  }
+
+public:
+  FastLED_VM() {
+    select(vm_demo_program, sizeof(vm_demo_program) / sizeof(VM_Instr));
+  }
+
+  bool load(uint8_t slot) {
+    /* Select the program of a flash slot, or the built-in program when the
+    slot is empty. Returns true when the slot holds a program.
+    */
+    const VM_Program *prog = vm_flash_slot(slot % VM_SLOTS);
+    bool valid =
+        (prog->magic == VM_MAGIC) && vm_validate(prog->code, prog->n_instr);
+    if (valid) {
+      select(prog->code, prog->n_instr);
+    } else {
+      select(vm_demo_program, sizeof(vm_demo_program) / sizeof(VM_Instr));
+    }
+    return valid;
+  }
+
+  void reset(uint32_t now) {
+    memset(_r, 0, sizeof(_r));
+    memset(_every_tick, 0, sizeof(_every_tick));
+    _t0 = _timebase = now;
+  }
+
+  void run(CRGB *fx, uint16_t s, uint32_t now) {
+    /* Run the program once, calculating the base pattern `fx` up to length
+    `s`
+    */
+    int32_t *r = _r;
+    uint16_t pc = 0;
+    uint16_t pc_loop = 0; // Program counter of the first instruction in a loop
+
+    r[12] = FLC::N;
+    r[13] = s;
+    r[14] = 0;
+    r[15] = now - _t0;
+
+    while (pc < _n_instr) {
+      const uint16_t pc_in = pc;
+      const VM_Instr &in = _code[pc++];
+      int32_t &ra = r[in.a & 15];
+      int32_t rb = r[in.b & 15];
+      int32_t rc = r[in.c & 15];
+      uint16_t idx = r[14];
+
+      switch (in.op) {
+        // clang-format off
+        case VM_LDI : ra = (int16_t)(in.b | in.c << 8); break;
+        case VM_MOV : ra = rb; break;
+        case VM_ADD : ra = (uint32_t)rb + (uint32_t)rc; break;
+        case VM_SUB : ra = (uint32_t)rb - (uint32_t)rc; break;
+        case VM_MUL : ra = (uint32_t)rb * (uint32_t)rc; break;
+        case VM_MULF: ra = ((int64_t)rb * rc) >> 8; break;
+        case VM_DIV : ra = rc == -1 ? 0 - (uint32_t)rb
+                         : rc       ? rb / rc : 0; break;
+        case VM_AND : ra = rb & rc; break;
+        case VM_SHR : ra = rb >> (in.c & 31); break;
+        case VM_MIN : ra = min(rb, rc); break;
+        case VM_MAX : ra = max(rb, rc); break;
+        // clang-format on
+
+        case VM_LOOP:
+          if (s == 0) {
+            // Skip the loop body
+            while ((pc < _n_instr) && (_code[pc].op != VM_ENDL)) {
+              pc++;
+            }
+            pc++;
+          } else {
+            r[14] = 0;
+            pc_loop = pc;
+          }
+          break;
+
+        case VM_ENDL:
+          if (++r[14] < s) {
+            pc = pc_loop;
+          }
+          break;
+
+        case VM_EVERY: {
+          uint32_t &tick = _every_tick[_every_slot[pc_in]];
+          if (now - tick >= (uint16_t)(in.b | in.c << 8)) {
+            tick = now;
+          } else {
+            pc++;
+          }
+          break;
+        }
+
+        case VM_SKIPZ:
+          if (ra == 0) {
+            pc++;
+          }
+          break;
+
+        // clang-format off
+        case VM_BSIN : ra = beatsin8(rb, 0, 255, _timebase, rc); break;
+        case VM_SIN8 : ra = sin8(rb); break;
+        case VM_RAND8: ra = random8(); break;
+        case VM_LDG  : ra = _gauss8[idx < FLC::N ? idx : 0]; break;
+        // clang-format on
+
+        case VM_GAUSS:
+          profile_gauss8strip(_gauss8, (uint16_t)ra, rb / 256.f);
+          break;
+
+        case VM_HSV:
+          if (idx < s) {
+            fx[idx] = CHSV(ra, rb, rc);
+          }
+          break;
+
+        case VM_PAL:
+          if (idx < s) {
+            fx[idx] = ColorFromPalette(palette(in.c), ra, rb);
+          }
+          break;
+
+        case VM_ADDHSV:
+          if (idx < s) {
+            fx[idx] += CHSV(ra, rb, rc);
+          }
+          break;
+
+        case VM_FADE:
+          fadeToBlackBy(fx, s, ra);
+          break;
+
+        case VM_BLUR:
+          blur1d(fx, s, ra);
+          break;
+
+        case VM_END:
+        default:
+          return;
+      }
+    }
+  }
+};
+
+/*------------------------------------------------------------------------------
+  Benchmark
+------------------------------------------------------------------------------*/
+
+void benchmark_vm(Stream *mySerial, CRGB *fx, uint16_t s) {
+  /* Time the built-in `vm_demo_program` against the identical native loop of
+  effect `DoubleWave`, to keep track of the interpreter overhead
+  */
+  const uint16_t N_REPEAT = 100;
+  static FastLED_VM vm;
+  uint32_t timebase = millis();
+  uint32_t tick;
+  uint32_t t_1, t_2;
+
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    for (uint16_t idx = 0; idx < s; idx++) {
+      uint8_t c = (uint16_t)idx * 255 / (FLC::N - 1);
+      c = beatsin8(10, 0, 255, timebase, c);
+      c = beatsin8(20, 0, 255, timebase, c);
+      fx[idx] = CHSV(c, 255, 255);
+    }
+  }
+  t_1 = micros() - tick;
+
+  vm.reset(timebase);
+  tick = micros();
+  for (uint16_t rep = 0; rep < N_REPEAT; rep++) {
+    vm.run(fx, s, millis());
+  }
+  t_2 = micros() - tick;
+
+  mySerial->print("DoubleWave over ");
+  mySerial->print(s);
+  mySerial->println(" LEDs, [us] per frame");
+  mySerial->print("  Native: ");
+  mySerial->println((float)t_1 / N_REPEAT);
+  mySerial->print("  VM    : ");
+  mySerial->println((float)t_2 / N_REPEAT);
+  mySerial->print("  Ratio : ");
+  mySerial->println(t_1 ? (float)t_2 / t_1 : 0);
+}
+
+/*------------------------------------------------------------------------------
+  Serial upload
+------------------------------------------------------------------------------*/
+
+enum VM_UploadStatus { VM_UPLOAD_BUSY, VM_UPLOAD_OK, VM_UPLOAD_REJECTED };
+
+class VM_Upload {
+private:
+  uint8_t _buf[VM_MAX_INSTR * sizeof(VM_Instr) + 1]; // + checksum
+  uint16_t _n_bytes;
+  uint8_t _nibble;
+  bool _high;
+  uint8_t _checksum;
+  int _slot;
+  bool _error;
+  bool _active = false;
+  uint32_t _tick; // [ms] `millis()` at the last received byte
+
+  VM_UploadStatus finish() {
+    /* Check and store the complete program
+     */
+    _active = false;
+    if (_error || !_high || (_checksum != 0) ||
+        (_n_bytes < sizeof(VM_Instr) + 1) ||
+        ((_n_bytes - 1) % sizeof(VM_Instr))) {
+      return VM_UPLOAD_REJECTED;
+    }
+    return vm_store(_slot, (const VM_Instr *)_buf,
+                    (_n_bytes - 1) / sizeof(VM_Instr))
+               ? VM_UPLOAD_OK
+               : VM_UPLOAD_REJECTED;
+  }
+
+public:
+  void start() {
+    /* To be called on serial command 'u'
+     */
+    _n_bytes = 0;
+    _nibble = 0;
+    _high = true;
+    _checksum = 0;
+    _slot = -1;
+    _error = false;
+    _tick = millis();
+    _active = true;
+  }
+
+  bool is_active() { return _active; }
+
+  VM_UploadStatus poll(Stream *mySerial) {
+    /* Parse `<slot><hex string>\n` as send after serial command 'u', all bytes
+    available right now, without blocking. To be called every loop iteration
+    while active. After an invalid byte, the rest of the line still gets
+    consumed, so that it does not get taken for serial commands.
+    */
+    int n = mySerial->available();
+    int c;
+
+    if (n > 0) {
+      _tick = millis();
+    } else if (millis() - _tick > VM_UPLOAD_TIMEOUT) {
+      _active = false;
+      return VM_UPLOAD_REJECTED;
+    }
+    while (n-- > 0) {
+      c = mySerial->read();
+      if ((c == '\n') || (c == '\r')) {
+        return finish();
+      }
+      if (_error) {
+        continue;
+      }
+      if (_slot < 0) {
+        _slot = c - '0';
+        continue;
+      }
+      if (isspace(c)) {
+        continue;
+      }
+      if (!isxdigit(c) || (_n_bytes >= sizeof(_buf))) {
+        _error = true;
+        continue;
+      }
+      _nibble =
+          (_nibble << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+      if (!(_high = !_high)) {
+        continue;
+      }
+      _buf[_n_bytes++] = _nibble;
+      _checksum += _nibble;
+      _nibble = 0;
+    }
+    return VM_UPLOAD_BUSY;
+  }
+};
+
+VM_Upload vm_upload;
+
+#endif
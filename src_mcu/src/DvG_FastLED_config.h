@@ -3,8 +3,11 @@
 
 #include <Arduino.h>
 
+#include "DvG_FastLED_Geometry.h"
+
 namespace FLC {
-  /* Infinity mirror with 4 equal sides of length `L`.
+  /* Infinity mirror with 4 equal sides of length `L`, wired starting at the
+  bottom-left corner and running counter-clockwise.
 
             L
        ┌────<────┐
@@ -13,25 +16,105 @@ namespace FLC {
        │         │
        0────>────┘
             L
+
+  Other mirrors, e.g. rectangular ones, ones wired from another corner or in
+  the other direction, or several chained panels, are described by changing
+  `GEOMETRY`. See `DvG_FastLED_Geometry.h`.
+
+  `FLC_N_PANELS` gets overridden by the `footprint_scaled` environment of
+  `platformio.ini`, to measure the RAM cost per LED.
   */
 
-  const int L = 13;    // Number of LEDs at each side of the square mirror
-  const int N = 4 * L; // Number of LEDs of the full strip (= 4 * L)
+#ifndef FLC_N_PANELS
+#define FLC_N_PANELS 1
+#endif
+
+  constexpr Geometry GEOMETRY =
+      Geometry(13, 13, StartCorner::BOTTOM_LEFT, Winding::CCW, FLC_N_PANELS);
+
+  const int L = GEOMETRY.width;   // Number of LEDs at the bottom side
+  const int N = GEOMETRY.numel(); // Number of LEDs of the full strip
+
+  static_assert(GEOMETRY.is_valid(), "FLC::GEOMETRY is invalid");
+  static_assert(N * sizeof(CRGB) < 65536,
+                "FLC::N too large: `memcpy8()` takes 16-bit byte counts");
 
   const int PIN_DATA PIN_SPI_MOSI;
   const int PIN_CLK PIN_SPI_SCK;
 
+  // Number of physical output channels the strip is split over, each sent out
+  // concurrently by its own SERCOM SPI port, [1 - 4]. 1: single strip on
+  // `PIN_DATA` and `PIN_CLK`. See `DvG_APA102_MultiSPI.h`. `FLC_N_CHANNELS`
+  // gets overridden by the `multispi_check` environment of `platformio.ini`.
+#ifndef FLC_N_CHANNELS
+#define FLC_N_CHANNELS 1
+#endif
+  const uint8_t N_CHANNELS = FLC_N_CHANNELS;
+  const uint32_t SPI_CLOCK = 1000000; // [Hz]
+
   const ESPIChipsets LED_TYPE = APA102;
   const EOrder COLOR_ORDER = BGR;
   const LEDColorCorrection COLOR_CORRECTION = TypicalSMD5050;
 
   const uint16_t MAX_REFRESH_RATE = 250; // FPS
 
+  // Power model and limiter, calibrated on `POWER_CAL_N` LEDs, see `notes.txt`
+  // and `DvG_FastLED_Power.h`. The 2.0 A supply only delivers 1.13 A.
+  const uint16_t POWER_CAL_N = 52;        // Number of LEDs measured
+  const uint16_t POWER_IDLE = 58;         // [mA] All LEDs off
+  const uint16_t POWER_FULL_WHITE = 1300; // [mA] All LEDs full white
+  const uint16_t POWER_BUDGET = 1000;     // [mA] Limit for the supply
+  const uint8_t POWER_HYSTERESIS = 8;     // Brightness steps before raising
+  const uint16_t POWER_HOLD = 50;         // [frames] Headroom before raising
+
+  // Quality-of-service governor, see `DvG_FastLED_EffectManager.h`
+  const uint16_t QOS_MIN_FPS = 100;     // Degrade quality below this FPS
+  const uint16_t QOS_SHOW_US = 2000;    // [us] Rest of the loop, e.g. `show()`
+  const uint16_t QOS_HOLD = 25;         // [frames] Over budget before degrading
+  const uint16_t QOS_RESTORE = 500;     // [frames] Headroom before restoring
+  const uint16_t QOS_RENDER_RATE = 50;  // [Hz] Default `min_rate` of a preset
+
+  // Frame-rate independent fading, see `DvG_FastLED_Decay.h`
+  const uint8_t DECAY_LUT_SIZE = 32; // [ms] Longest frame time in the table
+  const uint16_t DECAY_MAX_DT = 100; // [ms] Longer gaps get clipped to this
+
   // Audience check: Time-out and go back to sleep when no audience is present
   // within a certain distance
   const uint32_t AUDIENCE_TIMEOUT = 80000; // [ms]
   const uint8_t AUDIENCE_DISTANCE = 130;   // [cm]
 
+  // IR distance sensor sampling period
+  const uint16_t IR_PERIOD = 25; // [ms]
+
+  // Publish the predictive alpha-beta filter of the IR distance instead of the
+  // running average, toggled by serial command 'j'. See `DvG_IR_Distance.h`.
+  const bool IR_PREDICT = false;
+
+  // Standby mode, entered when asleep and waiting for an audience: No LED data
+  // is send out, the core clock gets divided and the IR distance sensor is
+  // sampled at a reduced rate
+  const uint16_t STANDBY_IR_PERIOD = 100; // [ms]
+  const uint8_t STANDBY_CPU_DIV = 8;      // Power of 2, [1 - 128], 1: no div
+
+  // Animation recording in the external QSPI flash, see
+  // `DvG_FastLED_Animation.h`
+  const uint32_t ANIM_ADDR = 0;      // Must be 64 kB aligned
+  const uint32_t ANIM_SIZE = 262144; // [bytes], multiple of 64 kB
+  const uint16_t ANIM_PERIOD = 20;   // [ms] Recording frame period
+
+  // Binary frame streaming from a host PC, see `DvG_FastLED_Stream.h`
+  const uint8_t STREAM_DEPTH = 4;       // Jitter buffer size [frames]
+  const uint16_t STREAM_PERIOD = 20;    // [ms] Playout frame period
+  const uint16_t STREAM_TIMEOUT = 2000; // [ms] Leave streaming without data
+
+  // Frame capture to a host PC, see `DvG_FastLED_Capture.h`
+  const uint16_t CAPTURE_KEYFRAME = 50;    // Keyframe every N frames
+  const uint16_t CAPTURE_QUEUE_SIZE = 2048; // [bytes], power of 2
+
+  // Buffered logging, see `DvG_Logger.h`
+  const uint16_t LOG_BUFFER_SIZE = 512; // [bytes], power of 2
+  const uint8_t LOG_DRAIN_MAX = 2;      // Records sent out per loop iteration
+
   // Menu
   const uint8_t MENU_WIDTH = 4;
 } // namespace FLC
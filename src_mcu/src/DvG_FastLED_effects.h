@@ -26,10 +26,18 @@ Dennis van Gils
 
 #include "FastLED.h"
 
+#include "DvG_APA102_MultiSPI.h"
 #include "DvG_ECG_simulation.h"
+#include "DvG_FastLED_Animation.h"
+#include "DvG_FastLED_Decay.h"
+#include "DvG_FastLED_Noise.h"
+#include "DvG_FastLED_Stream.h"
 #include "DvG_FastLED_StripSegmenter.h"
 #include "DvG_FastLED_config.h"
 #include "DvG_FastLED_functions.h"
+#include "DvG_FastLED_Primitives.h"
+#include "DvG_FastLED_Layers.h"
+#include "DvG_FastLED_VM.h"
 
 using namespace std;
 
@@ -37,23 +45,36 @@ using namespace std;
 extern uint8_t IR_dist_cm;
 extern uint8_t IR_dist_fract;
 
-CRGB leds[FLC::N];          // LED data of the full strip to be send out
+CRGB leds_buf[FLC::N];      // Initial buffer of `leds`
+
+// LED data of the full strip to be send out. A pointer, so that the frame
+// stream can swap in a received frame without copying it.
+CRGB *leds = leds_buf;
 CRGB leds_snapshot[FLC::N]; // `leds` snapshot copy
 CHSV chsv_snapshot[FLC::N]; // `leds` snapshot copy in HSV
 CRGB fx1[FLC::N];           // Will be populated up to length `s1`
-CRGB fx2[FLC::N];           // Will be populated up to length `s2`
+CRGB fx2[FLC::N];           // Will be populated up to the length of `segmntr2`
 CRGB fx1_strip[FLC::N];     // Full strip after segmenter on `fx1`
 CRGB fx2_strip[FLC::N];     // Full strip after segmenter on `fx2`
 
+// `leds` reordered into the order of the physical wiring, only needed when the
+// wiring differs from the canonical order. See `DvG_FastLED_Geometry.h`.
+CRGB leds_phys[FLC::GEOMETRY.is_canonical() ? 1 : FLC::N];
+
+// (x, y) position of each LED along the perimeter of a panel, to be filled by
+// `FLC::GEOMETRY.perimeter_xy()`
+XY16 perimeter_xy[FLC::GEOMETRY.perimeter()];
+
 FastLED_StripSegmenter segmntr1; // Segmenter operating on `fx1`
 static uint16_t s1; // Will hold `s1 = segmntr1.get_base_numel()` for `fx1`
 
 FastLED_StripSegmenter segmntr2; // Segmenter operating on fx2
-static uint16_t s2; // Will hold `s2 = segmntr1.get_base_numel()` for `fx2`
 
 // Recurring animation variables
 // clang-format off
 bool fx_has_finished = false;     // Checked by `DvG_FastLED_EffectManager.h`
+bool fx_standby_ready = false;    // Checked by `DvG_FastLED_EffectManager.h`
+uint32_t fx_standby_t0 = 0;       // `micros()` value at `fx_standby_ready`
 static bool fx_about_to_finish = false;
 static uint16_t idx1;             // LED position index used for `fx1`
 static uint16_t idx2;             // LED position index used for `fx2`
@@ -62,19 +83,38 @@ static uint32_t fx_t0       = 0;  // `millis()` value at start of effect
 static uint32_t fx_timebase = 0;  // 'millis()` value at arbitrary moment
 static uint8_t  fx_hue      = 0;
 static uint8_t  fx_hue_step = 1;
-static uint8_t  fx_intens   = 255;
 static uint8_t  fx_blend    = 127;
 // static uint8_t  fx_blur     = 0;
 // clang-format on
 
+// Quality degradations, stepped through in this order by the governor of
+// `DvG_FastLED_EffectManager.h` when the effect costs too much to keep the
+// frame rate at `FLC::QOS_MIN_FPS`. Each preset declares which ones it allows.
+// The effect-specific ones have to be implemented by the effect itself,
+// checking `fx_qos`. `QOS_HALF_RATE` coarsens the motion of the effect, hence
+// it is opt-in per preset and never goes below the preset's `min_rate`.
+enum QosFlags : uint8_t {
+  QOS_COARSE = 1 << 0,    // Effect-specific: cheaper math, e.g. integer `mu`
+  QOS_HALF_RATE = 1 << 1, // Halve the render rate, interpolate in between
+  QOS_NO_BLEND = 1 << 2,  // Effect-specific: skip the snapshot blend
+  QOS_NO_DITHER = 1 << 3, // Turn off FastLED's temporal dithering
+  QOS_GENERIC = QOS_NO_DITHER, // Works for any effect, the default
+  QOS_ALL = 0x0F
+};
+const uint8_t QOS_N = 4; // Number of `QosFlags`
+
 // Globally set by `DvG_FastLED_EffectManager.h`
 uint32_t fx_duration = 0; // [ms]
 StyleEnum fx_style = StyleEnum::FULL_STRIP;
+uint8_t fx_qos = 0; // Quality degradations currently in effect, `QosFlags`
+const FX_layer *fx_layers = nullptr; // Layers of the preset, see `fx__Layers`
+uint8_t fx_n_layers = 0;
 
 // To be called inside of every `entr__...` function
 static void init_fx() {
   segmntr1.set_style(fx_style);
   fx_has_finished = false;
+  fx_standby_ready = false;
   fx_about_to_finish = false;
   fx_starting = true;
   fx_t0 = millis();
@@ -111,14 +151,20 @@ CRGBPalette16 custom_palette_1 = {
 /*------------------------------------------------------------------------------
   SleepAndWaitForAudience
 
-  Fades to black piecewise linear, getting slower near the dim end
+  Fades to black piecewise linear, getting slower near the dim end. Once black,
+  it signals `fx_standby_ready` so that the effect manager can go into standby.
 ------------------------------------------------------------------------------*/
 
 void upd__SleepAndWaitForAudience() {
+  static FastLED_Decay decay_leds(5);
+
   if (fx_starting) {
-    EVERY_N_MILLIS(10) {
-      fadeToBlackBy(leds, FLC::N, get_avg_luma(leds, FLC::N) > 60 ? 5 : 1);
-      fx_starting = !is_all_black(leds, FLC::N);
+    decay_leds.set_fade(get_avg_luma(leds, FLC::N) > 60 ? 5 : 1);
+    decay_leds.apply(leds, FLC::N);
+    fx_starting = !is_all_black(leds, FLC::N);
+    if (!fx_starting) {
+      fx_standby_ready = true;
+      fx_standby_t0 = micros();
     }
   } else {
     if (IR_dist_cm < FLC::AUDIENCE_DISTANCE) {
@@ -140,7 +186,8 @@ State fx__SleepAndWaitForAudience("SleepAndWaitForAudience", init_fx,
 
 void upd__BlurToBlack() {
   if (!fx_has_finished) {
-    EVERY_N_MILLIS(10) {
+    static FastLED_Ticker tick(10);
+    for (uint16_t n = tick.ticks(); n; n--) {
       blur1d(leds, FLC::N, 172);
       fx_about_to_finish = is_all_black(leds, FLC::N);
     }
@@ -157,11 +204,12 @@ State fx__BlurToBlack("BlurToBlack", init_fx, upd__BlurToBlack);
 ------------------------------------------------------------------------------*/
 
 void upd__FadeToBlack() {
+  static FastLED_Decay decay_leds(5);
+
   if (!fx_has_finished) {
-    EVERY_N_MILLIS(10) {
-      fadeToBlackBy(leds, FLC::N, get_avg_luma(leds, FLC::N) > 60 ? 5 : 1);
-      fx_about_to_finish = is_all_black(leds, FLC::N);
-    }
+    decay_leds.set_fade(get_avg_luma(leds, FLC::N) > 60 ? 5 : 1);
+    decay_leds.apply(leds, FLC::N);
+    fx_about_to_finish = is_all_black(leds, FLC::N);
     duration_check();
   }
 }
@@ -185,11 +233,11 @@ void ent__FadeToHSVBlack() {
 
 void upd__FadeToHSVBlack() {
   if (!fx_has_finished) {
-    EVERY_N_MILLIS(10) {
+    static FastLED_Ticker tick(10);
+    uint8_t n = min(tick.ticks(), (uint16_t)255);
+    if (n) {
       for (idx1 = 0; idx1 < FLC::N; idx1++) {
-        if (chsv_snapshot[idx1].v > 0) {
-          chsv_snapshot[idx1].v = chsv_snapshot[idx1].v - 1;
-        }
+        chsv_snapshot[idx1].v = qsub8(chsv_snapshot[idx1].v, n);
         leds[idx1] = CHSV(chsv_snapshot[idx1]);
       }
       fx_about_to_finish = is_all_black(leds, FLC::N);
@@ -207,7 +255,8 @@ State fx__FadeToHSVBlack("FadeToHSVBlack", ent__FadeToHSVBlack,
 
 void upd__FadeToWhite() {
   if (!fx_has_finished) {
-    EVERY_N_MILLIS(10) {
+    static FastLED_Ticker tick(10);
+    for (uint16_t n = tick.ticks(); n; n--) {
       fadeTowardColor(leds, FLC::N, CRGB::White, 5);
       fx_about_to_finish = is_all_of_color(leds, FLC::N, CRGB::White);
     }
@@ -223,7 +272,8 @@ State fx__FadeToWhite("FadeToWhite", init_fx, upd__FadeToWhite);
 
 void upd__FadeToRed() {
   if (!fx_has_finished) {
-    EVERY_N_MILLIS(10) {
+    static FastLED_Ticker tick(10);
+    for (uint16_t n = tick.ticks(); n; n--) {
       fadeTowardColor(leds, FLC::N, CRGB::Red, 5);
       fx_about_to_finish = is_all_of_color(leds, FLC::N, CRGB::Red);
     }
@@ -283,40 +333,102 @@ State fx__IRDist("IRDist", init_fx, upd__IRDist);
 #define ECG_N_SMP 256 // 256 so you can use `beat8()` for timing
 
 namespace ECG {
+  ECG_params default_params() {
+    ECG_params prms;
+    ECG_default_params(&prms);
+    return prms;
+  }
+
   static float wave[ECG_N_SMP] = {0};
+  static ECG_params prms = default_params(); // Parameters of `wave`
+  static ECG_params prms_next;    // To be applied at the start of a new beat
+  static bool prms_pending = false;
+  static uint32_t timebase = 0;   // `millis()` value at the start of a beat
+  static uint16_t n_beats = 0;    // Number of beats since `restart()`
+  static uint8_t idx_prev = 0;
 } // namespace ECG
 
 void generate_HeartBeat() {
-  // Generate ECG wave data over the output range [0 - 1].
+  // Generate ECG wave data over the output range [0 - 1] from `ECG::prms`.
   // Note that the `resting` state of the heart is near a value of 0.13.
   // 0 is simply the minimum of the ECG action potential, corresponding to the
   // ECG depolarization part.
-  generate_ECG(ECG::wave, ECG_N_SMP);
+  // The pulses get evaluated directly, instead of as a Fourier series by
+  // `generate_ECG()`, which is fast enough to regenerate at every beat.
+  float rest = generate_ECG_direct(ECG::wave, ECG_N_SMP, &ECG::prms);
 
   // Shift the start of the ECG wave in time
   std::rotate(ECG::wave, ECG::wave + 44, ECG::wave + ECG_N_SMP);
 
   // Suppress ECG depolarization from the wave and rescale back to [0 - 1]
   for (idx1 = 0; idx1 < ECG_N_SMP; idx1++) {
-    ECG::wave[idx1] = max(ECG::wave[idx1], 0.13);
-    ECG::wave[idx1] = (ECG::wave[idx1] - 0.13) / (1 - 0.13);
+    ECG::wave[idx1] = max(ECG::wave[idx1], rest);
+    ECG::wave[idx1] = (ECG::wave[idx1] - rest) / (1 - rest);
   }
 }
 
+namespace ECG {
+  void set_params(const ECG_params &new_prms) {
+    /* Takes effect at the start of the next beat, see `beat_idx()`
+     */
+    prms_next = new_prms;
+    prms_pending = true;
+  }
+
+  void set_heart_rate(float heart_rate) {
+    /* [BPM] Takes effect at the start of the next beat
+     */
+    if (!prms_pending) {
+      prms_next = prms;
+    }
+    prms_next.heart_rate = heart_rate;
+    prms_pending = true;
+  }
+
+  void restart() {
+    timebase = millis();
+    n_beats = 0;
+    idx_prev = 0;
+  }
+
+  uint8_t beat_idx() {
+    /* Index into `wave` of the ongoing beat, played back at half the heart
+    rate. Pending parameters get applied when a new beat starts: `wave` gets
+    regenerated and the beat restarts from there on at the new rate.
+    */
+    uint8_t idx = beat8((accum88)(prms.heart_rate * 128), timebase);
+
+    if (idx < idx_prev) {
+      n_beats++;
+      if (prms_pending) {
+        prms = prms_next;
+        prms_pending = false;
+        generate_HeartBeat();
+        timebase = millis();
+        idx = 0;
+      }
+    }
+    idx_prev = idx;
+
+    return idx;
+  }
+} // namespace ECG
+
 void entr__HeartBeatAwaken() {
   init_fx();
   clear_CRGBs(fx1);
-  fx_timebase = millis();
+  ECG::restart();
   fx_hue = 127;
 }
 
 void upd__HeartBeatAwaken() {
+  static FastLED_Decay decay_fx1(5);
   s1 = segmntr1.get_base_numel();
   uint8_t ECG_idx;
   float ECG_ampl;
 
-  ECG_idx = beat8(30, fx_timebase); // [0 - 255]
-  ECG_ampl = ECG::wave[ECG_idx];    // [0 - 1]
+  ECG_idx = ECG::beat_idx();     // [0 - 255]
+  ECG_ampl = ECG::wave[ECG_idx]; // [0 - 1]
 
   // Calculate intensities in pure white
   const uint8_t offs = 1; // ~ number of leds always lid
@@ -336,9 +448,7 @@ void upd__HeartBeatAwaken() {
         CHSV(fx_hue + idx1 * 255 / (FLC::N - 1), 255, leds[idx1].getLuma());
   }
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(fx1, s1, 5);
-  }
+  decay_fx1.apply(fx1, s1);
 
   EVERY_N_MILLIS(50) {
     fx_hue++;
@@ -366,27 +476,27 @@ void entr__HeartBeat() {
   init_fx();
   create_leds_snapshot();
   clear_CRGBs(fx1);
-  fx_timebase = millis();
+  ECG::restart();
 }
 
 void upd__HeartBeat() {
+  static FastLED_Decay decay_snapshot(5);
+  static FastLED_Decay decay_fx1(10);
   s1 = segmntr1.get_base_numel();
   uint8_t ECG_idx;
   float ECG_ampl;
 
-  ECG_idx = beat8(30, fx_timebase); // [0 255]
-  ECG_ampl = ECG::wave[ECG_idx];    // [0 - 1]
+  ECG_idx = ECG::beat_idx();     // [0 255]
+  ECG_ampl = ECG::wave[ECG_idx]; // [0 - 1]
 
-  idx1 = round((1 - ECG_ampl) * (s1 - 1));
-  fx1[idx1] += CHSV(HUE_RED, 255, round(ECG::wave[ECG_idx] * 255));
+  draw_dot88(fx1, s1, (1 - ECG_ampl) * ((uint32_t)(s1 - 1) << 8),
+             CHSV(HUE_RED, 255, round(ECG::wave[ECG_idx] * 255)));
   populate_fx1_strip();
 
   add_CRGBs(leds_snapshot, fx1_strip, leds, FLC::N);
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 5);
-    fadeToBlackBy(fx1, s1, 10);
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+  decay_fx1.apply(fx1, s1);
 
   duration_check();
 }
@@ -397,43 +507,36 @@ State fx__HeartBeat("HeartBeat", entr__HeartBeat, upd__HeartBeat);
   HeartBeat_2
   - StyleEnum::PERIO_OPP_CORNERS_N2
 
+  Two layers, see `DvG_FastLED_Layers.h`: A dot swinging back and forth,
+  rotated by 90 degrees, on top of the full strip pulsing red at the heart
+  beat. As a layered preset the dot swings in the style of the table below,
+  as the native effect in the style of the preset.
+
   Author: Dennis van Gils
 ------------------------------------------------------------------------------*/
 
-void entr__HeartBeat_2() {
-  init_fx();
-  segmntr2.set_style(StyleEnum::FULL_STRIP);
-  create_leds_snapshot();
-  clear_CRGBs(fx1);
-  clear_CRGBs(fx2);
-  fx_timebase = millis();
-  fx_hue = 0;
-}
-
-void upd__HeartBeat_2() {
-  s1 = segmntr1.get_base_numel();
-  s2 = segmntr2.get_base_numel();
-  static uint8_t heart_rate = 30;
-  uint8_t ECG_idx;
+void layer__Swing(CRGB *fx, uint16_t s) {
+  /* Red dot swinging back and forth once every 2 beats, only drawn on the
+  outer thirds
+  */
+  uint8_t ECG_idx = ECG::beat_idx(); // [0 255]
+  uint16_t idx =
+      round(scale8(sin8(((ECG::n_beats & 1) << 7) + (ECG_idx >> 1)), 255) /
+            255. * (s - 1));
 
-  // Effect 1
-  idx1 = round(beatsin8(heart_rate / 2, 0, 255, fx_timebase) / 255. * (s1 - 1));
-  if ((idx1 < s1 / 3) | (idx1 > s1 * 2 / 3)) {
-    fx1[idx1] = CRGB::Red;
-    // fx1[idx1] += CHSV(HUE_RED, 255, fx_intens);
+  if ((idx < s / 3) | (idx > s * 2 / 3)) {
+    fx[idx] = CRGB::Red;
   }
+}
 
-  // Effect 2
-  ECG_idx = beat8(heart_rate, fx_timebase); // [0 255]
-  fx_intens = round(ECG::wave[ECG_idx] * 100);
+void layer__Pulse(CRGB *fx, uint16_t s) {
+  /* Adds `fx_hue` at the intensity of the heart beat
+   */
+  uint8_t intens = round(ECG::wave[ECG::beat_idx()] * 100);
 
   /*
-  // Make heart rate depend on IR_dist_cm
-  // Is hard to keep beats to start at the start
-  if (ECG_idx == 255){
-    heart_rate = floor(((uint16_t) IR_dist_cm * 2) / 2); // Ensure even
-    fx_timebase = millis();
-  }
+  // Make heart rate depend on IR_dist_cm, from the next beat on
+  ECG::set_heart_rate(IR_dist_cm * 2); // Beats at `IR_dist_cm` BPM
   */
 
   /*
@@ -441,25 +544,35 @@ void upd__HeartBeat_2() {
   fx_hue = 200 - IR_dist_fract * 200 / 255;
   */
 
-  for (idx2 = 0; idx2 < s2; idx2++) {
-    if (fx_intens > 15) {
-      fx2[idx2] += CHSV(fx_hue, 255, fx_intens);
+  if (intens > 15) {
+    for (uint16_t idx = 0; idx < s; idx++) {
+      fx[idx] += CHSV(fx_hue, 255, intens);
     }
   }
+}
 
-  populate_fx1_strip();
-  populate_fx2_strip();
-  rotate_strip_90(fx1_strip);
-  add_CRGBs(fx1_strip, fx2_strip, fx1_strip, FLC::N);
+// clang-format off
+constexpr std::array<FX_layer, 2> layers_HeartBeat_2 = {{
+  //       pattern       strip segmentation style           blend mode  opacity  decay  shift
+  FX_layer(layer__Swing, StyleEnum::PERIO_OPP_CORNERS_N2  , BLEND_ADD , 255    , 20   , FLC::GEOMETRY.width),
+  FX_layer(layer__Pulse, StyleEnum::FULL_STRIP            , BLEND_ADD , 255    , 10),
+}};
+// clang-format on
 
-  // Final mix
-  add_CRGBs(leds_snapshot, fx1_strip, leds, FLC::N);
+void entr__HeartBeat_2() {
+  const StyleEnum styles[] = {fx_style, layers_HeartBeat_2[1].style};
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 5);
-    fadeToBlackBy(fx1, s1, 20);
-    fadeToBlackBy(fx2, s2, 10);
-  }
+  init_fx();
+  enter_layers(layers_HeartBeat_2.data(), 2, styles);
+  ECG::restart();
+  fx_hue = 0;
+}
+
+void upd__HeartBeat_2() {
+  static FastLED_Decay decay_snapshot(5);
+
+  update_layers(layers_HeartBeat_2.data(), 2);
+  decay_snapshot.apply(leds_snapshot, FLC::N);
 
   duration_check();
 }
@@ -482,6 +595,7 @@ void entr__Rainbow() {
 }
 
 void upd__Rainbow() {
+  static FastLED_Decay decay_snapshot(5);
   s1 = segmntr1.get_base_numel();
 
   // NOTE: Parameter `deltaHue` of `fill_rainbow()` causes a propagating error
@@ -491,17 +605,13 @@ void upd__Rainbow() {
 
   blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
 
-  EVERY_N_MILLIS(40) {
-    fx_hue -= fx_hue_step;
-  }
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 5);
-  }
-  EVERY_N_MILLIS(6) {
-    if (fx_blend < 255) {
-      fx_blend++;
-    }
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
+  // Without drift, see `DvG_FastLED_Decay.h`
+  static FastLED_Ticker tick_hue(40);
+  static FastLED_Ticker tick_blend(6);
+  fx_hue -= fx_hue_step * tick_hue.ticks();
+  fx_blend = qadd8(fx_blend, min(tick_blend.ticks(), (uint16_t)255));
 
   duration_check();
 }
@@ -523,19 +633,20 @@ void entr__Sinelon() {
 }
 
 void upd__Sinelon() {
+  static FastLED_Decay decay_snapshot(5);
+  static FastLED_Decay decay_fx1(5);
   s1 = segmntr1.get_base_numel();
+  uint32_t pos; // 24.8 fixed point
 
-  idx1 = beatsin16(13, 0, s1, fx_timebase, 16384);
+  pos = beatpos88(13, s1, fx_timebase, 16384);
   fx_hue = beat8(4, fx_timebase) + 127;
-  fx1[idx1] = CHSV(fx_hue, 255, 255); // fx_hue, 255, 192
+  draw_dot88(fx1, s1, pos, CHSV(fx_hue, 255, 255)); // fx_hue, 255, 192
   populate_fx1_strip();
 
   add_CRGBs(leds_snapshot, fx1_strip, leds, FLC::N);
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 5);
-    fadeToBlackBy(fx1, s1, 5);
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+  decay_fx1.apply(fx1, s1);
 
   duration_check();
 }
@@ -559,6 +670,7 @@ void entr__BPM() {
 }
 
 void upd__BPM() {
+  static FastLED_Decay decay_snapshot(5);
   s1 = segmntr1.get_base_numel();
   CRGBPalette16 palette = PartyColors_p; // RainbowColors_p; // PartyColors_p;
   static uint8_t bpm = 30;
@@ -574,9 +686,7 @@ void upd__BPM() {
 
   add_CRGBs(leds_snapshot, fx1_strip, leds, FLC::N);
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 5);
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
   EVERY_N_MILLISECONDS(30) {
     fx_hue = fx_hue + fx_hue_step;
   }
@@ -598,18 +708,17 @@ void entr__Juggle() {
 }
 
 void upd__Juggle() {
+  static FastLED_Decay decay_fx1(24);
   s1 = segmntr1.get_base_numel();
   byte dothue = 0;
 
   for (int i = 0; i < 8; i++) {
-    fx1[beatsin16(i + 7, 0, s1 - 1)] |= CHSV(dothue, 200, 255);
+    draw_dot88(fx1, s1, beatpos88(i + 7, s1), CHSV(dothue, 200, 255));
     dothue += 32;
   }
   segmntr1.process(leds, fx1);
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(fx1, s1, 24);
-  }
+  decay_fx1.apply(fx1, s1);
 
   duration_check();
 }
@@ -659,23 +768,25 @@ void entr__Dennis() {
 }
 
 void upd__Dennis() {
+  static FastLED_Decay decay_snapshot(1);
+  static FastLED_Decay decay_fx1(14);
   s1 = segmntr1.get_base_numel();
+  uint32_t pos; // 24.8 fixed point
 
-  idx1 = beatsin16(15, 0, s1 - 1, fx_timebase); // 15
-  fx1[idx1] = CRGB::Red;
-  fx1[s1 - idx1 - 1] = CRGB::OrangeRed;
+  pos = beatpos88(15, s1, fx_timebase); // 15
+  draw_dot88(fx1, s1, pos, CRGB::Red);
+  draw_dot88(fx1, s1, ((s1 - 1) << 8) - pos, CRGB::OrangeRed);
   populate_fx1_strip();
 
   // blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
   add_CRGBs(leds_snapshot, fx1_strip, leds, FLC::N); // Neater
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 1);
-    fadeToBlackBy(fx1, s1, 14);
-    if (fx_blend < 255) {
-      fx_blend++;
-    }
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+  decay_fx1.apply(fx1, s1);
+
+  // Without drift, see `DvG_FastLED_Decay.h`
+  static FastLED_Ticker tick_blend(10);
+  fx_blend = qadd8(fx_blend, min(tick_blend.ticks(), (uint16_t)255));
 
   duration_check();
 }
@@ -700,11 +811,14 @@ void entr__Try() {
 }
 
 void upd__Try() {
+  static FastLED_Decay decay_snapshot(1);
+  static FastLED_Decay decay_fx1(4);
   s1 = segmntr1.get_base_numel();
+  uint32_t pos; // 24.8 fixed point
 
-  idx1 = beatsin16(15, 0, s1 - 1, fx_timebase); // 15
-  // fx1[idx1] = CRGB::Red;
-  fx1[idx1] = ColorFromPalette(custom_palette_1, fx_hue);
+  pos = beatpos88(15, s1, fx_timebase); // 15
+  // draw_dot88(fx1, s1, pos, CRGB::Red);
+  draw_dot88(fx1, s1, pos, ColorFromPalette(custom_palette_1, fx_hue));
   // fx1[s1 - idx1 - 1] = CRGB::OrangeRed;
   populate_fx1_strip();
 
@@ -724,14 +838,14 @@ void upd__Try() {
   // blur1d(fx1_strip, FLC::N, 128);
   blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 1);
-    fadeToBlackBy(fx1, s1, 4);
-    if (fx_blend < 255) {
-      fx_blend++;
-    }
-    fx_hue += 1;
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+  decay_fx1.apply(fx1, s1);
+
+  // Without drift, see `DvG_FastLED_Decay.h`
+  static FastLED_Ticker tick_blend(10);
+  uint16_t n = tick_blend.ticks();
+  fx_blend = qadd8(fx_blend, min(n, (uint16_t)255));
+  fx_hue += n;
 
   duration_check();
 }
@@ -755,6 +869,7 @@ void entr__DoubleWave() {
 }
 
 void upd__DoubleWave() {
+  static FastLED_Decay decay_snapshot(1);
   s1 = segmntr1.get_base_numel();
 
   for (idx1 = 0; idx1 < s1; idx1++) {
@@ -769,9 +884,7 @@ void upd__DoubleWave() {
 
   blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
 
-  EVERY_N_MILLIS(10) {
-    fadeToBlackBy(leds_snapshot, FLC::N, 1);
-  }
+  decay_snapshot.apply(leds_snapshot, FLC::N);
 
   EVERY_N_MILLIS(20) {
     if (fx_blend < 255) {
@@ -800,6 +913,7 @@ void entr__RainbowBarf() {
 }
 
 void upd__RainbowBarf() {
+  static FastLED_Decay decay_snapshot(10, 20);
   s1 = segmntr1.get_base_numel();
   uint8_t gauss8[FLC::N]; // Will hold the Gaussian profile
   static float mu;
@@ -809,7 +923,11 @@ void upd__RainbowBarf() {
     fx_starting = false;
     mu = 0;
   }
-  profile_gauss8strip(gauss8, mu, sigma);
+  if (fx_qos & QOS_COARSE) {
+    profile_gauss8strip(gauss8, (uint16_t)round(mu), sigma);
+  } else {
+    profile_gauss8strip(gauss8, mu, sigma);
+  }
 
   for (idx1 = 0; idx1 < s1; idx1++) {
     // fx1[idx1] = CRGB(gauss8[idx1], 0, 0);
@@ -822,12 +940,13 @@ void upd__RainbowBarf() {
   add_CRGBs(leds_snapshot, fx1_strip, leds, FLC::N);
   // blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
 
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
   EVERY_N_MILLIS(20) {
     mu += .4;
     while (mu >= FLC::N) {
       mu -= FLC::N;
     }
-    fadeToBlackBy(leds_snapshot, FLC::N, 10);
     if (fx_blend < 255) {
       fx_blend++;
     }
@@ -902,7 +1021,7 @@ State fx__RainbowBarf_2("RainbowBarf_2", entr__RainbowBarf_2,
 
 void entr__RainbowHeartBeat() {
   init_fx();
-  fx_timebase = millis();
+  ECG::restart();
 }
 
 void upd__RainbowHeartBeat() {
@@ -911,9 +1030,8 @@ void upd__RainbowHeartBeat() {
   uint8_t ECG_idx;        // Driving `sigma`
   uint16_t mu = 6;
   float sigma;
-  static uint8_t heart_rate = 30;
 
-  ECG_idx = beat8(heart_rate, fx_timebase);
+  ECG_idx = ECG::beat_idx();
   sigma = ECG::wave[ECG_idx]; // [0 - 1]
   profile_gauss8strip(gauss8, mu, sigma * 6);
 
@@ -953,6 +1071,7 @@ void entr__RainbowSurf() {
 }
 
 void upd__RainbowSurf() {
+  static FastLED_Decay decay_snapshot(10, 20);
   s1 = segmntr1.get_base_numel();
   CHSV fx3[FLC::N];       // CHSV instead of CRGB
   uint8_t gauss8[FLC::N]; // Will hold the Gaussian profile
@@ -966,7 +1085,11 @@ void upd__RainbowSurf() {
     fx_starting = false;
     mu = 6.;
   }
-  profile_gauss8strip(gauss8, mu, sigma);
+  if (fx_qos & QOS_COARSE) {
+    profile_gauss8strip(gauss8, (uint16_t)round(mu), sigma);
+  } else {
+    profile_gauss8strip(gauss8, mu, sigma);
+  }
 
   for (idx1 = 0; idx1 < s1; idx1++) {
     fx1[idx1] = CHSV(fx3[idx1].hue + gauss8[idx1], 255, 255);
@@ -974,25 +1097,253 @@ void upd__RainbowSurf() {
   populate_fx1_strip();
   flip_strip(fx1_strip);
 
-  blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
+  if (fx_qos & QOS_NO_BLEND) {
+    copy_strip(fx1_strip, leds);
+  } else {
+    blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
+  }
 
-  EVERY_N_MILLIS(20) {
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
+  // Without drift, see `DvG_FastLED_Decay.h`
+  static FastLED_Ticker tick_mu(20);
+  static FastLED_Ticker tick_hue(50);
+  for (uint16_t n = tick_mu.ticks(); n; n--) {
     mu += .4;
     while (mu >= FLC::N) {
       mu -= FLC::N;
     }
-    fadeToBlackBy(leds_snapshot, FLC::N, 10);
     if (fx_blend < 255) {
       fx_blend++;
     }
   }
-  EVERY_N_MILLIS(50) {
+  fx_hue += tick_hue.ticks();
+
+  duration_check();
+}
+
+State fx__RainbowSurf("RainbowSurf", entr__RainbowSurf, upd__RainbowSurf);
+
+/*------------------------------------------------------------------------------
+  Noise
+
+  Smooth 3D noise field sampled at the (x, y) positions of the LEDs along the
+  mirror perimeter, slowly drifting through time along z. Each panel samples
+  its own slice of the field.
+
+  - StyleEnum::FULL_STRIP
+------------------------------------------------------------------------------*/
+
+void entr__Noise() {
+  init_fx();
+  create_leds_snapshot();
+  fx_timebase = millis();
+  fx_blend = 0;
+}
+
+void upd__Noise() {
+  static FastLED_Decay decay_snapshot(1);
+  static uint16_t noise[FLC::N];
+  const uint16_t P = FLC::GEOMETRY.perimeter();
+  const uint16_t scale = 40; // One lattice cell spans ~6 LEDs
+  uint32_t z = (millis() - fx_timebase) * 20;
+  s1 = segmntr1.get_base_numel();
+
+  for (idx1 = 0; idx1 < s1; idx1 += P) {
+    inoise16_path(perimeter_xy, min(P, (uint16_t)(s1 - idx1)), 0, 0,
+                  z + (uint32_t)(idx1 / P) * 0x100000, scale, &noise[idx1]);
+  }
+  for (idx1 = 0; idx1 < s1; idx1++) {
+    // Stretch the bulk of the noise output, [16384 - 49152], to [0 - 255]
+    uint8_t c = constrain(((int32_t)noise[idx1] - 16384) >> 7, 0, 255);
+    fx1[idx1] = ColorFromPalette(custom_palette_1, c + fx_hue);
+  }
+  populate_fx1_strip();
+
+  if (fx_qos & QOS_NO_BLEND) {
+    copy_strip(fx1_strip, leds);
+  } else {
+    blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
+  }
+
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
+  EVERY_N_MILLIS(20) {
+    if (fx_blend < 255) {
+      fx_blend++;
+    }
+  }
+
+  EVERY_N_MILLIS(200) {
     fx_hue += 1;
   }
 
   duration_check();
 }
 
-State fx__RainbowSurf("RainbowSurf", entr__RainbowSurf, upd__RainbowSurf);
+State fx__Noise("Noise", entr__Noise, upd__Noise);
+
+/*------------------------------------------------------------------------------
+  VM
+
+  Runs the bytecode program stored in flash slot `SLOT`, uploaded over serial.
+  See `DvG_FastLED_VM.h`. Falls back to a built-in program equal to
+  `DoubleWave` when the slot is empty.
+
+  - Any style
+------------------------------------------------------------------------------*/
+
+FastLED_VM vm;
+
+template <uint8_t SLOT> void entr__VM() {
+  init_fx();
+  create_leds_snapshot();
+  fx_timebase = millis();
+  fx_blend = 0;
+  vm.load(SLOT);
+  vm.reset(fx_timebase);
+}
+
+template <uint8_t SLOT> void upd__VM() {
+  static FastLED_Decay decay_snapshot(1);
+  s1 = segmntr1.get_base_numel();
+
+  vm.run(fx1, s1, millis());
+  populate_fx1_strip();
+
+  blend(leds_snapshot, fx1_strip, leds, FLC::N, fx_blend);
+
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
+  EVERY_N_MILLIS(20) {
+    if (fx_blend < 255) {
+      fx_blend++;
+    }
+  }
+
+  duration_check();
+}
+
+State fx__VM0("VM0", entr__VM<0>, upd__VM<0>);
+State fx__VM1("VM1", entr__VM<1>, upd__VM<1>);
+State fx__VM2("VM2", entr__VM<2>, upd__VM<2>);
+State fx__VM3("VM3", entr__VM<3>, upd__VM<3>);
+
+/*------------------------------------------------------------------------------
+  Layers
+
+  Runs the stack of layers declared by the preset, see
+  `DvG_FastLED_Layers.h`. Falls back to `layers_demo` when the preset has
+  none, e.g. `FX_preset(fx__Layers, ...)`.
+
+  - The style of the preset is ignored, each layer has its own
+------------------------------------------------------------------------------*/
+
+void layer__Rainbow(CRGB *fx, uint16_t s) {
+  /* Rainbow slowly running along the base pattern
+   */
+  fill_rainbow(fx, s, -(int32_t)((millis() - fx_t0) / 40),
+               255 / max(s - 1, 1));
+}
+
+void layer__Beat(CRGB *fx, uint16_t s) {
+  /* Gray level following the heart beat, to multiply with
+   */
+  uint8_t level = 96 + ECG::wave[ECG::beat_idx()] * 159;
+  fill_solid(fx, s, CRGB(level, level, level));
+}
+
+void layer__Sinelon(CRGB *fx, uint16_t s) {
+  /* Anti-aliased dot sweeping back and forth, slowly changing color
+   */
+  uint32_t pos = beatpos88(13, s, fx_t0);
+  draw_dot88(fx, s, pos, CHSV((millis() - fx_t0) / 20, 200, 255));
+}
+
+// clang-format off
+constexpr std::array<FX_layer, 4> layers_demo = {{
+  //       pattern         strip segmentation style     blend mode      opacity  decay
+  FX_layer(layer__Rainbow, StyleEnum::COPIED_SIDES    , BLEND_ADD     , 255),
+  FX_layer(layer__Rainbow, StyleEnum::FULL_STRIP      , BLEND_ALPHA   , 96),
+  FX_layer(layer__Beat   , StyleEnum::FULL_STRIP      , BLEND_MULTIPLY, 255),
+  FX_layer(layer__Sinelon, StyleEnum::BI_DIR_SIDE2SIDE, BLEND_MAX     , 255    , 20),
+}};
+// clang-format on
+
+static const FX_layer *layers_current() {
+  return fx_n_layers ? fx_layers : layers_demo.data();
+}
+
+static uint8_t layers_count() {
+  return fx_n_layers ? fx_n_layers : layers_demo.size();
+}
+
+void entr__Layers() {
+  init_fx();
+  enter_layers(layers_current(), layers_count());
+  ECG::restart();
+  fx_hue = 0;
+}
+
+void upd__Layers() {
+  static FastLED_Decay decay_snapshot(5);
+
+  update_layers(layers_current(), layers_count());
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
+  duration_check();
+}
+
+State fx__Layers("Layers", entr__Layers, upd__Layers);
+
+/*------------------------------------------------------------------------------
+  Playback
+
+  Plays the animation recorded in the external QSPI flash on a loop, see
+  `DvG_FastLED_Animation.h`. Fades to black when there is no valid recording.
+------------------------------------------------------------------------------*/
+
+void entr__Playback() {
+  init_fx();
+  create_leds_snapshot();
+  fx_blend = 0;
+  anim_player.begin();
+}
+
+void upd__Playback() {
+  static FastLED_Decay decay_leds(1);
+  static FastLED_Decay decay_snapshot(1);
+  const CRGB *frame = anim_player.update();
+
+  if (frame) {
+    blend(leds_snapshot, frame, leds, FLC::N, fx_blend);
+  } else {
+    decay_leds.apply(leds, FLC::N);
+  }
+
+  decay_snapshot.apply(leds_snapshot, FLC::N);
+
+  // Without drift, see `DvG_FastLED_Decay.h`
+  static FastLED_Ticker tick_blend(4);
+  fx_blend = qadd8(fx_blend, min(tick_blend.ticks(), (uint16_t)255));
+
+  duration_check();
+}
+
+State fx__Playback("Playback", entr__Playback, upd__Playback);
+
+/*------------------------------------------------------------------------------
+  Stream
+
+  Shows the frames streamed by a host PC over serial, see
+  `DvG_FastLED_Stream.h`. The last frame is held in between.
+------------------------------------------------------------------------------*/
+
+void upd__Stream() {
+  frame_stream.playout(leds); // Swaps `leds`, no copy
+  duration_check();
+}
+
+State fx__Stream("Stream", init_fx, upd__Stream);
 
-#endif
\ No newline at end of file
+#endif
@@ -9,7 +9,8 @@ Dennis van Gils
 #define DVG_FASTLED_FUCNTIONS_H
 
 // External variables defined in `DvG_FastLED_effects.h`
-extern CRGB leds[FLC::N];
+extern CRGB *leds;
+extern CRGB leds_phys[];
 extern CRGB leds_snapshot[FLC::N];
 extern CRGB fx1[FLC::N];
 extern CRGB fx2[FLC::N];
@@ -46,7 +47,9 @@ void flip_strip(CRGB *in) {
 }
 
 void rotate_strip_90(CRGB *in) {
-  std::rotate(in, in + FLC::L, in + FLC::N);
+  // Rotate by the length of the bottom side, exactly 90 degrees only for a
+  // square mirror
+  std::rotate(in, in + FLC::GEOMETRY.width, in + FLC::N);
 }
 
 void rotate_strip(CRGB *in, uint16_t amount) {
@@ -64,7 +67,7 @@ void add_CRGBs(const CRGB *in_1, const CRGB *in_2, CRGB *out, uint16_t numel) {
 }
 
 bool is_all_black(CRGB *in, uint32_t numel) {
-  for (uint16_t idx = 0; idx < numel; idx++) {
+  for (uint32_t idx = 0; idx < numel; idx++) {
     if (in[idx]) {
       return false;
     }
@@ -74,7 +77,7 @@ bool is_all_black(CRGB *in, uint32_t numel) {
 
 bool is_all_of_color(CRGB *in, uint32_t numel, const CRGB &target) {
   bool success = true;
-  for (uint16_t idx = 0; idx < numel; idx++) {
+  for (uint32_t idx = 0; idx < numel; idx++) {
     success &= (in[idx] == target);
   }
   return success;
@@ -82,10 +85,42 @@ bool is_all_of_color(CRGB *in, uint32_t numel, const CRGB &target) {
 
 uint8_t get_avg_luma(CRGB *in, uint32_t numel) {
   uint32_t avg_luma = 0;
-  for (uint16_t idx = 0; idx < numel; idx++) {
+  for (uint32_t idx = 0; idx < numel; idx++) {
     avg_luma += in[idx].getLuma();
   }
-  return avg_luma / FLC::N;
+  return numel ? avg_luma / numel : 0;
+}
+
+/*------------------------------------------------------------------------------
+  Physical output order
+------------------------------------------------------------------------------*/
+
+CRGB *get_output_leds() {
+  /* Return the LED data array to be registered with FastLED
+   */
+  return FLC::GEOMETRY.is_canonical() ? leds : leds_phys;
+}
+
+void map_leds_to_output() {
+  /* Reorder `leds` into the physical order of the wiring, when that differs
+  from the canonical order. Otherwise `leds` is the output itself, and FastLED
+  gets pointed at it again once the frame stream has swapped it for another
+  buffer. To be called right before sending out the frame.
+  */
+  static const CRGB *registered = leds;
+
+  if (!FLC::GEOMETRY.is_canonical()) {
+    FLC::GEOMETRY.to_physical(leds, leds_phys);
+  } else if (leds != registered) {
+    // The controllers of the strip come first, see `setup()`
+    for (uint8_t ch = 0; (ch < FLC::N_CHANNELS) && (ch < FastLED.count());
+         ch++) {
+      FastLED[ch].setLeds(
+          leds + channel_start(FLC::GEOMETRY, ch, FLC::N_CHANNELS),
+          channel_numel(FLC::GEOMETRY, ch, FLC::N_CHANNELS));
+    }
+    registered = leds;
+  }
 }
 
 /*------------------------------------------------------------------------------
@@ -0,0 +1,307 @@
+/* DvG_IR_Distance.h
+
+Reads out the Sharp 2Y0A02 IR distance sensor, filters the distance and keeps
+track of the latency from sampling the sensor up to sending out the first frame
+calculated with that sample.
+
+Every sample carries its `micros()` timestamp through the filters. Two
+filters run side by side, one of them gets published to the effects as
+`IR_dist_cm` and `IR_dist_fract`, toggled by serial command 'j':
+
+  average     Median of 3, followed by a running average over `IR_AVG_N`
+              samples. Quiet, but lagging nominally 1 + (N - 1) / 2 samples:
+              262 ms at `FLC::IR_PERIOD` = 25 ms.
+  alpha-beta  Median of 3, followed by an alpha-beta tracker of the distance
+              and its rate of change. The median hands over the timestamp of
+              the sample it picks, not the time it got called, and
+              `publish()` predicts the distance up to the moment the frame
+              gets calculated. The gains are tuned on the host to be as
+              quiet as the running average, lagging 60 ms instead of 320 ms
+              behind a visitor walking about.
+
+Standby
+-------
+In standby the sensor gets sampled every `FLC::STANDBY_IR_PERIOD` ms instead.
+Over `IR_AVG_N` samples, the running average would then span 2 s and delay
+waking up by about as much. Hence, `set_standby()` switches over to a running
+average over `IR_AVG_N_STANDBY` samples, spanning the same time as awake. Both
+running averages get fed all the time. Leaving standby refills the long one
+with the short average, instead of with the samples of 2 s ago.
+
+Latency
+-------
+`publish()` gets called right before calculating a frame and `frame_sent()`
+right after sending it out. The age at that moment of the sample the published
+filter is based on, for the first frame using it, gets collected in a histogram
+of `IR_LAT_N_BINS` bins of `IR_LAT_BIN` ms spanning `IR_LAT_SPAN`, the last bin
+collecting everything beyond. That is the median last fed to the running
+average, or the sample last taken in by the tracker, not the newest one read
+out. Serial command 'h' prints and resets it. The lag of the filter itself
+comes on top. It gets measured on the host PC by replaying sensor traces
+through this very file, see `host/ir_replay.cpp`, `host/traces/` and
+`src_python/ir_trace.py`.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_IR_DISTANCE_H
+#define DVG_IR_DISTANCE_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+#include "DvG_RunningStats.h"
+
+// Fit: distance [cm] = A / bitval ^ C - B, where bitval is at 10-bit
+// clang-format off
+const uint8_t IR_DIST_MIN = 16;   // [cm]
+const uint8_t IR_DIST_MAX = 150;  // [cm]
+const float   IR_CALIB_A = 1512.89;
+const uint8_t IR_CALIB_B = 74;
+const float   IR_CALIB_C = 0.424;
+const uint8_t IR_FP_SCALE = 64;   // Fixed-point scaling of the running average
+const uint8_t IR_AVG_N = 20;      // [samples] Window of the running average
+const float   IR_AB_ALPHA = 0.3;  // Alpha-beta gain on the distance
+const float   IR_AB_BETA = 0.03;  // Alpha-beta gain on the rate of change
+const uint8_t IR_LAT_BIN = 2;     // [ms] Width of a latency histogram bin
+// clang-format on
+
+// [ms] Longest latency expected: The median picks a sample up to 2 periods
+// old, each period stretched by a pass of the main loop taking a frame at
+// `FLC::QOS_MIN_FPS`. That sample then waits for the next frame, which takes
+// up to another frame to calculate and send out.
+const uint16_t IR_LAT_SPAN = 2 * FLC::IR_PERIOD + 4000 / FLC::QOS_MIN_FPS;
+
+// Bins of the latency histogram, the last one collecting everything beyond
+const uint8_t IR_LAT_N_BINS = IR_LAT_SPAN / IR_LAT_BIN + 1;
+
+// [samples] Window of the running average in standby, same span in time
+const uint8_t IR_AVG_N_STANDBY =
+    IR_AVG_N * FLC::IR_PERIOD >= FLC::STANDBY_IR_PERIOD
+        ? IR_AVG_N * FLC::IR_PERIOD / FLC::STANDBY_IR_PERIOD
+        : 1;
+
+// Longest prediction ahead of the tracked sample: The median picks a sample up
+// to one period old, and the next frame is due within another period
+const uint32_t IR_AB_MAX_AHEAD = 2000UL * FLC::IR_PERIOD; // [us]
+
+// Re-initialize the tracker after a longer gap in between samples
+const uint32_t IR_AB_MAX_GAP = 10000UL * FLC::STANDBY_IR_PERIOD; // [us]
+
+static const char *const IR_filter_names[] = {"average", "alpha-beta"};
+
+struct IR_Sample {
+  uint32_t t_us; // `micros()` at the moment of sampling
+  float cm;
+};
+
+class IR_Distance {
+private:
+  bool _predict = FLC::IR_PREDICT; // Publish the alpha-beta tracker?
+
+  // Median of 3, newest sample last
+  IR_Sample _win[3];
+  uint8_t _n_win = 0;
+
+  // Running averages, awake and in standby, store [cm] * `IR_FP_SCALE`
+  RunningStats<IR_AVG_N, uint16_t> _RS;
+  RunningStats<IR_AVG_N_STANDBY, uint16_t> _RS_standby;
+  bool _standby = false;
+
+  // Alpha-beta tracker, valid at `_t_ab_us`
+  bool _ab_valid = false;
+  uint32_t _t_ab_us = 0;
+  float _x = 0; // [cm]
+  float _v = 0; // [cm/s]
+
+  // Latency from the sample the published filter is based on up to sending
+  // out the first frame using it
+  uint32_t _t_median_us = 0;  // `micros()` of the newest median sample
+  bool _fresh = false;        // Newest median is waiting for its first frame
+  bool _pending = false;      // A published frame is waiting to be sent out
+  uint32_t _t_pending_us = 0; // `micros()` of the sample of that frame
+  uint16_t _hist[IR_LAT_N_BINS];
+  uint32_t _n_lat = 0;
+  uint32_t _sum_lat_us = 0;
+  uint32_t _max_lat_us = 0;
+
+  IR_Sample median() {
+    /* The median sample of the window, carrying its own timestamp
+     */
+    if (_n_win < 3) {
+      return _win[_n_win - 1];
+    }
+    const float a = _win[0].cm, b = _win[1].cm, c = _win[2].cm;
+    if ((a <= b) == (b <= c)) {
+      return _win[1];
+    }
+    if ((b <= a) == (a <= c)) {
+      return _win[0];
+    }
+    return _win[2];
+  }
+
+  void track(IR_Sample s) {
+    /* Alpha-beta update with sample `s`, skipping samples that are not newer
+    than the tracker, as the median might hand back an older sample
+    */
+    const int32_t dt_us = s.t_us - _t_ab_us;
+
+    if (!_ab_valid || (dt_us > (int32_t)IR_AB_MAX_GAP)) {
+      _x = s.cm;
+      _v = 0;
+      _t_ab_us = s.t_us;
+      _ab_valid = true;
+      return;
+    }
+    if (dt_us <= 0) {
+      return;
+    }
+
+    const float dt = dt_us * 1e-6f;
+    const float x_pred = _x + _v * dt;
+    const float r = s.cm - x_pred;
+    _x = x_pred + IR_AB_ALPHA * r;
+    _v += IR_AB_BETA / dt * r;
+    _t_ab_us = s.t_us;
+  }
+
+public:
+  uint16_t bitval = 0;  // Newest sample, raw
+  float instant_cm = 0; // Newest sample, calibrated
+
+  IR_Distance() { reset_latency(); }
+
+  static float to_cm(uint16_t bitval) {
+    /* Calibrated distance of a 10-bit reading
+     */
+    if (bitval < 80) { // Cap readings when distance is likely too small
+      return IR_DIST_MAX;
+    }
+    float cm = IR_CALIB_A / pow(bitval, IR_CALIB_C) - IR_CALIB_B;
+    return constrain(cm, IR_DIST_MIN, IR_DIST_MAX);
+  }
+
+  void add(uint16_t _bitval, uint32_t t_us) {
+    /* Add a 10-bit reading sampled at `micros()` = `t_us`
+     */
+    bitval = _bitval;
+    instant_cm = to_cm(bitval);
+
+    if (_n_win == 3) {
+      _win[0] = _win[1];
+      _win[1] = _win[2];
+      _n_win = 2;
+    }
+    _win[_n_win++] = {t_us, instant_cm};
+
+    IR_Sample m = median();
+    _RS.add(round(m.cm * IR_FP_SCALE));
+    _RS_standby.add(round(m.cm * IR_FP_SCALE));
+    track(m);
+
+    _t_median_us = m.t_us;
+    _fresh = true;
+  }
+
+  float estimate(uint32_t t_us) {
+    /* Filtered distance [cm] at `micros()` = `t_us`, by the selected filter
+     */
+    if (!_predict) {
+      return (_standby ? _RS_standby.getAverage() : _RS.getAverage()) /
+             IR_FP_SCALE;
+    }
+    uint32_t ahead = min(t_us - _t_ab_us, IR_AB_MAX_AHEAD);
+    float cm = _x + _v * ahead * 1e-6f;
+    return constrain(cm, IR_DIST_MIN, IR_DIST_MAX);
+  }
+
+  float publish(uint32_t t_us) {
+    /* Filtered distance [cm] for the frame about to be calculated at
+    `micros()` = `t_us`. Keeps track of the sample it is based on, until
+    `frame_sent()`.
+    */
+    if (_fresh) {
+      _fresh = false;
+      _pending = true;
+      _t_pending_us = _predict ? _t_ab_us : _t_median_us;
+    }
+    return estimate(t_us);
+  }
+
+  void frame_sent(uint32_t t_us) {
+    /* The frame of the last `publish()` got sent out at `micros()` = `t_us`
+     */
+    if (!_pending) {
+      return;
+    }
+    _pending = false;
+
+    uint32_t lat_us = t_us - _t_pending_us;
+    uint16_t bin = min(lat_us / (1000UL * IR_LAT_BIN),
+                       (uint32_t)(IR_LAT_N_BINS - 1));
+    if (_hist[bin] < UINT16_MAX) {
+      _hist[bin]++;
+    }
+    _n_lat++;
+    _sum_lat_us += lat_us;
+    _max_lat_us = max(_max_lat_us, lat_us);
+  }
+
+  void set_standby(bool standby) {
+    /* Switch the running average over to the standby window, or back
+     */
+    if (_standby && !standby && _RS_standby.getCount()) {
+      _RS.fill(round(_RS_standby.getAverage()));
+    }
+    _standby = standby;
+  }
+
+  bool predict() { return _predict; }
+
+  void set_predict(bool predict) { _predict = predict; }
+
+  const uint16_t *latency_histogram() { return _hist; }
+
+  void reset_latency() {
+    memset(_hist, 0, sizeof(_hist));
+    _n_lat = 0;
+    _sum_lat_us = 0;
+    _max_lat_us = 0;
+  }
+
+  void print_latency(Stream *mySerial) {
+    /* Print the latency histogram and reset it
+     */
+    uint16_t peak = 1;
+    for (uint8_t i = 0; i < IR_LAT_N_BINS; i++) {
+      peak = max(peak, _hist[i]);
+    }
+
+    mySerial->print("IR filter: ");
+    mySerial->println(IR_filter_names[_predict]);
+    mySerial->print("  Sample to frame sent [ms], ");
+    mySerial->print(_n_lat);
+    mySerial->println(" samples");
+    mySerial->print("  mean ");
+    mySerial->print(_n_lat ? _sum_lat_us / 1000.f / _n_lat : 0.f);
+    mySerial->print(", max ");
+    mySerial->println(_max_lat_us / 1000.f);
+    for (uint8_t i = 0; i < IR_LAT_N_BINS; i++) {
+      if (_hist[i] == 0) {
+        continue;
+      }
+      char buf[24];
+      snprintf(buf, sizeof(buf), "  %3u%s %5u ", i * IR_LAT_BIN,
+               i == IR_LAT_N_BINS - 1 ? "+ " : "- ", _hist[i]);
+      mySerial->print(buf);
+      for (uint8_t j = 0; j < (uint32_t)_hist[i] * 40 / peak; j++) {
+        mySerial->print('#');
+      }
+      mySerial->println();
+    }
+    reset_latency();
+  }
+};
+
+#endif
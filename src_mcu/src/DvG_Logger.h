@@ -0,0 +1,315 @@
+/* DvG_Logger.h
+
+Buffered, non-blocking logging of the recurring prints, like the effect and
+style changes, the FPS counter and the IR distance readings. When the USB host
+is slow or not reading at all, printing directly to `Serial` could block the
+render loop.
+
+`Log::log()` stores a compact binary record, a format ID plus its arguments,
+into a ring buffer and returns immediately. When the buffer is full the record
+gets dropped and counted. The count gets queued as a LOG_DROPPED record as
+soon as there is room again, in sequence: after the records queued before the
+drop, before the ones queued after it. `Log::drain()` gets called in idle time
+from the main loop and sends out a limited number of records per call, either:
+
+  - as text, rendered on the device from `log_formats`, including the ANSI
+    colours, or
+  - as binary packets, toggled by serial command 'g', to be rendered by the
+    host: `src_python/log_viewer.py`. The viewer reads `log_formats` straight
+    from this file, so keep each entry on a single line.
+
+Binary packet
+-------------
+  offset  size  field
+  0       2     sync: 0xA5, 0x5A
+  2       1     type: 0x20 LOG
+  3       1     format ID
+  4       1     number of arguments
+  5       ...   arguments: 4 bytes little-endian, or a 0-terminated string
+  ...     2     CRC-16/CCITT-FALSE over all bytes from offset 2
+
+Each record gets rendered into a line buffer of `LOG_LINE_SIZE` bytes first
+and is sent out only when all of it fits into `availableForWrite()`, so that
+`drain()` never blocks halfway. Otherwise it stays queued for the next call. A
+record larger than `Serial` can ever take at once gets sent out when its
+output buffer is at its emptiest seen.
+
+Format specifiers: %d int32, %u uint32, %f float, %s string. Strings must have
+static storage duration, as only their pointer gets buffered.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_LOGGER_H
+#define DVG_LOGGER_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_Stream.h"
+#include "DvG_FastLED_config.h"
+#include "ansi.h"
+
+#define LOG_TYPE 0x20
+#define LOG_NO_COLOR 0xFF
+#define LOG_MAX_ARGS 4
+#define LOG_LINE_SIZE 128 // [bytes] Longest rendered record, truncated beyond
+
+enum LogFormat : uint8_t {
+  LOG_DROPPED,
+  LOG_FX,
+  LOG_FX_OVERRIDE,
+  LOG_STYLE,
+  LOG_FPS,
+  LOG_IR_DIST,
+  LOG_AUDIENCE_PRESENT,
+  LOG_AUDIENCE_LOST,
+  LOG_CLICK,
+  LOG_QOS,
+  LOG_N_FORMATS
+};
+
+struct LogFormatEntry {
+  uint8_t color; // ANSI colour
+  const char *fmt;
+};
+
+// clang-format off
+const LogFormatEntry log_formats[] = {
+  /* LOG_DROPPED          */ {ANSI::red                , "Log: %u records dropped"},
+  /* LOG_FX               */ {ANSI::yellow             , "Effect: %u - \"%s\""},
+  /* LOG_FX_OVERRIDE      */ {ANSI::yellow             , "Effect: * - \"%s\""},
+  /* LOG_STYLE            */ {ANSI::white | ANSI::bright, "Style : %u - %s"},
+  /* LOG_FPS              */ {LOG_NO_COLOR             , "%u"},
+  /* LOG_IR_DIST          */ {LOG_NO_COLOR             , "%u\t%u\t%f\t%u"},
+  /* LOG_AUDIENCE_PRESENT */ {ANSI::green              , "Audience present"},
+  /* LOG_AUDIENCE_LOST    */ {ANSI::red                , "Lost interest from audience"},
+  /* LOG_CLICK            */ {LOG_NO_COLOR             , "single click"},
+  /* LOG_QOS              */ {ANSI::yellow             , "Quality: level %u of %u, effect cost %u us"},
+};
+// clang-format on
+
+static_assert(sizeof(log_formats) / sizeof(log_formats[0]) == LOG_N_FORMATS,
+              "`log_formats` does not match `LogFormat`");
+
+union LogArg {
+  int32_t i;
+  uint32_t u;
+  float f;
+  const char *s;
+
+  LogArg() : u{0} {}
+  LogArg(int v) : i{v} {}
+  LogArg(long v) : i{(int32_t)v} {}
+  LogArg(unsigned int v) : u{v} {}
+  LogArg(unsigned long v) : u{(uint32_t)v} {}
+  LogArg(float v) : f{v} {}
+  LogArg(double v) : f{(float)v} {}
+  LogArg(const char *v) : s{v} {}
+};
+
+class LogLine : public Stream {
+  /* A rendered record, to be sent out whole
+   */
+public:
+  uint8_t buf[LOG_LINE_SIZE];
+  uint16_t len = 0;
+
+  size_t write(uint8_t c) override {
+    if (len == LOG_LINE_SIZE) {
+      return 0;
+    }
+    buf[len++] = c;
+    return 1;
+  }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+namespace Log {
+  // Ring buffer of records: format ID, number of arguments, arguments
+  static uint8_t buf[FLC::LOG_BUFFER_SIZE];
+  static uint16_t head = 0; // Read position
+  static uint16_t tail = 0; // Write position
+  static uint32_t n_dropped = 0;
+  static bool binary = false;
+
+  static_assert((FLC::LOG_BUFFER_SIZE & (FLC::LOG_BUFFER_SIZE - 1)) == 0,
+                "FLC::LOG_BUFFER_SIZE must be a power of 2");
+
+  inline uint16_t used() {
+    return (tail - head) & (FLC::LOG_BUFFER_SIZE - 1);
+  }
+
+  inline void put(const void *data, uint8_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (len--) {
+      buf[tail] = *p++;
+      tail = (tail + 1) & (FLC::LOG_BUFFER_SIZE - 1);
+    }
+  }
+
+  inline void get(uint16_t &pos, void *data, uint8_t len) {
+    /* Read from position `pos` onwards, leaving `head` as is
+     */
+    uint8_t *p = (uint8_t *)data;
+    while (len--) {
+      *p++ = buf[pos];
+      pos = (pos + 1) & (FLC::LOG_BUFFER_SIZE - 1);
+    }
+  }
+
+  template <typename... Args> void log(LogFormat fmt, Args... args) {
+    /* Store a record, or count it as dropped when the buffer is full
+     */
+    static_assert(sizeof...(args) <= LOG_MAX_ARGS, "Too many log arguments");
+    const LogArg argv[sizeof...(args) + 1] = {LogArg(args)...};
+    const uint8_t argc = sizeof...(args);
+    const uint16_t len = 2 + argc * sizeof(LogArg);
+    const uint16_t len_dropped = 2 + sizeof(LogArg);
+
+    // One byte stays free to tell a full buffer from an empty one. Earlier
+    // drops get reported first, in sequence.
+    if (FLC::LOG_BUFFER_SIZE - 1 - used() <
+        len + (n_dropped ? len_dropped : 0)) {
+      n_dropped++;
+      return;
+    }
+    if (n_dropped) {
+      const uint8_t fmt_dropped = LOG_DROPPED;
+      const uint8_t argc_dropped = 1;
+      const LogArg arg_dropped(n_dropped);
+      put(&fmt_dropped, 1);
+      put(&argc_dropped, 1);
+      put(&arg_dropped, sizeof(LogArg));
+      n_dropped = 0;
+    }
+    put(&fmt, 1);
+    put(&argc, 1);
+    put(argv, argc * sizeof(LogArg));
+  }
+
+  void render_text(Stream *mySerial, uint8_t fmt, const LogArg *argv) {
+    const char *c = log_formats[fmt].fmt;
+    uint8_t i_arg = 0;
+
+#ifdef USE_ANSI
+    ANSI ansi(mySerial);
+    if (log_formats[fmt].color != LOG_NO_COLOR) {
+      ansi.foreground(log_formats[fmt].color);
+    }
+#endif
+    for (; *c; c++) {
+      if ((*c != '%') || (c[1] == 0)) {
+        mySerial->write(*c);
+        continue;
+      }
+      c++;
+      switch (*c) {
+        // clang-format off
+        case 'd': mySerial->print(argv[i_arg++].i); break;
+        case 'u': mySerial->print(argv[i_arg++].u); break;
+        case 'f': mySerial->print(argv[i_arg++].f); break;
+        case 's': mySerial->print(argv[i_arg++].s); break;
+        default : mySerial->write(*c); break;
+        // clang-format on
+      }
+    }
+    mySerial->println();
+#ifdef USE_ANSI
+    if (log_formats[fmt].color != LOG_NO_COLOR) {
+      ansi.normal();
+    }
+#endif
+  }
+
+  void render_binary(Stream *mySerial, uint8_t fmt, uint8_t argc,
+                     const LogArg *argv) {
+    const char *c = log_formats[fmt].fmt;
+    uint8_t header[5] = {STREAM_SYNC_0, STREAM_SYNC_1, LOG_TYPE, fmt, argc};
+    uint16_t crc = 0xFFFF;
+
+    auto emit = [&](const uint8_t *data, uint16_t len) {
+      for (uint16_t i = 0; i < len; i++) {
+        crc = crc16_ccitt(crc, data[i]);
+      }
+      mySerial->write(data, len);
+    };
+
+    mySerial->write(header, 2);
+    emit(&header[2], 3);
+    for (uint8_t i_arg = 0; i_arg < argc; i_arg++) {
+      // Find the matching format specifier
+      while (*c && ((*c != '%') || (c[1] == '%'))) {
+        c += (*c == '%') ? 2 : 1;
+      }
+      if (*c && (c[1] == 's')) {
+        emit((const uint8_t *)argv[i_arg].s, strlen(argv[i_arg].s) + 1);
+      } else {
+        uint32_t u = argv[i_arg].u;
+        uint8_t le[4] = {(uint8_t)u, (uint8_t)(u >> 8), (uint8_t)(u >> 16),
+                         (uint8_t)(u >> 24)};
+        emit(le, 4);
+      }
+      c += *c ? 2 : 0;
+    }
+    mySerial->write((uint8_t)crc);
+    mySerial->write((uint8_t)(crc >> 8));
+  }
+
+  void drain(Stream *mySerial) {
+    /* Send out at most `FLC::LOG_DRAIN_MAX` records, each only when it fits
+    into `availableForWrite()` whole. To be called in idle time.
+    */
+    static int max_free = 0; // Emptiest output buffer seen
+    LogArg argv[LOG_MAX_ARGS];
+    uint8_t fmt;
+    uint8_t argc;
+    uint16_t pos = head;
+
+    for (uint8_t i = 0; i < FLC::LOG_DRAIN_MAX; i++) {
+      bool queued = used();
+      if (queued) {
+        get(pos, &fmt, 1);
+        get(pos, &argc, 1);
+        get(pos, argv, argc * sizeof(LogArg));
+      } else if (n_dropped) {
+        // Nothing left queued before the drops
+        fmt = LOG_DROPPED;
+        argc = 1;
+        argv[0].u = n_dropped;
+      } else {
+        return;
+      }
+
+      LogLine line;
+      if (binary) {
+        render_binary(&line, fmt, argc, argv);
+      } else {
+        render_text(&line, fmt, argv);
+      }
+
+      int n_free = mySerial->availableForWrite();
+      max_free = max(max_free, n_free);
+      if ((line.len > n_free) && (n_free < max_free)) {
+        return; // Keep it queued
+      }
+      mySerial->write(line.buf, line.len);
+      if (queued) {
+        head = pos;
+      } else {
+        n_dropped = 0;
+      }
+    }
+  }
+
+  void flush(Stream *mySerial) {
+    /* Send out all buffered records, blocking
+     */
+    while (used() || n_dropped) {
+      drain(mySerial);
+    }
+  }
+} // namespace Log
+
+#endif
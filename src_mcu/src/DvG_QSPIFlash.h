@@ -0,0 +1,245 @@
+/* DvG_QSPIFlash.h
+
+Minimal driver for the external 2 MB QSPI flash chip of the Adafruit ItsyBitsy
+M4 and Feather M4, using the QSPI peripheral of the SAMD51 directly. Only the
+basic, single-bit SPI commands shared by all supported flash chips are used:
+reading, 4 kB sector and 64 kB block erase and 256-byte page programming.
+
+Reads and writes go through the memory-mapped AHB window of the QSPI
+peripheral. The peripheral clocks the bytes over the bus, but the CPU copies
+each byte in or out of the window itself, see `run_cmd()`. DMA would take that
+copy off the CPU, but is not used, to keep the driver minimal.
+
+On a host PC a flash image file of the same 2 MB takes its place, see
+`begin()`, with identical behaviour: erasing sets bytes to 0xFF and
+programming can only clear bits. Like the flash chip, its contents persist in
+between runs.
+
+NOTE: The flash chip might hold a CircuitPython filesystem. It gets overwritten.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_QSPIFLASH_H
+#define DVG_QSPIFLASH_H
+
+#include <Arduino.h>
+
+#ifdef PIN_QSPI_SCK
+#include "wiring_private.h" // pinPeripheral()
+#endif
+
+namespace QSPIFlash {
+  const uint32_t PAGE_SIZE = 256;
+  const uint32_t SECTOR_SIZE = 4096;
+  const uint32_t BLOCK_SIZE = 65536;
+
+#ifdef PIN_QSPI_SCK
+  const uint32_t SIZE = 2097152; // [bytes]
+
+  // Single-bit SPI command set
+  const uint8_t CMD_PAGE_PROGRAM = 0x02;
+  const uint8_t CMD_READ_STATUS = 0x05;
+  const uint8_t CMD_WRITE_ENABLE = 0x06;
+  const uint8_t CMD_FAST_READ = 0x0B;
+  const uint8_t CMD_SECTOR_ERASE = 0x20;
+  const uint8_t CMD_RESET_ENABLE = 0x66;
+  const uint8_t CMD_RESET = 0x99;
+  const uint8_t CMD_BLOCK_ERASE = 0xD8;
+
+  const uint32_t FRAME_CMD = QSPI_INSTRFRAME_WIDTH_SINGLE_BIT_SPI |
+                             QSPI_INSTRFRAME_ADDRLEN_24BITS |
+                             QSPI_INSTRFRAME_INSTREN;
+
+  void run_cmd(uint8_t cmd, uint32_t frame, uint32_t addr = 0,
+               uint8_t *buf = nullptr, uint32_t len = 0) {
+    /* Run a single instruction frame, transferring `len` bytes of `buf` over
+    the memory-mapped window when the frame has its data phase enabled
+    */
+    volatile uint8_t *mem = (volatile uint8_t *)(QSPI_AHB + addr);
+
+    QSPI->INSTRCTRL.bit.INSTR = cmd;
+    QSPI->INSTRADDR.reg = addr;
+    QSPI->INSTRFRAME.reg = frame;
+    (void)QSPI->INSTRFRAME.reg; // Synchronize the write
+
+    if (buf && len) {
+      if ((frame & QSPI_INSTRFRAME_TFRTYPE_Msk) ==
+          QSPI_INSTRFRAME_TFRTYPE_WRITEMEMORY) {
+        for (uint32_t i = 0; i < len; i++) {
+          mem[i] = buf[i];
+        }
+        __DSB();
+        __ISB();
+      } else {
+        for (uint32_t i = 0; i < len; i++) {
+          buf[i] = mem[i];
+        }
+      }
+    }
+
+    QSPI->CTRLA.reg = QSPI_CTRLA_ENABLE | QSPI_CTRLA_LASTXFER;
+    while (!QSPI->INTFLAG.bit.INSTREND) {}
+    QSPI->INTFLAG.reg = QSPI_INTFLAG_INSTREND;
+  }
+
+  void wait_ready() {
+    /* Block until the flash chip has finished erasing or programming
+     */
+    uint8_t status;
+    do {
+      run_cmd(CMD_READ_STATUS,
+              FRAME_CMD | QSPI_INSTRFRAME_DATAEN |
+                  QSPI_INSTRFRAME_TFRTYPE_READ,
+              0, &status, 1);
+    } while (status & 0x01); // Write in progress
+  }
+
+  void write_enable() {
+    run_cmd(CMD_WRITE_ENABLE, FRAME_CMD | QSPI_INSTRFRAME_TFRTYPE_READ);
+  }
+
+  void begin() {
+    MCLK->APBCMASK.bit.QSPI_ = 1;
+    MCLK->AHBMASK.bit.QSPI_ = 1;
+    MCLK->AHBMASK.bit.QSPI_2X_ = 0;
+
+    QSPI->CTRLA.bit.SWRST = 1;
+
+    pinPeripheral(PIN_QSPI_SCK, PIO_COM);
+    pinPeripheral(PIN_QSPI_CS, PIO_COM);
+    pinPeripheral(PIN_QSPI_IO0, PIO_COM);
+    pinPeripheral(PIN_QSPI_IO1, PIO_COM);
+    pinPeripheral(PIN_QSPI_IO2, PIO_COM);
+    pinPeripheral(PIN_QSPI_IO3, PIO_COM);
+
+    QSPI->CTRLB.reg = QSPI_CTRLB_MODE_MEMORY | QSPI_CTRLB_CSMODE_LASTXFER |
+                      QSPI_CTRLB_DATALEN_8BITS;
+    QSPI->BAUD.reg = QSPI_BAUD_BAUD(VARIANT_MCK / 24000000UL); // 24 MHz
+    QSPI->CTRLA.reg = QSPI_CTRLA_ENABLE;
+
+    run_cmd(CMD_RESET_ENABLE, FRAME_CMD | QSPI_INSTRFRAME_TFRTYPE_READ);
+    run_cmd(CMD_RESET, FRAME_CMD | QSPI_INSTRFRAME_TFRTYPE_READ);
+    delayMicroseconds(30);
+  }
+
+  void read(uint32_t addr, uint8_t *buf, uint32_t len) {
+    run_cmd(CMD_FAST_READ,
+            FRAME_CMD | QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_DATAEN |
+                QSPI_INSTRFRAME_TFRTYPE_READMEMORY |
+                QSPI_INSTRFRAME_DUMMYLEN(8),
+            addr, buf, len);
+  }
+
+  void erase(uint32_t addr, bool block = false) {
+    /* Erase the 4 kB sector, or the 64 kB block, containing `addr`. Typically
+    takes 50 ms, respectively 150 ms.
+    */
+    write_enable();
+    run_cmd(block ? CMD_BLOCK_ERASE : CMD_SECTOR_ERASE,
+            FRAME_CMD | QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_TFRTYPE_READ,
+            addr & ~((block ? BLOCK_SIZE : SECTOR_SIZE) - 1));
+    wait_ready();
+  }
+
+  void program_page(uint32_t addr, const uint8_t *buf, uint32_t len) {
+    /* Program at most up to the end of the page containing `addr`
+     */
+    write_enable();
+    run_cmd(CMD_PAGE_PROGRAM,
+            FRAME_CMD | QSPI_INSTRFRAME_ADDREN | QSPI_INSTRFRAME_DATAEN |
+                QSPI_INSTRFRAME_TFRTYPE_WRITEMEMORY,
+            addr, (uint8_t *)buf, len);
+    wait_ready();
+  }
+
+#elif defined(DVG_HOST)
+  // Stand-in for host builds: a flash image file
+
+  const uint32_t SIZE = 2097152; // [bytes]
+  static FILE *image = nullptr;
+
+  void begin(const char *path = "qspi_flash.bin") {
+    /* Open the flash image file at `path`, creating it all erased when it
+    does not exist yet
+    */
+    if (image) {
+      fclose(image);
+    }
+    image = fopen(path, "r+b");
+    if (image == nullptr) {
+      image = fopen(path, "w+b");
+      if (image == nullptr) {
+        perror(path);
+        exit(1);
+      }
+      for (uint32_t i = 0; i < SIZE; i++) {
+        fputc(0xFF, image);
+      }
+    }
+  }
+
+  FILE *seek(uint32_t addr, uint32_t len) {
+    /* Position the image file at `addr`, opening the default one when
+    `begin()` has not been called. Out-of-range access is a bug, abort.
+    */
+    if (image == nullptr) {
+      begin();
+    }
+    if ((uint64_t)addr + len > SIZE) {
+      fprintf(stderr, "QSPIFlash: 0x%x + %u out of range\n", addr, len);
+      abort();
+    }
+    fseek(image, addr, SEEK_SET);
+    return image;
+  }
+
+  void read(uint32_t addr, uint8_t *buf, uint32_t len) {
+    if (fread(buf, 1, len, seek(addr, len)) != len) {
+      memset(buf, 0xFF, len);
+    }
+  }
+
+  void erase(uint32_t addr, bool block = false) {
+    uint32_t size = block ? BLOCK_SIZE : SECTOR_SIZE;
+    FILE *f = seek(addr & ~(size - 1), size);
+    for (uint32_t i = 0; i < size; i++) {
+      fputc(0xFF, f);
+    }
+    fflush(f);
+  }
+
+  void program_page(uint32_t addr, const uint8_t *buf, uint32_t len) {
+    /* Program at most up to the end of the page containing `addr`
+     */
+    uint8_t page[PAGE_SIZE];
+
+    len = min(len, PAGE_SIZE - (addr % PAGE_SIZE));
+    read(addr, page, len);
+    for (uint32_t i = 0; i < len; i++) {
+      page[i] &= buf[i];
+    }
+    fwrite(page, 1, len, seek(addr, len));
+    fflush(image);
+  }
+
+#else
+#error "DvG_QSPIFlash.h: No QSPI flash on this board"
+#endif
+
+  void write(uint32_t addr, const uint8_t *buf, uint32_t len) {
+    /* Program `len` bytes at `addr`, split over pages. The area must have been
+    erased.
+    */
+    while (len) {
+      uint32_t chunk = PAGE_SIZE - (addr % PAGE_SIZE);
+      chunk = chunk < len ? chunk : len;
+      program_page(addr, buf, chunk);
+      addr += chunk;
+      buf += chunk;
+      len -= chunk;
+    }
+  }
+} // namespace QSPIFlash
+
+#endif
@@ -0,0 +1,125 @@
+/* DvG_Standby.h
+
+Deep-idle standby support for the SAMD51, used while the mirror is asleep and
+waiting for an audience.
+
+While in standby:
+  - The core clock gets divided by `FLC::STANDBY_CPU_DIV`. The SysTick reload
+    value is scaled along, so that `millis()` keeps its pace. The peripherals
+    that run on their own generic clocks, like USB and the ADC, are unaffected.
+  - `idle()` halts the core in IDLE sleep mode until the next interrupt. The
+    SysTick interrupt acts as the timer wake-up, every 1 ms.
+  - The CPU duty cycle, i.e. the fraction of time the core is awake, is
+    measured by the DWT cycle counter, which stops counting during sleep.
+
+NOTE: `micros()` interpolates inside the current millisecond assuming the full
+core clock, so its sub-millisecond part is inaccurate during standby.
+
+Dennis van Gils
+18-10-2026
+*/
+#ifndef DVG_STANDBY_H
+#define DVG_STANDBY_H
+
+#include <Arduino.h>
+
+#include "DvG_FastLED_config.h"
+
+namespace Standby {
+  static bool active = false;
+  static uint32_t t_enter = 0;       // [ms] `millis()` at entering standby
+  static uint32_t awake_cycles = 0;  // Core cycles spent awake in standby
+  static uint32_t cycles_wake = 0;   // DWT cycle count at the last wake-up
+  static float last_duty_cycle = 1;  // Duty cycle of the last standby period
+
+  void enter() {
+    /* Divide the core clock and start measuring the duty cycle
+     */
+    if (active) {
+      return;
+    }
+    active = true;
+    t_enter = millis();
+    awake_cycles = 0;
+
+#ifdef __SAMD51__
+    // Enable the DWT cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Sleep mode IDLE: only the core clock gets halted by `__WFI()`
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+    PM->SLEEPCFG.reg = PM_SLEEPCFG_SLEEPMODE_IDLE;
+    while (PM->SLEEPCFG.reg != PM_SLEEPCFG_SLEEPMODE_IDLE) {}
+
+    // Divide the core clock and keep SysTick at 1 ms
+    if (FLC::STANDBY_CPU_DIV > 1) {
+      noInterrupts();
+      MCLK->CPUDIV.reg = MCLK_CPUDIV_DIV(FLC::STANDBY_CPU_DIV);
+      SysTick->LOAD = VARIANT_MCK / FLC::STANDBY_CPU_DIV / 1000 - 1;
+      SysTick->VAL = 0;
+      interrupts();
+    }
+
+    cycles_wake = DWT->CYCCNT;
+#endif
+  }
+
+  void exit() {
+    /* Restore the full core clock
+     */
+    if (!active) {
+      return;
+    }
+
+#ifdef __SAMD51__
+    awake_cycles += DWT->CYCCNT - cycles_wake;
+
+    if (FLC::STANDBY_CPU_DIV > 1) {
+      noInterrupts();
+      MCLK->CPUDIV.reg = MCLK_CPUDIV_DIV_DIV1;
+      SysTick->LOAD = VARIANT_MCK / 1000 - 1;
+      SysTick->VAL = 0;
+      interrupts();
+    }
+#endif
+
+    uint32_t dt = millis() - t_enter;
+    if (dt) {
+      last_duty_cycle = (float)awake_cycles /
+                        ((float)dt * (F_CPU / FLC::STANDBY_CPU_DIV / 1000));
+    }
+    active = false;
+  }
+
+  void idle() {
+    /* Halt the core until the next interrupt
+     */
+    if (!active) {
+      return;
+    }
+
+#ifdef __SAMD51__
+    awake_cycles += DWT->CYCCNT - cycles_wake;
+    __DSB();
+    __WFI();
+    cycles_wake = DWT->CYCCNT;
+#endif
+  }
+
+  float duty_cycle() {
+    /* CPU duty cycle [0 - 1] of the current, or else of the last, standby
+    period
+    */
+    if (!active) {
+      return last_duty_cycle;
+    }
+
+    uint32_t dt = millis() - t_enter;
+    return dt ? (float)awake_cycles /
+                    ((float)dt * (F_CPU / FLC::STANDBY_CPU_DIV / 1000))
+              : 1;
+  }
+} // namespace Standby
+
+#endif
@@ -5,104 +5,105 @@ Dennis van Gils
 */
 
 #include <Arduino.h>
-#include <vector>
+#include <array>
 
 #include "FastLED.h"
 #include "FiniteStateMachine.h"
-#include "RunningAverage.h"
-#include "avdweb_Switch.h"
 
 FASTLED_USING_NAMESPACE
 
 #define Ser Serial
-#define USE_ANSI
-#ifdef USE_ANSI
-#  include "ansi.h"
-ANSI ansi(&Ser);
-#endif
+#define USE_ANSI // Colour the log, see `DvG_Logger.h`
 
+#include "DvG_APA102_MultiSPI.h"
+#include "DvG_ButtonCapture.h"
+#include "DvG_FastLED_Benchmark.h"
+#include "DvG_FastLED_Capture.h"
 #include "DvG_FastLED_EffectManager.h"
+#include "DvG_FastLED_Playlists.h"
+#include "DvG_FastLED_Power.h"
 #include "DvG_FastLED_config.h"
 #include "DvG_FastLED_effects.h"
+#include "DvG_IR_Distance.h"
+#include "DvG_Standby.h"
 
 static bool ENA_auto_next_fx = true; // Automatically go to next effect?
 static bool ENA_print_FPS = false;   // Print FPS counter to serial?
 
+// Loop latency: The longest time between two consecutive passes of `loop()`.
+// It bounds the latency of serial commands, IR sampling and audience detection.
+static uint32_t loop_tick_us = 0;   // [us] `micros()` at the last loop pass
+static uint32_t loop_max_dt_us = 0; // [us] Longest loop period since reset
+
 // Brightness
 uint8_t bright_idx = 11;
 const uint8_t bright_lut[] = {10,  30,  50,  70,  90,  110, 130,
                               150, 170, 190, 210, 230, 255};
 
+// Button edges are captured by interrupt and replayed at their timestamps
+// through the debounce, long-press and double-click logic during `poll()`
 const byte PIN_BUTTON = 9;
-Switch button = Switch(PIN_BUTTON, INPUT_PULLUP, LOW, 50, 500, 50);
+ButtonCapture button =
+    ButtonCapture(PIN_BUTTON, INPUT_PULLUP, LOW, 50, 500, 50);
+
+void button_ISR() {
+  button.capture();
+}
 
 /*------------------------------------------------------------------------------
-  Manager to the Finite State Machine which governs calculating the selected
-  FastLED effect
+  FastLED effect presets, see `DvG_FastLED_Playlists.h`
 ------------------------------------------------------------------------------*/
-// clang-format off
-// Initialize with a preset list of FastLED effects to show consecutively
-FastLED_EffectManager fx_mgr = FastLED_EffectManager({
-  //        FastLED effect       strip segmentation style           duration [ms]
-  //        --------------       ------------------------           -------------
-  FX_preset(fx__HeartBeatAwaken, StyleEnum::HALFWAY_PERIO_SPLIT_N2, 5800),
-  FX_preset(fx__RainbowSurf    , StyleEnum::FULL_STRIP            , 8000),
-  FX_preset(fx__RainbowBarf    , StyleEnum::PERIO_OPP_CORNERS_N2  , 11000),
-  FX_preset(fx__Dennis         , StyleEnum::PERIO_OPP_CORNERS_N2  , 13000),
-  FX_preset(fx__HeartBeat_2    , StyleEnum::PERIO_OPP_CORNERS_N2  , 9000),
-  FX_preset(fx__DoubleWave     , StyleEnum::COPIED_SIDES          , 19000),
-  FX_preset(fx__Sinelon        , StyleEnum::BI_DIR_SIDE2SIDE      , 13000),
-  FX_preset(fx__FadeToRed      , 0),
-  FX_preset(fx__FadeToBlack    , 0),
-});
-// clang-format on
+// Manager to the Finite State Machine which governs calculating the selected
+// FastLED effect. Initialize with a preset list of FastLED effects to show.
+FastLED_EffectManager fx_mgr = FastLED_EffectManager(fx_list_day);
 
 /*------------------------------------------------------------------------------
   IR distance sensor
 --------------------------------------------------------------------------------
-  Sharp 2Y0A02, pin A2
-  Fit: distance [cm] = A / bitval ^ C - B, where bitval is at 10-bit
+  Sharp 2Y0A02, pin A2, see `DvG_IR_Distance.h`
 */
-// clang-format off
 #define A2_BITS 10         // Calibration has been performed at 10 bits ADC only
 uint8_t IR_dist_cm = 0;    // IR distance in [cm]
 uint8_t IR_dist_fract = 0; // IR distance as fraction of the full scale [0-255]
-const uint8_t IR_DIST_MIN = 16;   // [cm]
-const uint8_t IR_DIST_MAX = 150;  // [cm]
-const float   IR_CALIB_A = 1512.89;
-const uint8_t IR_CALIB_B = 74;
-const float   IR_CALIB_C = 0.424;
-// clang-format on
+IR_Distance IR_sensor;
+
+void set_IR_dist(float cm) {
+  IR_dist_cm = cm;
+  IR_dist_fract = round((cm - IR_DIST_MIN) / (IR_DIST_MAX - IR_DIST_MIN) * 255);
+}
 
 void update_IR_dist() {
-  // Read out the IR distance sensor in [cm] and compute the running average
-  uint16_t bitval;
-  float instant_cm;
-  static RunningAverage RA(20);
-
-  // Read out instanteneous IR distance
-  bitval = analogRead(PIN_A2);
-  if (bitval < 80) { // Cap readings when distance is likely too small
-    instant_cm = IR_DIST_MAX;
-  } else {
-    instant_cm = IR_CALIB_A / pow(bitval, IR_CALIB_C) - IR_CALIB_B;
-    instant_cm = constrain(instant_cm, IR_DIST_MIN, IR_DIST_MAX);
+  // Read out the IR distance sensor and update the filters
+  uint32_t now_us = micros();
+  IR_sensor.add(analogRead(PIN_A2), now_us);
+  set_IR_dist(IR_sensor.estimate(now_us));
+
+  if (fx_mgr.fx_override() == FxOverrideEnum::IR_DIST) {
+    Log::log(LOG_IR_DIST, now_us / 1000, IR_sensor.bitval,
+             IR_sensor.instant_cm, IR_dist_cm);
   }
+}
 
-  // Apply running average
-  RA.addValue(instant_cm);
-  IR_dist_cm = RA.getAverage();
-  IR_dist_fract = round((RA.getAverage() - IR_DIST_MIN) /
-                        (IR_DIST_MAX - IR_DIST_MIN) * 255);
+/*------------------------------------------------------------------------------
+  Standby
 
-  if (fx_mgr.fx_override() == FxOverrideEnum::IR_DIST) {
-    Ser.print(bitval);
-    Ser.print("\t");
-    Ser.print(instant_cm);
-    Ser.print("\t");
-    Ser.print(IR_dist_cm);
-    Ser.print("\t");
-    Ser.println(IR_dist_fract);
+  Entered once `SleepAndWaitForAudience` has faded to black. No LED data is
+  send out, the core clock is divided and the IR distance sensor is sampled at
+  the reduced rate of `FLC::STANDBY_IR_PERIOD`. The core sleeps in between
+  timer ticks. Standby is left within one IR sample of detecting an audience.
+------------------------------------------------------------------------------*/
+
+void enter_standby() {
+  fx_mgr.enter_standby();
+  IR_sensor.set_standby(true);
+  Standby::enter();
+}
+
+void exit_standby() {
+  if (fx_mgr.in_standby()) {
+    Standby::exit();
+    IR_sensor.set_standby(false);
+    fx_mgr.exit_standby();
   }
 }
 
@@ -149,19 +150,68 @@ FSM fsm_main = FSM(show__FastLED);
 ------------------------------------------------------------------------------*/
 static byte menu_idx = 1;             // Index starts at 1 == menu option 1
 static uint32_t menu_tick = millis(); // [ms] Keeps track of time
-static bool init_brightness_menu = false;
 
-void flash_menu(const struct CRGB &color) {
-  fill_solid(leds, FLC::N, CRGB::Black);
-  FastLED.delay(200);
-  fill_solid(leds, FLC::N, color);
-  FastLED.delay(200);
-  fill_solid(leds, FLC::N, CRGB::Black);
-  FastLED.delay(200);
-  fill_solid(leds, FLC::N, color);
-  FastLED.delay(200);
-  fill_solid(leds, FLC::N, CRGB::Black);
-  FastLED.delay(200);
+// The menu visuals are time-driven sub-states of `show__Menu`, rendering
+// incrementally at each pass of `loop()`. Hence, the menu never blocks serial
+// commands, IR sampling or audience detection.
+void upd__MenuFlashIn();
+void entr__MenuFlash();
+void entr__MenuOptions();
+void upd__MenuOptions();
+void entr__MenuBrightness();
+void upd__MenuBrightness();
+void upd__MenuFlashOut();
+
+enum MenuStateEnum {
+  MENU_IDLE,       // Menu not active
+  MENU_FLASH_IN,   // Flash red upon entering the menu
+  MENU_OPTIONS,    // Traverse menu options 1 to 5
+  MENU_BRIGHTNESS, // Set the brightness
+  MENU_FLASH_OUT,  // Flash green upon leaving the menu
+  MENU_N_STATES
+};
+
+// clang-format off
+constexpr StateDef menu_states[] = {
+  // name           enter                 update                exit
+  {"MenuIdle"      , nullptr             , nullptr             , nullptr},
+  {"MenuFlashIn"   , entr__MenuFlash     , upd__MenuFlashIn    , nullptr},
+  {"MenuOptions"   , entr__MenuOptions   , upd__MenuOptions    , nullptr},
+  {"MenuBrightness", entr__MenuBrightness, upd__MenuBrightness , nullptr},
+  {"MenuFlashOut"  , entr__MenuFlash     , upd__MenuFlashOut   , nullptr},
+};
+// clang-format on
+
+const uint8_t N_MENU_STATES = sizeof(menu_states) / sizeof(menu_states[0]);
+static_assert(N_MENU_STATES == MENU_N_STATES,
+              "`menu_states` does not match `MenuStateEnum`");
+
+StateTableFSM fsm_menu(menu_states, N_MENU_STATES, MENU_IDLE);
+
+/*------------------------------------------------------------------------------
+  Menu visuals
+------------------------------------------------------------------------------*/
+
+const uint16_t MENU_FLASH_PERIOD = 200; // [ms] Duration of each flash phase
+const uint8_t MENU_FLASH_PHASES = 5;    // Black, color, black, color, black
+static uint32_t menu_flash_t0;          // [ms] Start of the flash
+static int8_t menu_flash_phase;         // Flash phase currently on display
+
+bool render_menu_flash(const struct CRGB &color) {
+  /* Render the menu flash incrementally: alternating black and `color`, each
+  for `MENU_FLASH_PERIOD` ms. Returns true when the flash has finished.
+  */
+  uint32_t phase = (millis() - menu_flash_t0) / MENU_FLASH_PERIOD;
+  if (phase >= MENU_FLASH_PHASES) {
+    return true;
+  }
+  if (phase != (uint32_t)menu_flash_phase) {
+    menu_flash_phase = phase;
+    fill_solid(leds, FLC::N, phase % 2 ? color : CRGB::Black);
+    map_leds_to_output();
+    FastLED.show();
+  }
+  return false;
 }
 
 void show_menu_indicator() {
@@ -170,30 +220,28 @@ void show_menu_indicator() {
   fill_solid(leds, FLC::N, CRGB::Black);
   if (menu_idx == 1) {
     // Light up the four centers of the mirror sides
-    for (uint16_t idx = 0; idx < FLC::N; idx++) {
-      for (byte side_idx = 0; side_idx < 4; side_idx++) {
-        if ((idx > (side_idx * FLC::L + FLC::L / 2 - FLC::MENU_WIDTH)) &
-            (idx < (side_idx * FLC::L + FLC::L / 2 + FLC::MENU_WIDTH))) {
-          leds[idx] = CRGB::Red;
-        }
+    for (uint8_t side_idx = 0; side_idx < 4; side_idx++) {
+      int32_t center = FLC::GEOMETRY.side_start(side_idx) +
+                       FLC::GEOMETRY.side(side_idx) / 2;
+      for (int32_t idx = center - FLC::MENU_WIDTH + 1;
+           idx < center + FLC::MENU_WIDTH; idx++) {
+        leds[idx] = CRGB::Red;
       }
     }
 
   } else {
     // Light up the appropiate corner of the mirror
-    byte corner_idx = menu_idx - 2;
-    for (int16_t idx = -FLC::L; idx < FLC::N; idx++) {
-      if ((idx >= (corner_idx * FLC::L - FLC::MENU_WIDTH)) &
-          (idx < (corner_idx * FLC::L + FLC::MENU_WIDTH))) {
-        leds[(idx + FLC::N) % FLC::N] = CRGB::Red;
-      }
+    int32_t corner = FLC::GEOMETRY.side_start(menu_idx - 2);
+    for (int32_t idx = corner - FLC::MENU_WIDTH;
+         idx < corner + FLC::MENU_WIDTH; idx++) {
+      leds[(idx + FLC::N) % FLC::N] = CRGB::Red;
     }
   }
-  FastLED.delay(20);
+  map_leds_to_output();
+  FastLED.show();
 
   if (menu_idx == 1) {
     menu_tick = millis();
-    init_brightness_menu = true;
   }
 }
 
@@ -206,55 +254,92 @@ void show_brightness_menu() {
         (round(255.f * idx / FLC::L) <= FastLED.getBrightness() ? CRGB::Red
                                                                 : CRGB::Black);
   }
-  FastLED.delay(20);
+  map_leds_to_output();
+  FastLED.show();
 }
 
-void entr__ShowMenu() {
-  Ser.println("Entering MENU");
-  menu_idx = 1;
-  flash_menu(CRGB::Red);
+/*------------------------------------------------------------------------------
+  Menu sub-states
+------------------------------------------------------------------------------*/
+
+void entr__MenuFlash() {
+  menu_flash_t0 = millis();
+  menu_flash_phase = -1;
+}
+
+void upd__MenuFlashIn() {
+  if (render_menu_flash(CRGB::Red)) {
+    fsm_menu.transitionTo(MENU_OPTIONS);
+  }
+}
+
+void entr__MenuOptions() {
   show_menu_indicator();
 }
 
-void upd__ShowMenu() {
-  if ((menu_idx > 1) | ((menu_idx == 1) & (millis() - menu_tick < 1000))) {
-    // Handle menu options 2 to 5 and check time-out of menu option 1 to go into
-    // setting the brightness
-    if (fsm_main.timeInCurrentState() > 10000) {
-      fsm_main.transitionTo(show__FastLED);
-    }
+void upd__MenuOptions() {
+  // Handle menu options 1 to 5
+  if (fsm_main.timeInCurrentState() > 10000) {
+    fsm_menu.transitionTo(MENU_FLASH_OUT);
+  }
 
-    // Check for button presses
-    button.poll();
-    if (button.singleClick()) {
-      menu_idx = menu_idx % 5 + 1;
-      show_menu_indicator();
-    }
-    if (button.longPress()) {
-      fsm_main.transitionTo(show__FastLED);
-    }
+  // Check time-out of menu option 1 to go into setting the brightness
+  if ((menu_idx == 1) & (millis() - menu_tick >= 1000)) {
+    fsm_menu.transitionTo(MENU_BRIGHTNESS);
+    return;
+  }
 
-  } else {
-    // Setting the brightness
-    if (init_brightness_menu) {
-      Ser.println("Entering 'Set brightness'");
-      init_brightness_menu = false;
-      show_brightness_menu();
-    }
+  // Check for button presses
+  button.poll();
+  if (button.singleClick()) {
+    menu_idx = menu_idx % 5 + 1;
+    show_menu_indicator();
+  }
+  if (button.longPress()) {
+    fsm_menu.transitionTo(MENU_FLASH_OUT);
+  }
+}
 
-    // Check for button presses
-    button.poll();
-    if (button.singleClick()) {
-      bright_idx = (bright_idx + 1) % sizeof(bright_lut);
-      FastLED.setBrightness(bright_lut[bright_idx]);
-      show_brightness_menu();
-    }
-    if (button.longPress()) {
-      fsm_main.transitionTo(show__FastLED);
-    }
+void entr__MenuBrightness() {
+  Ser.println("Entering 'Set brightness'");
+  show_brightness_menu();
+}
+
+void upd__MenuBrightness() {
+  // Check for button presses
+  button.poll();
+  if (button.singleClick()) {
+    bright_idx = (bright_idx + 1) % sizeof(bright_lut);
+    FastLED.setBrightness(bright_lut[bright_idx]);
+    show_brightness_menu();
+  }
+  if (button.longPress()) {
+    fsm_menu.transitionTo(MENU_FLASH_OUT);
   }
 }
 
+void upd__MenuFlashOut() {
+  if (render_menu_flash(CRGB::Green)) {
+    fsm_menu.transitionTo(MENU_IDLE);
+    fsm_main.transitionTo(show__FastLED);
+  }
+}
+
+/*------------------------------------------------------------------------------
+  Show Menu state
+------------------------------------------------------------------------------*/
+
+void entr__ShowMenu() {
+  exit_standby();
+  Ser.println("Entering MENU");
+  menu_idx = 1;
+  fsm_menu.transitionTo(MENU_FLASH_IN);
+}
+
+void upd__ShowMenu() {
+  fsm_menu.update();
+}
+
 void exit__ShowMenu() {
   Ser.print("Exiting MENU with chosen option: ");
   Ser.println(menu_idx);
@@ -284,8 +369,6 @@ void exit__ShowMenu() {
                                                                        : "ON");
       break;
   }
-
-  flash_menu(CRGB::Green);
 }
 
 /*------------------------------------------------------------------------------
@@ -307,39 +390,59 @@ void upd__ShowFastLED() {
     // Go back to sleep
     fx_mgr.set_fx(FxOverrideEnum::SLEEP_AND_WAIT_FOR_AUDIENCE);
 
-#ifdef USE_ANSI
-    ansi.foreground(ANSI::red);
-#endif
-    Ser.println("Lost interest from audience");
-#ifdef USE_ANSI
-    ansi.normal();
-#endif
+    Log::log(LOG_AUDIENCE_LOST);
   }
 
-  // CRITICAL: Calculate the current FastLED effect
+  // CRITICAL: Calculate the current FastLED effect, with the IR distance as
+  // of now
+  set_IR_dist(IR_sensor.publish(micros()));
   fx_mgr.update();
 
   if (fx_mgr.fx_has_changed()) {
-    fx_mgr.print_fx(&Ser);
-    fx_mgr.print_style(&Ser);
+    fx_mgr.print_fx();
+    fx_mgr.print_style();
+  }
+
+  // Leave standby when the effect got changed, e.g. by a serial command
+  if (fx_mgr.in_standby() &
+      (fx_mgr.fx_override() != FxOverrideEnum::SLEEP_AND_WAIT_FOR_AUDIENCE)) {
+    exit_standby();
   }
 
   // Send out LED data to the strip. `delay()` keeps the framerate modest and
   // allows for brightness dithering. It will invoke FastLED.show() - sending
   // out the LED data - at least once during the delay.
-  FastLED.delay(2);
+  // No LED data is send out in standby, the strip is already all black.
+  if (!fx_mgr.in_standby()) {
+    anim_recorder.add(leds);
+    frame_capture.add(leds,
+                      fx_mgr.fx_override()
+                          ? CAPTURE_FX_OVERRIDE | fx_mgr.fx_override()
+                          : fx_mgr.fx_idx(),
+                      (uint8_t)segmntr1.get_style());
+    FastLED.setBrightness(
+        power_limiter.update(leds, bright_lut[bright_idx]));
+    map_leds_to_output();
+    FastLED.delay(2);
+    fx_mgr.frame_sent();
+    IR_sensor.frame_sent(micros());
+  }
+
+  if (fx_mgr.standby_requested()) {
+    enter_standby();
+  }
 
   // Print FPS counter
   EVERY_N_MILLISECONDS(1000) {
     if (ENA_print_FPS) {
-      Ser.println(FastLED.getFPS());
+      Log::log(LOG_FPS, FastLED.getFPS());
     }
   }
 
   // Check for button presses
   button.poll();
   if (button.singleClick()) {
-    Ser.println("single click");
+    Log::log(LOG_CLICK);
     if (!fx_mgr.fx_override()) {
       fx_mgr.next_fx();
     }
@@ -361,13 +464,7 @@ void upd__ShowFastLED() {
     }
     tick_audience = now;
 
-#ifdef USE_ANSI
-    ansi.foreground(ANSI::green);
-#endif
-    Ser.println("Audience present");
-#ifdef USE_ANSI
-    ansi.normal();
-#endif
+    Log::log(LOG_AUDIENCE_PRESENT);
 
   } else if (ENA_auto_next_fx & fx_has_finished & !fx_mgr.fx_override()) {
     // Auto-advance to the next FastLED effect in the presets list
@@ -383,16 +480,26 @@ void setup() {
   Ser.begin(115200);
 
   // Ensure a minimum delay for recovery of FastLED
-  // Generate `HeartBeat` look-up table in the mean time
+  // Generate `HeartBeat` and perimeter look-up tables in the mean time
   uint32_t tick = millis();
   generate_HeartBeat();
+  FLC::GEOMETRY.perimeter_xy(perimeter_xy);
+  QSPIFlash::begin();
   while (millis() - tick < 3000) {}
 
-  FastLED.addLeds<FLC::LED_TYPE, FLC::PIN_DATA, FLC::PIN_CLK, FLC::COLOR_ORDER,
-                  DATA_RATE_MHZ(1)>(leds, FLC::N);
+  if (FLC::N_CHANNELS > 1) {
+#ifdef ADAFRUIT_ITSYBITSY_M4_EXPRESS
+    MultiSPI::begin(get_output_leds());
+#endif
+  } else {
+    FastLED.addLeds<FLC::LED_TYPE, FLC::PIN_DATA, FLC::PIN_CLK,
+                    FLC::COLOR_ORDER, DATA_RATE_MHZ(1)>(get_output_leds(),
+                                                        FLC::N);
+  }
   FastLED.setCorrection(FLC::COLOR_CORRECTION);
   FastLED.setBrightness(bright_lut[bright_idx]);
   fill_solid(leds, FLC::N, CRGB::Black);
+  map_leds_to_output();
 
 #ifdef ADAFRUIT_ITSYBITSY_M4_EXPRESS
   // This code is needed to turn off the distracting onboard RGB LED
@@ -407,12 +514,17 @@ void setup() {
 
 #ifdef ADAFRUIT_ITSYBITSY_M4_EXPRESS
   // Remove the onboard RGB LED again from the FastLED controllers
-  FastLED[1].setLeds(onboard_led, 0);
+  FastLED[FastLED.count() - 1].setLeds(onboard_led, 0);
 #endif
 
+  // Button
+  button.begin(button_ISR);
+
   // IR distance sensor
   analogReadResolution(A2_BITS);
   update_IR_dist();
+
+  loop_tick_us = micros();
 }
 
 /*------------------------------------------------------------------------------
@@ -422,13 +534,42 @@ void setup() {
 void loop() {
   char char_cmd; // Incoming serial command
 
-  // Check for incoming serial commands
-  if (Ser.available() > 0) {
+  // Keep track of the loop latency
+  uint32_t now_us = micros();
+  if (now_us - loop_tick_us > loop_max_dt_us) {
+    loop_max_dt_us = now_us - loop_tick_us;
+  }
+  loop_tick_us = now_us;
+
+  // Check for incoming serial commands, unless a host PC is streaming frames,
+  // uploading a VM program or uploading an animation recording
+  if (frame_stream.is_active()) {
+    frame_stream.poll(&Ser);
+    if (!frame_stream.is_active()) {
+      fx_mgr.set_fx(FxOverrideEnum::NONE);
+      frame_stream.print_counters(&Ser);
+    }
+
+  } else if (vm_upload.is_active()) {
+    VM_UploadStatus status = vm_upload.poll(&Ser);
+    if (status != VM_UPLOAD_BUSY) {
+      Ser.print("Upload VM program: ");
+      Ser.println(status == VM_UPLOAD_OK ? "OK" : "REJECTED");
+    }
+
+  } else if (anim_upload.is_active()) {
+    AnimUploadStatus status = anim_upload.poll(&Ser);
+    if (status != ANIM_UPLOAD_BUSY) {
+      Ser.print("Upload recording: ");
+      Ser.println(status == ANIM_UPLOAD_OK ? "OK" : "REJECTED");
+    }
+
+  } else if (Ser.available() > 0) {
     char_cmd = Ser.read();
 
     if (char_cmd == '?') {
-      fx_mgr.print_fx(&Ser);
-      fx_mgr.print_style(&Ser);
+      fx_mgr.print_fx();
+      fx_mgr.print_style();
 
     } else if (char_cmd == '`') {
       Ser.print("Output: ");
@@ -451,6 +592,45 @@ void loop() {
                       ? "ON"
                       : "OFF");
 
+    } else if (char_cmd == 'y') {
+      Ser.print("Playback: ");
+      Ser.println(fx_mgr.toggle_fx_override(FxOverrideEnum::PLAYBACK) ? "ON"
+                                                                      : "OFF");
+
+    } else if (char_cmd == 'x') {
+      Ser.println("Streaming: Send binary frame packets, END packet to stop");
+      frame_stream.start();
+      fx_mgr.set_fx(FxOverrideEnum::STREAM);
+
+    } else if (char_cmd == 'g') {
+      Log::flush(&Ser);
+      Log::binary = !Log::binary;
+      Ser.print("Binary log: ");
+      Ser.println(Log::binary ? "ON" : "OFF");
+
+    } else if (char_cmd == 'c') {
+      if (frame_capture.is_active()) {
+        frame_capture.stop();
+        frame_capture.flush(&Ser);
+        frame_capture.print_bandwidth(&Ser);
+      } else {
+        frame_capture.start();
+      }
+
+    } else if (char_cmd == 'a') {
+      if (anim_recorder.is_recording()) {
+        anim_recorder.stop();
+      } else {
+        anim_recorder.start();
+      }
+      Ser.print("Recording: ");
+      Ser.println(anim_recorder.is_recording() ? "ON" : "OFF");
+      anim_recorder.print_info(&Ser);
+
+    } else if (char_cmd == 'd') {
+      anim_recorder.stop();
+      anim_upload.start();
+
     } else if (char_cmd == 'q') {
       ENA_auto_next_fx = !ENA_auto_next_fx;
       Ser.print("Auto-next FX: ");
@@ -467,11 +647,11 @@ void loop() {
 
     } else if (char_cmd == '[') {
       fx_mgr.prev_style();
-      fx_mgr.print_style(&Ser);
+      fx_mgr.print_style();
 
     } else if (char_cmd == ']') {
       fx_mgr.next_style();
-      fx_mgr.print_style(&Ser);
+      fx_mgr.print_style();
 
     } else if (char_cmd == '-') {
       bright_idx = bright_idx > 0 ? bright_idx - 1 : 0;
@@ -486,9 +666,64 @@ void loop() {
       Ser.print("Brightness ");
       Ser.println(bright_lut[bright_idx]);
 
+    } else if (char_cmd == 'n') {
+      bool night = !(fx_mgr.fx_list() == FX_playlist(fx_list_night));
+      fx_mgr.set_fx_list(night ? FX_playlist(fx_list_night)
+                               : FX_playlist(fx_list_day));
+      Ser.print("Night playlist: ");
+      Ser.println(night ? "ON" : "OFF");
+
     } else if (char_cmd == 'f') {
       ENA_print_FPS = !ENA_print_FPS;
 
+    } else if (char_cmd == 'l') {
+      Ser.print("Max loop latency [us]: ");
+      Ser.println(loop_max_dt_us);
+      loop_max_dt_us = 0;
+
+    } else if (char_cmd == 'h') {
+      IR_sensor.print_latency(&Ser);
+
+    } else if (char_cmd == 'j') {
+      IR_sensor.set_predict(!IR_sensor.predict());
+      Ser.print("IR filter: ");
+      Ser.println(IR_filter_names[IR_sensor.predict()]);
+
+    } else if (char_cmd == 's') {
+      Ser.print("Standby: ");
+      Ser.println(fx_mgr.in_standby() ? "ON" : "OFF");
+      Ser.print("  Sleep latency [us]: ");
+      Ser.println(fx_mgr.sleep_latency_us());
+      Ser.print("  Wake latency  [us]: ");
+      Ser.println(fx_mgr.wake_latency_us());
+      Ser.print("  CPU duty cycle [%]: ");
+      Ser.println(Standby::duty_cycle() * 100);
+
+    } else if (char_cmd == 't') {
+      Ser.print("Output channels: ");
+      Ser.println(FLC::N_CHANNELS);
+#ifdef ADAFRUIT_ITSYBITSY_M4_EXPRESS
+      MultiSPI::print_timing(&Ser);
+#endif
+
+    } else if (char_cmd == 'b') {
+      benchmark_noise(&Ser, perimeter_xy, FLC::GEOMETRY.perimeter());
+      benchmark_vm(&Ser, fx1, FLC::N);
+      benchmark_primitives(&Ser, fx1);
+      benchmark_layers(&Ser, layers_demo.data(), layers_demo.size());
+
+    } else if (char_cmd == 'k') {
+      benchmark_fastled(&Ser, fx1, FLC::N);
+
+    } else if (char_cmd == 'e') {
+      fx_mgr.print_render_stats(&Ser);
+
+    } else if (char_cmd == 'u') {
+      vm_upload.start();
+
+    } else if (char_cmd == 'm') {
+      power_limiter.print_info(&Ser, bright_lut[bright_idx]);
+
     } else if (char_cmd == 'r') {
       NVIC_SystemReset();
 
@@ -500,10 +735,27 @@ void loop() {
       Ser.println("w  : Override FX: Toggle all leds white ON/OFF");
       Ser.println("i  : Override FX: Toggle IR distance test ON/OFF");
       Ser.println("z  : Override FX: Toggle test pattern ON/OFF");
+      Ser.println("y  : Override FX: Toggle playback of recording ON/OFF");
+      Ser.println("a  : Start/stop recording the output into QSPI flash");
+      Ser.println("d  : Upload a recording rendered on a host PC, .fxan");
+      Ser.println("x  : Enter binary frame streaming from a host PC");
+      Ser.println("c  : Start/stop binary frame capture to a host PC");
+      Ser.println("g  : Toggle binary log for the host log viewer ON/OFF");
       Ser.println("r  : Reset hardware\n");
 
       Ser.println("q  : Toggle auto-next FX ON/OFF");
+      Ser.println("n  : Toggle night playlist ON/OFF");
       Ser.println("f  : Toggle FPS counter ON/OFF");
+      Ser.println("l  : Print & reset max loop latency");
+      Ser.println("h  : Print & reset IR sample-to-frame latency");
+      Ser.println("j  : Toggle IR filter average/alpha-beta");
+      Ser.println("s  : Print standby info");
+      Ser.println("t  : Print output channel timing");
+      Ser.println("m  : Print power estimate & brightness cap");
+      Ser.println("b  : Benchmark batched noise, VM & primitives");
+      Ser.println("k  : Benchmark FastLED functions, CSV");
+      Ser.println("e  : Print render cost & quality of the current FX");
+      Ser.println("u  : Upload VM program, 'u<slot><hex>\\n'");
       Ser.println("-  : Decrease brightness");
       Ser.println("+  : Increase brightness\n");
 
@@ -519,8 +771,25 @@ void loop() {
   // CRITICAL: Run the main Finite State Machine
   fsm_main.update();
 
-  // Periodically read out the IR distance sensor
-  EVERY_N_MILLISECONDS(25) {
+  // Periodically read out the IR distance sensor, at a reduced rate in standby
+  static uint32_t tick_IR = 0;
+  uint32_t now = millis();
+  if (now - tick_IR >=
+      (fx_mgr.in_standby() ? FLC::STANDBY_IR_PERIOD : FLC::IR_PERIOD)) {
+    tick_IR = now;
     update_IR_dist();
+    if (fx_mgr.in_standby() & (IR_dist_cm < FLC::AUDIENCE_DISTANCE)) {
+      // Resume at full rate right away
+      exit_standby();
+    }
+  }
+
+  // Send out queued capture packets and buffered log records in the remaining
+  // time. Log text waits until no capture packet is left half sent.
+  if (frame_capture.drain(&Ser)) {
+    Log::drain(&Ser);
   }
+
+  // In standby: Halt the core until the next timer tick
+  Standby::idle();
 }
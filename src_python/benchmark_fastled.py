@@ -0,0 +1,136 @@
+"""benchmark_fastled.py
+
+Runs the FastLED micro-benchmarks on the infinity mirror, serial command 'k',
+and stores the results as CSV. See `src_mcu/src/DvG_FastLED_Benchmark.h`.
+Keep a CSV per commit to spot regressions, e.g. after a FastLED update or a
+change of compiler flags.
+
+Usage:
+  python benchmark_fastled.py COM3 new.csv                  Run and store
+  python benchmark_fastled.py COM3 new.csv --compare old.csv
+  python benchmark_fastled.py host new.csv                  Run on the host PC
+  python benchmark_fastled.py new.csv --compare old.csv     Only compare
+
+Source `host` runs the benchmarks natively on the host PC instead, timed by
+`std::chrono`, built by `pio run -e bench_fastled` from `src_mcu`. Compare
+host results only against host results.
+
+The comparison lists the cycles per call of both files and flags the cases
+that changed by more than `--threshold` percent.
+
+Requires: pyserial, only when running on the mirror
+
+Dennis van Gils
+18-10-2026
+"""
+
+import argparse
+import csv
+import os
+import sys
+import time
+
+FIELDS = ["name", "calls", "cycles_per_call", "ns_per_call"]
+
+HOST_BENCH = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)),
+    "..", "src_mcu", ".pio", "build", "bench_fastled", "program",
+)
+
+
+def run_on_device(port, timeout=10):
+    """Return the CSV lines printed by the mirror in response to 'k'"""
+    import serial
+
+    lines = []
+    with serial.Serial(port, 115200, timeout=0.5) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"k")
+        t_end = time.time() + timeout
+        inside = False
+        while time.time() < t_end:
+            line = ser.readline().decode(errors="replace").strip()
+            if line == "# begin":
+                inside = True
+            elif line == "# end":
+                return lines
+            elif inside and line:
+                lines.append(line)
+    sys.exit("No complete benchmark received from %s" % port)
+
+
+def run_on_host(program=HOST_BENCH):
+    """Return the CSV lines printed by the native host build"""
+    import subprocess
+
+    if not os.path.isfile(program) and os.path.isfile(program + ".exe"):
+        program += ".exe"
+    if not os.path.isfile(program):
+        sys.exit("Benchmark not found, build it from `src_mcu` first with:\n"
+                 "  pio run -e bench_fastled")
+    proc = subprocess.run([program], stdout=subprocess.PIPE, text=True)
+    lines = [line.strip() for line in proc.stdout.splitlines()]
+    if proc.returncode or "# end" not in lines:
+        sys.exit("The host benchmark failed")
+    return lines[lines.index("# begin") + 1:lines.index("# end")]
+
+
+def read_csv(filename):
+    with open(filename, newline="", encoding="utf-8") as f:
+        return {row["name"]: row for row in csv.DictReader(f)}
+
+
+def compare(new, old, threshold):
+    """Print both results side by side. Returns the number of flagged cases."""
+    n_flagged = 0
+    print("%-18s %10s %10s %8s" % ("name", "old", "new", "change"))
+    for name, row in new.items():
+        c_new = float(row["cycles_per_call"])
+        if name not in old:
+            print("%-18s %10s %10.1f %8s" % (name, "-", c_new, "new"))
+            continue
+        c_old = float(old[name]["cycles_per_call"])
+        if c_old:
+            change = (c_new - c_old) / c_old * 100
+        else:
+            change = 0 if c_new == c_old else float("inf")
+        flag = abs(change) > threshold
+        n_flagged += flag
+        print(
+            "%-18s %10.1f %10.1f %+7.1f%%%s"
+            % (name, c_old, c_new, change, "  <--" if flag else "")
+        )
+    return n_flagged
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("source", help="serial port, or a CSV file")
+    parser.add_argument("out", nargs="?", help="CSV file to store to")
+    parser.add_argument("--compare", help="earlier CSV file")
+    parser.add_argument("--threshold", type=float, default=5, help="[%%]")
+    args = parser.parse_args()
+
+    if os.path.isfile(args.source):
+        new = read_csv(args.source)
+    else:
+        if not args.out:
+            sys.exit("Specify the CSV file to store to")
+        if args.source == "host":
+            lines = run_on_host()
+        else:
+            lines = run_on_device(args.source)
+        with open(args.out, "w", newline="", encoding="utf-8") as f:
+            f.write("\n".join(lines) + "\n")
+        print("Stored %d cases to %s" % (len(lines) - 1, args.out))
+        new = read_csv(args.out)
+
+    if args.compare:
+        n_flagged = compare(new, read_csv(args.compare), args.threshold)
+        sys.exit(1 if n_flagged else 0)
+    for row in new.values():
+        print(",".join(row[k] for k in FIELDS))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,187 @@
+"""capture_frames.py
+
+Captures the LED frames shown by the infinity mirror over USB serial and
+decodes them into a replayable capture file. See
+`src_mcu/src/DvG_FastLED_Capture.h` for the packet format and
+`src_mcu/src/DvG_FastLED_Animation.h` for the frame codec.
+
+Usage:
+  python capture_frames.py COM3 out.fxcap      Capture until Ctrl+C
+  python capture_frames.py raw.bin out.fxcap   Decode a raw serial dump
+  python stream_frames.py COM3 --replay out.fxcap
+
+Capture file
+------------
+  "FXCP", uint16 number of LEDs, then per frame:
+  uint32 [ms] timestamp, uint8 effect, uint8 style, 3 bytes RGB per LED
+
+Text printed by the mirror in between the packets gets echoed to the console.
+
+Requires: pyserial, only when capturing from the mirror
+
+Dennis van Gils
+18-10-2026
+"""
+
+import os
+import struct
+import sys
+import time
+
+from stream_frames import N_LEDS, SYNC, crc16_ccitt
+
+TYPE_KEYFRAME = 0x11
+TYPE_DELTA = 0x12
+HEADER_SIZE = 12
+
+OP_SKIP = 0x00
+OP_LITERAL = 0x40
+OP_REPEAT = 0x80
+
+
+def decode_frame(payload, frame):
+    """Decode `payload` on top of `frame`, a bytearray of 3 bytes per LED.
+    Returns False when corrupt."""
+    idx = 0
+    pos = 0
+    while pos < len(payload):
+        op = payload[pos] & 0xC0
+        run = (payload[pos] & 0x3F) + 1
+        pos += 1
+        if idx + run > N_LEDS:
+            return False
+        if op == OP_LITERAL:
+            frame[3 * idx : 3 * (idx + run)] = payload[pos : pos + 3 * run]
+            pos += 3 * run
+        elif op == OP_REPEAT:
+            frame[3 * idx : 3 * (idx + run)] = payload[pos : pos + 3] * run
+            pos += 3
+        elif op != OP_SKIP:
+            return False
+        idx += run
+    return (idx == N_LEDS) and (pos == len(payload))
+
+
+class Decoder:
+    def __init__(self, fout):
+        self.buf = bytearray()
+        self.fout = fout
+        self.frame = bytearray(3 * N_LEDS)
+        self.synced = False  # Waiting for a keyframe after an error?
+        self.seq = None
+        self.n_frames = 0
+        self.n_errors = 0
+        self.stats = {}  # effect -> [frames, bytes]
+        fout.write(b"FXCP" + struct.pack("<H", N_LEDS))
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                self.echo(self.buf[:-1])
+                del self.buf[:-1]
+                return
+            self.echo(self.buf[:start])
+            del self.buf[:start]
+            if len(self.buf) < HEADER_SIZE:
+                return
+            pkt_type, seq, t_ms, fx, style, n = struct.unpack_from(
+                "<BBIBBH", self.buf, 2
+            )
+            if pkt_type not in (TYPE_KEYFRAME, TYPE_DELTA):
+                # Not a capture packet, skip the sync word
+                del self.buf[:2]
+                continue
+            size = HEADER_SIZE + n + 2
+            if len(self.buf) < size:
+                return
+            body = bytes(self.buf[2 : size - 2])
+            (crc,) = struct.unpack_from("<H", self.buf, size - 2)
+            if crc != crc16_ccitt(body):
+                self.n_errors += 1
+                self.synced = False
+                del self.buf[:2]
+                continue
+            del self.buf[:size]
+            self.packet(pkt_type, seq, t_ms, fx, style, body[10:])
+
+    def packet(self, pkt_type, seq, t_ms, fx, style, payload):
+        if (self.seq is not None) and (seq != (self.seq + 1) & 0xFF):
+            self.synced = False  # Lost a packet, the delta chain broke
+        self.seq = seq
+        if pkt_type == TYPE_KEYFRAME:
+            self.frame = bytearray(3 * N_LEDS)
+            self.synced = True
+        if not self.synced or not decode_frame(payload, self.frame):
+            self.synced = False
+            return
+
+        self.fout.write(struct.pack("<IBB", t_ms, fx, style) + self.frame)
+        self.n_frames += 1
+        stat = self.stats.setdefault(fx, [0, 0])
+        stat[0] += 1
+        stat[1] += HEADER_SIZE + len(payload) + 2
+
+    def echo(self, text):
+        if text:
+            sys.stdout.write(bytes(text).decode(errors="replace"))
+
+    def print_stats(self):
+        print("\nDecoded frames: %u, errors: %u" % (self.n_frames, self.n_errors))
+        print("Bandwidth [bytes/frame] per effect, raw: %u"
+              % (HEADER_SIZE + 3 * N_LEDS + 2))
+        for fx in sorted(self.stats):
+            n_frames, n_bytes = self.stats[fx]
+            name = ("*%u" % (fx & 0x7F)) if (fx & 0x80) else ("%u" % fx)
+            print("  %3s: %6.1f over %u frames"
+                  % (name, n_bytes / n_frames, n_frames))
+
+
+def read_capture(filename):
+    """Yield (t_ms, fx, style, rgb) per frame of a capture file"""
+    with open(filename, "rb") as f:
+        magic, n_leds = struct.unpack("<4sH", f.read(6))
+        if magic != b"FXCP":
+            raise ValueError("Not a capture file")
+        size = 6 + 3 * n_leds
+        while True:
+            record = f.read(size)
+            if len(record) < size:
+                return
+            t_ms, fx, style = struct.unpack_from("<IBB", record)
+            yield t_ms, fx, style, record[6:]
+
+
+def capture(port, fout):
+    import serial
+
+    ser = serial.Serial(port, 115200, timeout=0.1)
+    decoder = Decoder(fout)
+    ser.write(b"c")
+    print("Capturing, press Ctrl+C to stop")
+    try:
+        while True:
+            decoder.feed(ser.read(max(1, ser.in_waiting)))
+    except KeyboardInterrupt:
+        pass
+    ser.write(b"c")
+    time.sleep(0.2)
+    decoder.feed(ser.read(ser.in_waiting))
+    ser.close()
+    decoder.print_stats()
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[2], "wb") as fout:
+        if os.path.isfile(sys.argv[1]):
+            decoder = Decoder(fout)
+            with open(sys.argv[1], "rb") as fin:
+                decoder.feed(fin.read())
+            decoder.print_stats()
+        else:
+            capture(sys.argv[1], fout)
@@ -0,0 +1,237 @@
+"""footprint.py
+
+Reports the RAM and flash footprint of the firmware, attributed to the LED
+buffers, the other subsystems and to each `fx__*` effect, and checks it
+against a budget. The symbols are read from the linked ELF with `nm`, the
+section totals with `size`.
+
+Usage:
+  python footprint.py firmware.elf [options]
+  pio run -t footprint               From `src_mcu`, see `footprint_target.py`
+
+Options:
+  --scale ELF        The same firmware linked for another number of LEDs. The
+                     difference yields the marginal RAM cost per LED and the
+                     largest mirror that fits the RAM budget.
+  --ram-budget B     [bytes] Fail when the RAM usage exceeds this
+  --flash-budget B   [bytes] Fail when the flash usage exceeds this
+  --nm PATH          `nm` of the toolchain, default: arm-none-eabi-nm. `size`
+                     is looked up next to it.
+  --top K            Also list the K largest unattributed symbols
+
+The number of LEDs gets derived from the size of `leds`, 3 bytes per LED.
+Effects are attributed by name: the State object `fx__X`, the functions
+`entr__X`, `upd__X` and `exit__X`, and their static locals. The name strings
+of the effects are string literals in `.rodata`, which do not have symbols.
+
+Exits with code 1 when a budget is exceeded.
+
+Dennis van Gils
+18-10-2026
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+RAM_SECTIONS = (".data", ".bss", ".ramfunc")
+FLASH_SECTIONS = (".text", ".rodata", ".ARM.exidx", ".data", ".ramfunc")
+
+# Subsystems: name and regex on the demangled symbol, first match wins
+# fmt: off
+GROUPS = [
+    ("leds",            r"^leds$"),
+    ("leds_snapshot",   r"^leds_snapshot$"),
+    ("chsv_snapshot",   r"^chsv_snapshot$"),
+    ("fx1 .. fx4",      r"^fx[1-4]$"),
+    ("fx1/fx2_strip",   r"^(fx1_strip|fx2_strip)$"),
+    ("ECG::wave",       r"^ECG::|ECG_|_ECG|^p2$"),
+    ("effect manager",  r"^fx_mgr$|FastLED_EffectManager"),
+    ("segmenters",      r"^segmntr|FastLED_StripSegmenter"),
+    ("geometry",        r"^perimeter|Geometry|^XY$|leds_phys"),
+    ("FastLED",         r"FastLED|CLEDController|APA102|SPIOutput|"
+                        r"PixelController|^(hsv2rgb|rgb2hsv|fill_|fadeTo|"
+                        r"nscale|nblend|blend|blur|inoise|snoise|"
+                        r"ColorFromPalette|random16|sin16|cos16|beat)"),
+    ("palettes",        r"_p$|palette|Palette"),
+    ("noise",           r"[Nn]oise|XY16"),
+    ("animation, flash", r"Anim|QSPI|anim"),
+    ("capture, stream", r"Capture|Stream|capture|stream"),
+    ("logger",          r"^Log::|log_formats"),
+    ("power",           r"PowerLimiter|power_limiter"),
+    ("VM",              r"FastLED_VM|VM_|(^|_)vm(_|$)"),
+    ("layers",          r"^layers?_|_layers$|FX_layer|blend_mapped"),
+]
+# fmt: on
+RE_EFFECT = re.compile(r"(?:^|\s)(?:fx|entr|upd|exit)__([A-Za-z0-9_]+)")
+
+
+def read_symbols(nm, elf):
+    """Return a list of (name, type, size) of the sized, defined symbols"""
+    out = subprocess.run(
+        [nm, "-S", "-C", "--defined-only", "-t", "d", elf],
+        check=True, capture_output=True, text=True,
+    ).stdout
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4:
+            symbols.append((parts[3], parts[2], int(parts[1])))
+    return symbols
+
+
+def read_sections(size, elf):
+    """Return a dict of section name: size"""
+    out = subprocess.run(
+        [size, "-A", "-d", elf], check=True, capture_output=True, text=True
+    ).stdout
+    sections = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[0].startswith("."):
+            sections[parts[0]] = int(parts[1])
+    return sections
+
+
+def kind(sym_type):
+    """Memory kind of an `nm` symbol type"""
+    t = sym_type.lower()
+    if t == "b":
+        return "bss"
+    if t == "d":
+        return "data"
+    if t in "tw":
+        return "text"
+    if t == "r":
+        return "rodata"
+    return None
+
+
+def attribute(symbols):
+    """Return {group: {kind: bytes}} and the unattributed symbols"""
+    groups = {}
+    rest = []
+    for name, sym_type, size in symbols:
+        k = kind(sym_type)
+        if k is None:
+            continue
+        base = name.split("(")[0]
+        m = RE_EFFECT.search(base)
+        if m:
+            group = "fx__" + m.group(1)
+        else:
+            group = next(
+                (g for g, regex in GROUPS if re.search(regex, base)), None
+            )
+        if group is None:
+            group = "other"
+            rest.append((name, k, size))
+        groups.setdefault(group, {}).setdefault(k, 0)
+        groups[group][k] += size
+    return groups, rest
+
+
+class Footprint:
+    def __init__(self, elf, nm, size):
+        self.symbols = read_symbols(nm, elf)
+        self.sections = read_sections(size, elf)
+        self.groups, self.rest = attribute(self.symbols)
+        self.ram = sum(self.sections.get(s, 0) for s in RAM_SECTIONS)
+        self.flash = sum(self.sections.get(s, 0) for s in FLASH_SECTIONS)
+        leds = [s for n, _, s in self.symbols if n == "leds"]
+        self.n_leds = leds[0] // 3 if leds else 0
+
+    def group_ram(self, group):
+        g = self.groups.get(group, {})
+        return g.get("bss", 0) + g.get("data", 0)
+
+    def group_flash(self, group):
+        g = self.groups.get(group, {})
+        return g.get("text", 0) + g.get("rodata", 0) + g.get("data", 0)
+
+
+def print_table(fp, scaled=None):
+    dn = (scaled.n_leds - fp.n_leds) if scaled else 0
+    print("%-24s %8s %8s %8s %8s" % ("", "bss", "data", "flash", "RAM/LED"))
+
+    def row(group):
+        g = fp.groups.get(group, {})
+        per_led = ""
+        if dn:
+            per_led = "%.2f" % (
+                (scaled.group_ram(group) - fp.group_ram(group)) / dn
+            )
+        print(
+            "%-24s %8d %8d %8d %8s"
+            % (group[:24], g.get("bss", 0), g.get("data", 0),
+               fp.group_flash(group), per_led)
+        )
+
+    for group, _ in GROUPS:
+        if group in fp.groups:
+            row(group)
+    effects = sorted(g for g in fp.groups if g.startswith("fx__"))
+    if effects:
+        print("Effects")
+        for group in effects:
+            row(group)
+    if "other" in fp.groups:
+        row("other")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("--scale")
+    parser.add_argument("--ram-budget", type=int)
+    parser.add_argument("--flash-budget", type=int)
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--top", type=int, default=0)
+    args = parser.parse_args()
+
+    size = os.path.join(
+        os.path.dirname(args.nm), os.path.basename(args.nm)[:-2] + "size"
+    )
+    fp = Footprint(args.elf, args.nm, size)
+    scaled = Footprint(args.scale, args.nm, size) if args.scale else None
+    if scaled and (scaled.n_leds == fp.n_leds):
+        sys.exit("--scale: both ELFs have %d LEDs" % fp.n_leds)
+
+    print("Footprint of %s, %d LEDs\n" % (args.elf, fp.n_leds))
+    print_table(fp, scaled)
+
+    if args.top:
+        print("\nLargest unattributed symbols")
+        for name, k, size_ in sorted(fp.rest, key=lambda r: -r[2])[:args.top]:
+            print("  %8d %-6s %s" % (size_, k, name))
+
+    print("\nRAM  : %d bytes" % fp.ram, end="")
+    print(" of %d" % args.ram_budget if args.ram_budget else "")
+    print("Flash: %d bytes" % fp.flash, end="")
+    print(" of %d" % args.flash_budget if args.flash_budget else "")
+
+    if scaled:
+        per_led = (scaled.ram - fp.ram) / (scaled.n_leds - fp.n_leds)
+        print("RAM per LED: %.1f bytes" % per_led, end="")
+        if args.ram_budget and per_led > 0:
+            n_max = fp.n_leds + int((args.ram_budget - fp.ram) / per_led)
+            print(", at most %d LEDs within the RAM budget" % n_max, end="")
+        print()
+
+    failed = False
+    if args.ram_budget and fp.ram > args.ram_budget:
+        print("RAM budget exceeded by %d bytes" % (fp.ram - args.ram_budget))
+        failed = True
+    if args.flash_budget and fp.flash > args.flash_budget:
+        print(
+            "Flash budget exceeded by %d bytes"
+            % (fp.flash - args.flash_budget)
+        )
+        failed = True
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,134 @@
+"""ir_trace.py
+
+Records traces of the IR distance sensor of the infinity mirror, or
+synthesizes them, to be replayed through the firmware filters on the host PC
+by `src_mcu/host/ir_replay.cpp`. See `src_mcu/src/DvG_IR_Distance.h`.
+
+Usage:
+  python ir_trace.py record COM3 walk.txt --seconds 60
+  python ir_trace.py synth synth.txt --seed 1
+  ir_replay walk.txt synth.txt
+
+The filters got tuned on the traces of seeds 1 to 3, committed as
+`src_mcu/host/traces/ir_synth_*.txt`, which `ir_replay` replays by default.
+
+`record` switches on the IR distance test of the mirror, serial command 'i',
+which logs every sample, and switches it off again afterwards. Walk up to the
+mirror, stand still, sway and walk away again while recording.
+
+`synth` models a visitor walking up to the mirror, standing still, swaying,
+stepping back and leaving, sampled at the jittery rate of the main
+loop. The readings get the noise and the occasional spikes of the Sharp
+sensor. Such a trace holds the true distance as well.
+
+Trace file: One sample per line, `micros()` / 1000 at the moment of sampling,
+the 10-bit reading and, for synthesized traces, the true distance [cm].
+
+Requires: pyserial, only when recording from the mirror
+
+Dennis van Gils
+18-10-2026
+"""
+
+import argparse
+import math
+import random
+import sys
+import time
+
+# Must match `DvG_IR_Distance.h`
+IR_DIST_MIN = 16  # [cm]
+IR_DIST_MAX = 150  # [cm]
+IR_CALIB_A = 1512.89
+IR_CALIB_B = 74
+IR_CALIB_C = 0.424
+IR_PERIOD = 25  # [ms] Must match `FLC::IR_PERIOD`
+
+# Synthesized sensor imperfections
+NOISE_LSB = 3  # Gaussian noise on the reading, standard deviation
+SPIKE_PROB = 0.01  # Probability of a spike per sample
+SPIKE_LSB = (30, 80)  # Range of the spike amplitude
+LOOP_JITTER = 10  # [ms] The main loop samples up to this much late
+
+
+def record(port, filename, seconds):
+    import serial
+
+    n = 0
+    with serial.Serial(port, 115200, timeout=0.1) as ser, open(
+        filename, "w"
+    ) as f:
+        ser.reset_input_buffer()
+        ser.write(b"i")
+        f.write("# t_ms\tbitval, recorded from %s\n" % port)
+        t_end = time.time() + seconds
+        while time.time() < t_end:
+            # LOG_IR_DIST: t_ms, bitval, instant_cm, IR_dist_cm
+            cols = ser.readline().decode(errors="replace").strip().split("\t")
+            if len(cols) == 4 and cols[0].isdigit() and cols[1].isdigit():
+                f.write("%s\t%s\n" % (cols[0], cols[1]))
+                n += 1
+        ser.write(b"i")
+    print("Recorded %d samples into %s" % (n, filename))
+
+
+def to_bitval(cm):
+    """Inverse of the calibration fit"""
+    return (IR_CALIB_A / (cm + IR_CALIB_B)) ** (1 / IR_CALIB_C)
+
+
+def visitor(t):
+    """True distance [cm] at time `t` [s]"""
+    # (start [s], distance [cm]) keyframes, eased in between
+    keys = [(0, 150), (3, 150), (5.5, 50), (13, 50), (13.8, 100), (18, 100),
+            (18.3, 150), (21, 150)]
+    for (t0, d0), (t1, d1) in zip(keys, keys[1:]):
+        if t < t1:
+            w = (1 - math.cos(math.pi * (t - t0) / (t1 - t0))) / 2
+            d = d0 + w * (d1 - d0)
+            break
+    else:
+        d = keys[-1][1]
+    if 9 <= t < 13:
+        d += 3 * math.sin(2 * math.pi * 0.5 * (t - 9))  # Swaying
+    return min(d, IR_DIST_MAX)
+
+
+def synth(filename, seed):
+    rng = random.Random(seed)
+    t_ms = 0
+    n = 0
+    with open(filename, "w") as f:
+        f.write("# t_ms\tbitval\ttruth_cm, synthesized, seed %d\n" % seed)
+        while t_ms < 21000:
+            truth = visitor(t_ms / 1000)
+            bitval = to_bitval(truth) + rng.gauss(0, NOISE_LSB)
+            if rng.random() < SPIKE_PROB:
+                bitval += rng.choice((-1, 1)) * rng.uniform(*SPIKE_LSB)
+            bitval = min(max(round(bitval), 0), 1023)
+            f.write("%d\t%d\t%.2f\n" % (t_ms, bitval, truth))
+            n += 1
+            t_ms += IR_PERIOD + rng.randint(0, LOOP_JITTER)
+    print("Synthesized %d samples into %s" % (n, filename))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("record")
+    p.add_argument("port")
+    p.add_argument("trace")
+    p.add_argument("--seconds", type=float, default=60)
+    p = sub.add_parser("synth")
+    p.add_argument("trace")
+    p.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if args.cmd == "record":
+        record(args.port, args.trace, args.seconds)
+    else:
+        synth(args.trace, args.seed)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
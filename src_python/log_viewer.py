@@ -0,0 +1,176 @@
+"""log_viewer.py
+
+Renders the binary log records of the infinity mirror as coloured text. See
+`src_mcu/src/DvG_Logger.h` for the packet format. The format strings and
+colours are read straight from `log_formats` inside that file, so they never
+get out of sync with the firmware.
+
+Usage:
+  python log_viewer.py COM3        Switch the mirror to binary logging and view
+  python log_viewer.py dump.bin    Render a raw serial dump
+
+Plain text in between the packets, like replies to serial commands, gets
+passed through unaltered.
+
+Requires: pyserial, only when viewing the mirror live
+
+Dennis van Gils
+18-10-2026
+"""
+
+import os
+import re
+import struct
+import sys
+
+from stream_frames import SYNC, crc16_ccitt
+
+LOGGER_H = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), "..", "src_mcu", "src",
+    "DvG_Logger.h"
+)
+LOG_TYPE = 0x20
+LOG_NO_COLOR = 0xFF
+ANSI_COLORS = {
+    "black": 0, "red": 1, "green": 2, "yellow": 3, "blue": 4, "magenta": 5,
+    "cyan": 6, "white": 7, "bright": 8,
+}
+
+
+def read_formats(filename=LOGGER_H):
+    """Parse the `log_formats` table into a list of (colour, format)"""
+    formats = []
+    with open(filename, encoding="utf-8") as f:
+        for line in f:
+            m = re.match(r'\s*/\*\s*(LOG_\w+)\s*\*/\s*\{(.*?),\s*"(.*)"\},', line)
+            if not m:
+                continue
+            color = LOG_NO_COLOR
+            if "LOG_NO_COLOR" not in m.group(2):
+                color = sum(
+                    ANSI_COLORS[name]
+                    for name in re.findall(r"ANSI::(\w+)", m.group(2))
+                )
+            fmt = m.group(3).encode().decode("unicode_escape")
+            formats.append((color, fmt))
+    return formats
+
+
+def render(fmt, args):
+    """Apply the firmware's format specifiers: %d, %u, %f and %s"""
+    out = []
+    args = iter(args)
+    i = 0
+    while i < len(fmt):
+        if fmt[i] == "%" and i + 1 < len(fmt):
+            spec = fmt[i + 1]
+            if spec in "dus":
+                out.append(str(next(args)))
+            elif spec == "f":
+                out.append("%.2f" % next(args))
+            else:
+                out.append(spec)
+            i += 2
+        else:
+            out.append(fmt[i])
+            i += 1
+    return "".join(out)
+
+
+def color_code(color):
+    if color == LOG_NO_COLOR:
+        return ""
+    if color & 8:
+        return "\033[9%um" % (color & 7)
+    return "\033[3%um" % color
+
+
+class LogDecoder:
+    def __init__(self, formats, out=sys.stdout):
+        self.formats = formats
+        self.out = out
+        self.buf = bytearray()
+        self.n_errors = 0
+
+    def parse_args(self, fmt, argc, pos):
+        """Return the arguments and the position past them, or None when the
+        buffer does not hold all of them yet"""
+        specs = re.findall(r"%([dufs])", fmt)
+        args = []
+        for i_arg in range(argc):
+            spec = specs[i_arg] if i_arg < len(specs) else "u"
+            if spec == "s":
+                end = self.buf.find(b"\0", pos)
+                if end < 0:
+                    return None
+                args.append(self.buf[pos:end].decode(errors="replace"))
+                pos = end + 1
+            else:
+                if len(self.buf) < pos + 4:
+                    return None
+                code = {"d": "<i", "u": "<I", "f": "<f"}[spec]
+                args.append(struct.unpack_from(code, self.buf, pos)[0])
+                pos += 4
+        return args, pos
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            start = self.buf.find(SYNC)
+            if start < 0:
+                self.echo(self.buf[:-1])
+                del self.buf[:-1]
+                return
+            self.echo(self.buf[:start])
+            del self.buf[:start]
+            if len(self.buf) < 5:
+                return
+            pkt_type, fmt_id, argc = self.buf[2], self.buf[3], self.buf[4]
+            if (pkt_type != LOG_TYPE) or (fmt_id >= len(self.formats)):
+                del self.buf[:2]
+                continue
+            color, fmt = self.formats[fmt_id]
+            parsed = self.parse_args(fmt, argc, 5)
+            if parsed is None:
+                return
+            args, pos = parsed
+            if len(self.buf) < pos + 2:
+                return
+            (crc,) = struct.unpack_from("<H", self.buf, pos)
+            if crc != crc16_ccitt(self.buf[2:pos]):
+                self.n_errors += 1
+                del self.buf[:2]
+                continue
+            del self.buf[: pos + 2]
+            text = render(fmt, args)
+            if color != LOG_NO_COLOR:
+                text = color_code(color) + text + "\033[0m"
+            self.out.write(text + "\n")
+
+    def echo(self, text):
+        if text:
+            self.out.write(bytes(text).decode(errors="replace"))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print(__doc__)
+        sys.exit(1)
+
+    decoder = LogDecoder(read_formats())
+    if os.path.isfile(sys.argv[1]):
+        with open(sys.argv[1], "rb") as f:
+            decoder.feed(f.read())
+    else:
+        import serial
+
+        ser = serial.Serial(sys.argv[1], 115200, timeout=0.1)
+        ser.write(b"g")  # Toggle binary logging, the mirror replies in text
+        try:
+            while True:
+                decoder.feed(ser.read(max(1, ser.in_waiting)))
+                sys.stdout.flush()
+        except KeyboardInterrupt:
+            pass
+        ser.write(b"g")
+        ser.close()
@@ -0,0 +1,156 @@
+"""render_offline.py
+
+Renders the FastLED effects of the infinity mirror on the host PC, without
+flashing the board, into capture files and images of the mirror perimeter.
+Every preset of a playlist, or every effect in every strip segmentation style,
+is a separate job. The jobs get rendered in parallel on all cores by the
+offline renderer `src_mcu/host/render.cpp`, in virtual time.
+
+Usage:
+  python render_offline.py day                 Every preset of the day list
+  python render_offline.py night --out night
+  python render_offline.py matrix --max 8000   Every effect x style
+
+Options:
+  --out DIR      Output folder, default: render_LIST
+  --fps F        Frame rate of the virtual time [Hz], default: 100
+  --max MS       Longest time to render of a job [ms], default: 20000
+  --warmup MS    Time the previous preset of a playlist runs for first [ms],
+                 default: 2000
+  --workers N    Number of jobs rendered at the same time, default: all cores
+  --render PATH  Renderer, default: the build of `pio run -e render`
+
+Per job, `IDX_effect_style.fxcap` gets written, which replays on the mirror
+with `python stream_frames.py COM3 --replay FILE`, and
+`IDX_effect_style.png`: An image strip with one column per LED along the
+perimeter, starting at the bottom-left corner and running counter-clockwise,
+and one row per frame, time running downwards. `overview.png` shows all jobs
+side by side, each downsampled in time to `OVERVIEW_ROWS` rows.
+
+Dennis van Gils
+18-10-2026
+"""
+
+import argparse
+import os
+import re
+import struct
+import subprocess
+import sys
+import time
+import zlib
+from concurrent.futures import ThreadPoolExecutor
+
+from capture_frames import read_capture
+
+RENDER = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)),
+    "..", "src_mcu", ".pio", "build", "render", "program",
+)
+OVERVIEW_ROWS = 500
+OVERVIEW_GAP = 2  # [px] Black columns in between jobs
+
+
+def write_png(filename, width, rows):
+    """Write 8-bit RGB `rows`, each a bytes-like of 3 * `width` bytes"""
+
+    def chunk(tag, data):
+        return (
+            struct.pack(">I", len(data)) + tag + data
+            + struct.pack(">I", zlib.crc32(tag + data) & 0xFFFFFFFF)
+        )
+
+    raw = b"".join(b"\x00" + bytes(row) for row in rows)
+    with open(filename, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, len(rows),
+                                           8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(raw, 6)))
+        f.write(chunk(b"IEND", b""))
+
+
+def list_jobs(render, playlist):
+    """Return a list of (idx, effect name, style index, style name)"""
+    out = subprocess.run(
+        [render, "jobs", playlist], check=True, capture_output=True, text=True
+    ).stdout
+    jobs = []
+    for line in out.splitlines():
+        idx, fx, style, style_name = line.split("\t")
+        jobs.append((int(idx), fx, int(style), style_name))
+    return jobs
+
+
+def job_name(job):
+    idx, fx, _, style_name = job
+    style = re.sub(r"[^A-Za-z0-9]+", "_", style_name).strip("_")
+    return "%03d_%s_%s" % (idx, fx, style)
+
+
+def render_job(render, playlist, job, args):
+    """Render `job` to its capture file and image strip. Returns the frames."""
+    base = os.path.join(args.out, job_name(job))
+    subprocess.run(
+        [render, "job", playlist, str(job[0]), base + ".fxcap",
+         str(args.fps), str(args.max), str(args.warmup)],
+        check=True, capture_output=True,
+    )
+    frames = [rgb for _, _, _, rgb in read_capture(base + ".fxcap")]
+    write_png(base + ".png", len(frames[0]) // 3, frames)
+    return frames
+
+
+def write_overview(filename, all_frames):
+    n_leds = len(all_frames[0][0]) // 3
+    width = len(all_frames) * (n_leds + OVERVIEW_GAP) - OVERVIEW_GAP
+    gap = bytes(3 * OVERVIEW_GAP)
+    black = bytes(3 * n_leds)
+    rows = []
+    for row in range(OVERVIEW_ROWS):
+        parts = []
+        for frames in all_frames:
+            idx = row * len(frames) // OVERVIEW_ROWS
+            parts.append(frames[idx] if idx < len(frames) else black)
+        rows.append(gap.join(parts))
+    write_png(filename, width, rows)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("playlist", choices=["day", "night", "matrix"])
+    parser.add_argument("--out")
+    parser.add_argument("--fps", type=int, default=100)
+    parser.add_argument("--max", type=int, default=20000)
+    parser.add_argument("--warmup", type=int, default=2000)
+    parser.add_argument("--workers", type=int, default=os.cpu_count())
+    parser.add_argument("--render", default=RENDER)
+    args = parser.parse_args()
+
+    render = args.render
+    if not os.path.isfile(render) and os.path.isfile(render + ".exe"):
+        render += ".exe"
+    if not os.path.isfile(render):
+        sys.exit("Renderer not found, build it from `src_mcu` first with:\n"
+                 "  pio run -e render")
+    args.out = args.out or "render_" + args.playlist
+    os.makedirs(args.out, exist_ok=True)
+
+    tick = time.perf_counter()
+    jobs = list_jobs(render, args.playlist)
+    with ThreadPoolExecutor(max_workers=args.workers) as pool:
+        all_frames = list(
+            pool.map(lambda job: render_job(render, args.playlist, job, args),
+                     jobs)
+        )
+    write_overview(os.path.join(args.out, "overview.png"), all_frames)
+
+    n_frames = sum(len(frames) for frames in all_frames)
+    print(
+        "Rendered %d jobs, %d frames in %.2f s using %d workers into %s"
+        % (len(jobs), n_frames, time.perf_counter() - tick, args.workers,
+           args.out)
+    )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,224 @@
+"""stream_frames.py
+
+Streams LED frames from the PC to the infinity mirror over USB serial, using
+the binary packet format of `src_mcu/src/DvG_FastLED_Stream.h`.
+
+Usage:
+  python stream_frames.py COM3           Stream a moving rainbow to the mirror
+  python stream_frames.py --selftest     Measure throughput and latency over a
+                                         pseudo-terminal, no mirror needed,
+                                         `--check PROGRAM` to point at the
+                                         host build of the receiver
+  python stream_frames.py COM3 --replay capture.fxcap
+                                         Replay a capture file at its original
+                                         timing, resampled to the playout rate
+                                         of 50 Hz, see `capture_frames.py`
+
+The self-test sends packets into one end of a pseudo-terminal (Linux/macOS).
+At the other end, the firmware's own `FrameStream` receives them, built for
+the host PC by `pio run -e stream_check` from `src_mcu`. It reports the
+throughput, the send-to-commit latency and the counters of the receiver, and
+fails when any frame went missing.
+
+Requires: pyserial, only when streaming to the mirror
+
+Dennis van Gils
+18-10-2026
+"""
+
+import argparse
+import colorsys
+import os
+import struct
+import sys
+import threading
+import time
+
+N_LEDS = 52  # Must match `FLC::N`
+PERIOD = 0.020  # [s] Must match `FLC::STREAM_PERIOD`
+
+SYNC = b"\xA5\x5A"
+TYPE_FRAME = 0x01
+TYPE_PARTIAL = 0x02
+TYPE_END = 0x03
+
+CHECK = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)),
+    "..", "src_mcu", ".pio", "build", "stream_check", "program",
+)
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    # CRC-16/CCITT-FALSE
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def make_packet(pkt_type, seq, rgb=b"", first=0):
+    """Build a packet. `rgb` holds 3 bytes per LED, starting at LED `first`."""
+    body = struct.pack("<BBHH", pkt_type, seq & 0xFF, first, len(rgb) // 3)
+    body += rgb
+    return SYNC + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def rainbow_frame(t):
+    rgb = bytearray()
+    for idx in range(N_LEDS):
+        r, g, b = colorsys.hsv_to_rgb((idx / N_LEDS + t / 5) % 1, 1, 1)
+        rgb += bytes((int(r * 255), int(g * 255), int(b * 255)))
+    return bytes(rgb)
+
+
+def stream(port, replay=None):
+    import serial
+
+    ser = serial.Serial(port, 115200, timeout=0.1)
+    ser.write(b"x")
+    time.sleep(0.1)
+    print(ser.read(ser.in_waiting).decode(errors="replace"), end="")
+
+    seq = 0
+    t0 = time.perf_counter()
+    try:
+        if replay:
+            from capture_frames import read_capture
+
+            # The mirror plays out one frame per `PERIOD`. Resample the
+            # capture onto that grid, sending the newest frame at each slot:
+            # a capture above 50 Hz skips frames instead of overflowing the
+            # jitter buffer, one below repeats them.
+            frames = read_capture(replay)
+            t_first, _, _, rgb = next(frames)
+            pending = next(frames, None)
+            n_skipped = 0
+            while True:
+                t_slot = t_first + seq * PERIOD * 1000  # [ms] Capture time
+                n_new = 0
+                while pending and pending[0] <= t_slot:
+                    rgb = pending[3]
+                    pending = next(frames, None)
+                    n_new += 1
+                n_skipped += max(0, n_new - 1)
+                time.sleep(max(0, t0 + seq * PERIOD - time.perf_counter()))
+                ser.write(make_packet(TYPE_FRAME, seq, rgb))
+                seq += 1
+                if pending is None:
+                    break
+            print("Replayed as %u frames at %.0f Hz, skipped %u"
+                  % (seq, 1 / PERIOD, n_skipped))
+        else:
+            while True:
+                t = time.perf_counter() - t0
+                ser.write(make_packet(TYPE_FRAME, seq, rainbow_frame(t)))
+                seq += 1
+                time.sleep(max(0, t0 + seq * PERIOD - time.perf_counter()))
+    except KeyboardInterrupt:
+        pass
+
+    ser.write(make_packet(TYPE_END, seq))
+    time.sleep(0.2)
+    print(ser.read(ser.in_waiting).decode(errors="replace"), end="")
+    ser.close()
+
+
+def selftest(check=CHECK, n_flood=2000, n_paced=200, pace=PERIOD / 4):
+    """Flood the pseudo-terminal to measure the throughput, then send packets
+    at a steady pace to measure the latency without queueing"""
+    import subprocess
+    import tty
+
+    if not os.path.isfile(check) and os.path.isfile(check + ".exe"):
+        check += ".exe"
+    if not os.path.isfile(check):
+        sys.exit("Receiver not found, build it from `src_mcu` first with:\n"
+                 "  pio run -e stream_check")
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    proc = subprocess.Popen([check, "--stdin"], stdin=slave,
+                            stdout=subprocess.PIPE, text=True)
+    os.close(slave)
+    n_frames = n_flood + n_paced
+    t_sent = {}
+    t_recv = {}
+    counters = []
+
+    def reader():
+        # Lines `R <time> <received>` per committed frame, `C ...` at the end.
+        # Sequence numbers wrap at 256, count the frames instead.
+        for line in proc.stdout:
+            fields = line.split()
+            if fields[0] == "R":
+                t_recv[int(fields[2]) - 1] = float(fields[1])
+            elif fields[0] == "C":
+                counters.extend(int(x) for x in fields[1:])
+
+    thread = threading.Thread(target=reader, daemon=True)
+    thread.start()
+    rgb = rainbow_frame(0)
+
+    def send(idx, pkt_type=TYPE_FRAME, data=rgb):
+        packet = make_packet(pkt_type, idx, data)
+        t_sent[idx] = time.monotonic()  # Same clock as the receiver's
+        os.write(master, packet)
+        return len(packet)
+
+    n_bytes = 0
+    t0 = time.monotonic()
+    for idx in range(n_flood):
+        n_bytes += send(idx)
+    while len(t_recv) < n_flood and proc.poll() is None:
+        time.sleep(0.001)
+    dt = time.monotonic() - t0
+
+    for idx in range(n_flood, n_frames):
+        send(idx)
+        time.sleep(pace)
+    send(n_frames, TYPE_END, b"")
+    proc.wait(timeout=5)
+    thread.join(timeout=5)
+    os.close(master)
+
+    latencies = sorted(
+        t_recv[idx] - t_sent[idx] for idx in range(n_flood, n_frames)
+        if idx in t_recv
+    )
+    n = len(latencies)
+    names = ("received", "crc", "lost", "dup", "overflow", "underrun")
+    print("Self-test of the firmware's `FrameStream` over a pseudo-terminal, "
+          "%u LEDs per frame" % N_LEDS)
+    print("  Frames received: %u / %u" % (len(t_recv), n_frames))
+    print("  Counters       : %s" % ", ".join(
+        "%s %u" % x for x in zip(names, counters)))
+    print("  Throughput     : %.0f frames/s, %.2f MB/s"
+          % (n_flood / dt, n_bytes / dt / 1e6))
+    if n:
+        print("  Latency [ms]   : median %.3f, 99%% %.3f, max %.3f"
+              % (latencies[n // 2] * 1e3, latencies[n * 99 // 100] * 1e3,
+                 latencies[-1] * 1e3))
+    print("  Required       : %.0f frames/s, %.3f MB/s"
+          % (1 / PERIOD, n_bytes / n_flood / PERIOD / 1e6))
+    ok = (len(t_recv) == n_frames) and (counters[1:4] == [0, 0, 0])
+    return ok
+
+
+if __name__ == "__main__":
+    ap = argparse.ArgumentParser()
+    ap.add_argument("port", nargs="?", help="Serial port of the mirror")
+    ap.add_argument("--selftest", action="store_true")
+    ap.add_argument("--replay", metavar="FILE", help="Capture file to replay")
+    ap.add_argument("--check", default=CHECK,
+                    help="Host build of the receiver, for --selftest")
+    args = ap.parse_args()
+
+    if args.selftest:
+        sys.exit(0 if selftest(args.check) else 1)
+    elif args.port:
+        stream(args.port, args.replay)
+    else:
+        ap.print_help()
+        sys.exit(1)
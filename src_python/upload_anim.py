@@ -0,0 +1,66 @@
+"""upload_anim.py
+
+Uploads an animation recording into the QSPI flash of the infinity mirror over
+USB serial, see `src_mcu/src/DvG_FastLED_Animation.h`. The recording gets
+rendered on the host PC by the offline renderer, in virtual time, for effects
+too expensive to record on the mirror in real time:
+
+  src_mcu/.pio/build/render/program anim day 4 heartbeat.fxan
+
+Usage:
+  python upload_anim.py COM3 heartbeat.fxan
+
+Serial command 'y' plays it back on the mirror.
+
+Requires: pyserial
+
+Dennis van Gils
+18-10-2026
+"""
+
+import struct
+import sys
+import time
+
+from stream_frames import crc16_ccitt
+
+ANIM_MAGIC = 0x4E415846  # "FXAN"
+HEADER = struct.Struct("<IHHII")  # magic, numel, period, n_frames, n_bytes
+
+
+def upload(port, data):
+    import serial
+
+    magic, numel, period, n_frames, n_bytes = HEADER.unpack_from(data)
+    if (magic != ANIM_MAGIC) or (len(data) != HEADER.size + n_bytes):
+        print("Not a valid recording")
+        return False
+    print(f"{n_frames} frames of {numel} LEDs at {period} ms, "
+          f"{len(data)} bytes")
+
+    ser = serial.Serial(port, 115200, timeout=0.1)
+    ser.reset_input_buffer()
+    ser.write(b"d")
+    t0 = time.perf_counter()
+    ser.write(data + struct.pack("<H", crc16_ccitt(data)))
+    ser.flush()
+
+    # The reply comes once the last byte is in, or after a timeout
+    reply = b""
+    while (b"Upload recording: " not in reply) or not reply.endswith(b"\n"):
+        if time.perf_counter() - t0 > 30:
+            break
+        reply += ser.read(max(1, ser.in_waiting))
+    ser.close()
+    print(reply.decode(errors="replace").strip())
+    print(f"Took {time.perf_counter() - t0:.1f} s")
+    return b"OK" in reply
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    with open(sys.argv[2], "rb") as f:
+        sys.exit(0 if upload(sys.argv[1], f.read()) else 1)